@@ -0,0 +1,472 @@
+// fichier mibits.c - cartes de bits compressées d'identifiants de symboles
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file mibits.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// Une carte de bits représente un ensemble d'identifiants de
+/// symboles, à la manière des "roaring bitmaps": les identifiants
+/// sont groupés par leurs 16 bits de poids fort, et chaque groupe est
+/// un conteneur, soit un tableau trié des 16 bits de poids faible
+/// quand il en a au plus MI_BITS_MAXTAB, soit une table de 65536
+/// bits. Les opérations combinent les conteneurs mot à mot. Chaque
+/// conteneur connaît le nombre d'éléments des précédents, pour
+/// trouver le n-ième élément dans l'ordre des identifiants.
+#define MI_BITS_MAXTAB 4096
+#define MI_BITS_NBMOTS (65536 / 64)
+#define MI_CARTEBITS_NMAGIQ 0x2b7e4d19	/*729697561 */
+
+struct Mi_ConteneurBits_st
+{
+  uint16_t co_haut;		// les 16 bits de poids fort
+  bool co_enmots;		// vrai pour une table de bits
+  unsigned co_card;
+  unsigned co_rang;		// éléments des conteneurs précédents
+  union
+  {
+    uint16_t *co_tab;		// co_card valeurs croissantes
+    uint64_t *co_mots;		// MI_BITS_NBMOTS mots
+  };
+};
+
+struct Mi_CarteBits_st
+{
+  unsigned cb_nmagiq;		// toujours MI_CARTEBITS_NMAGIQ
+  unsigned cb_card;
+  unsigned cb_nb;		// nombre de conteneurs
+  struct Mi_ConteneurBits_st cb_cont[];
+};
+
+static struct Mi_CarteBits_st *
+mi_cartebits_allouer (unsigned nb)
+{
+  struct Mi_CarteBits_st *cb =
+    calloc (1, sizeof (struct Mi_CarteBits_st)
+            + nb * sizeof (struct Mi_ConteneurBits_st));
+  if (!cb)
+    MI_FATALPRINTF ("impossible d'allouer une carte de %u conteneurs (%s)",
+                    nb, strerror (errno));
+  cb->cb_nmagiq = MI_CARTEBITS_NMAGIQ;
+  return cb;
+}				/* fin mi_cartebits_allouer */
+
+static void *
+mi_bits_allouer (size_t tail)
+{
+  void *p = malloc (tail);
+  if (!p)
+    MI_FATALPRINTF ("impossible d'allouer un conteneur de %zd octets (%s)",
+                    tail, strerror (errno));
+  return p;
+}				/* fin mi_bits_allouer */
+
+// remplit le conteneur depuis une table de bits de cardinal card
+static void
+mi_conteneur_depuis_mots (struct Mi_ConteneurBits_st *co,
+                          const uint64_t *mots, unsigned card)
+{
+  co->co_card = card;
+  if (card > MI_BITS_MAXTAB)
+    {
+      co->co_enmots = true;
+      co->co_mots = mi_bits_allouer (MI_BITS_NBMOTS * sizeof (uint64_t));
+      memcpy (co->co_mots, mots, MI_BITS_NBMOTS * sizeof (uint64_t));
+      return;
+    }
+  co->co_enmots = false;
+  co->co_tab = mi_bits_allouer (card * sizeof (uint16_t) + 1);
+  unsigned n = 0;
+  for (unsigned iw = 0; iw < MI_BITS_NBMOTS; iw++)
+    for (uint64_t w = mots[iw]; w != 0; w &= w - 1)
+      co->co_tab[n++] = (uint16_t) (iw * 64 + __builtin_ctzll (w));
+  assert (n == card);
+}				/* fin mi_conteneur_depuis_mots */
+
+// la table de bits d'un conteneur
+static void
+mi_conteneur_en_mots (const struct Mi_ConteneurBits_st *co, uint64_t *mots)
+{
+  if (co->co_enmots)
+    {
+      memcpy (mots, co->co_mots, MI_BITS_NBMOTS * sizeof (uint64_t));
+      return;
+    }
+  memset (mots, 0, MI_BITS_NBMOTS * sizeof (uint64_t));
+  for (unsigned ix = 0; ix < co->co_card; ix++)
+    mots[co->co_tab[ix] / 64] |= (uint64_t) 1 << (co->co_tab[ix] % 64);
+}				/* fin mi_conteneur_en_mots */
+
+static void
+mi_conteneur_copier (struct Mi_ConteneurBits_st *dst,
+                     const struct Mi_ConteneurBits_st *src)
+{
+  *dst = *src;
+  size_t tail = src->co_enmots ? MI_BITS_NBMOTS * sizeof (uint64_t)
+                : src->co_card * sizeof (uint16_t) + 1;
+  void *p = mi_bits_allouer (tail);
+  memcpy (p, src->co_enmots ? (void *) src->co_mots : (void *) src->co_tab,
+          tail);
+  if (src->co_enmots)
+    dst->co_mots = p;
+  else
+    dst->co_tab = p;
+}				/* fin mi_conteneur_copier */
+
+// calcule le cardinal de la carte et le rang de chaque conteneur
+static void
+mi_cartebits_ranger (struct Mi_CarteBits_st *cb)
+{
+  cb->cb_card = 0;
+  for (unsigned ix = 0; ix < cb->cb_nb; ix++)
+    {
+      cb->cb_cont[ix].co_rang = cb->cb_card;
+      cb->cb_card += cb->cb_cont[ix].co_card;
+    }
+}				/* fin mi_cartebits_ranger */
+
+/// Une carte est construite en un seul passage sur des identifiants
+/// dans n'importe quel ordre: chaque groupe de poids forts a sa table
+/// de bits, allouée à son premier identifiant, puis les tables sont
+/// converties en conteneurs. Les identifiants étant denses, il y a peu
+/// de groupes.
+struct Mi_ConstrCarte_st
+{
+  unsigned cc_nmagiq;		// toujours MI_CARTEBITS_NMAGIQ
+  unsigned cc_nbgr;		// nombre de groupes possibles
+  unsigned *cc_card;		// cardinal de chaque groupe
+  uint64_t **cc_mots;		// table de bits de chaque groupe, ou NULL
+};
+
+struct Mi_ConstrCarte_st *
+mi_constrcarte_creer (uint32_t borne)
+{
+  struct Mi_ConstrCarte_st *cc = calloc (1, sizeof (*cc));
+  if (!cc)
+    MI_FATALPRINTF ("impossible d'allouer une construction de carte (%s)",
+                    strerror (errno));
+  cc->cc_nmagiq = MI_CARTEBITS_NMAGIQ;
+  cc->cc_nbgr = (borne >> 16) + 1;
+  cc->cc_card = calloc (cc->cc_nbgr, sizeof (unsigned));
+  cc->cc_mots = calloc (cc->cc_nbgr, sizeof (uint64_t *));
+  if (!cc->cc_card || !cc->cc_mots)
+    MI_FATALPRINTF ("impossible d'allouer %u groupes de carte (%s)",
+                    cc->cc_nbgr, strerror (errno));
+  return cc;
+}				/* fin mi_constrcarte_creer */
+
+void
+mi_constrcarte_ajouter (struct Mi_ConstrCarte_st *cc, uint32_t id)
+{
+  assert (cc && cc->cc_nmagiq == MI_CARTEBITS_NMAGIQ);
+  uint32_t haut = id >> 16;
+  uint16_t bas = id & 0xffff;
+  if (haut >= cc->cc_nbgr)
+    MI_FATALPRINTF ("identifiant %u hors de la carte", (unsigned) id);
+  uint64_t *mots = cc->cc_mots[haut];
+  if (!mots)
+    {
+      mots = calloc (MI_BITS_NBMOTS, sizeof (uint64_t));
+      if (!mots)
+        MI_FATALPRINTF ("impossible d'allouer un groupe de carte (%s)",
+                        strerror (errno));
+      cc->cc_mots[haut] = mots;
+    }
+  uint64_t bit = (uint64_t) 1 << (bas % 64);
+  if (!(mots[bas / 64] & bit))
+    {
+      mots[bas / 64] |= bit;
+      cc->cc_card[haut]++;
+    }
+}				/* fin mi_constrcarte_ajouter */
+
+struct Mi_CarteBits_st *
+mi_constrcarte_finir (struct Mi_ConstrCarte_st *cc)
+{
+  assert (cc && cc->cc_nmagiq == MI_CARTEBITS_NMAGIQ);
+  unsigned nbgr = 0;
+  for (unsigned ig = 0; ig < cc->cc_nbgr; ig++)
+    nbgr += cc->cc_card[ig] > 0;
+  struct Mi_CarteBits_st *cb = mi_cartebits_allouer (nbgr);
+  for (unsigned ig = 0; ig < cc->cc_nbgr; ig++)
+    {
+      if (cc->cc_card[ig] > 0)
+        {
+          struct Mi_ConteneurBits_st *co = cb->cb_cont + cb->cb_nb++;
+          co->co_haut = ig;
+          mi_conteneur_depuis_mots (co, cc->cc_mots[ig], cc->cc_card[ig]);
+        }
+      free (cc->cc_mots[ig]);
+    }
+  mi_cartebits_ranger (cb);
+  free (cc->cc_mots);
+  free (cc->cc_card);
+  memset (cc, 0, sizeof (*cc));
+  free (cc);
+  return cb;
+}				/* fin mi_constrcarte_finir */
+
+struct Mi_CarteBits_st *
+mi_cartebits_creer (unsigned nb, Mit_Symbole *const *tab)
+{
+  struct Mi_ConstrCarte_st *cc =
+    mi_constrcarte_creer (mi_symbole_borne_ident ());
+  for (unsigned ix = 0; ix < nb; ix++)
+    {
+      const Mit_Symbole *sy = tab[ix];
+      if (sy && sy != MI_TROU_SYMBOLE && sy->mi_type == MiTy_Symbole)
+        mi_constrcarte_ajouter (cc, sy->mi_ident);
+    }
+  return mi_constrcarte_finir (cc);
+}				/* fin mi_cartebits_creer */
+
+void
+mi_cartebits_detruire (struct Mi_CarteBits_st *cb)
+{
+  if (!cb || cb->cb_nmagiq != MI_CARTEBITS_NMAGIQ)
+    return;
+  for (unsigned ix = 0; ix < cb->cb_nb; ix++)
+    {
+      if (cb->cb_cont[ix].co_enmots)
+        free (cb->cb_cont[ix].co_mots);
+      else
+        free (cb->cb_cont[ix].co_tab);
+    }
+  memset (cb, 0, sizeof (*cb));
+  free (cb);
+}				/* fin mi_cartebits_detruire */
+
+unsigned
+mi_cartebits_cardinal (const struct Mi_CarteBits_st *cb)
+{
+  if (!cb || cb->cb_nmagiq != MI_CARTEBITS_NMAGIQ)
+    return 0;
+  return cb->cb_card;
+}				/* fin mi_cartebits_cardinal */
+
+bool
+mi_cartebits_contient (const struct Mi_CarteBits_st *cb, uint32_t id)
+{
+  if (!cb || cb->cb_nmagiq != MI_CARTEBITS_NMAGIQ)
+    return false;
+  uint16_t haut = id >> 16, bas = id & 0xffff;
+  unsigned g = 0, d = cb->cb_nb;
+  while (g < d)
+    {
+      unsigned m = g + (d - g) / 2;
+      if (cb->cb_cont[m].co_haut < haut)
+        g = m + 1;
+      else
+        d = m;
+    }
+  if (g >= cb->cb_nb || cb->cb_cont[g].co_haut != haut)
+    return false;
+  const struct Mi_ConteneurBits_st *co = cb->cb_cont + g;
+  if (co->co_enmots)
+    return (co->co_mots[bas / 64] >> (bas % 64)) & 1;
+  g = 0, d = co->co_card;
+  while (g < d)
+    {
+      unsigned m = g + (d - g) / 2;
+      if (co->co_tab[m] < bas)
+        g = m + 1;
+      else
+        d = m;
+    }
+  return g < co->co_card && co->co_tab[g] == bas;
+}				/* fin mi_cartebits_contient */
+
+struct Mi_CarteBits_st *
+mi_cartebits_operation (enum mi_opens_en op,
+                        const struct Mi_CarteBits_st *cb1,
+                        const struct Mi_CarteBits_st *cb2)
+{
+  assert (cb1 && cb1->cb_nmagiq == MI_CARTEBITS_NMAGIQ);
+  assert (cb2 && cb2->cb_nmagiq == MI_CARTEBITS_NMAGIQ);
+  struct Mi_CarteBits_st *cbr = mi_cartebits_allouer (cb1->cb_nb + cb2->cb_nb);
+  static uint64_t mots1[MI_BITS_NBMOTS], mots2[MI_BITS_NBMOTS];
+  unsigned i1 = 0, i2 = 0;
+  bool garde1 = op != MiOpEns_Inter;	// garder ce qui n'est que dans cb1
+  bool garde2 = op == MiOpEns_Union || op == MiOpEns_DiffSym;
+  while (i1 < cb1->cb_nb || i2 < cb2->cb_nb)
+    {
+      const struct Mi_ConteneurBits_st *co1 =
+          (i1 < cb1->cb_nb) ? cb1->cb_cont + i1 : NULL;
+      const struct Mi_ConteneurBits_st *co2 =
+          (i2 < cb2->cb_nb) ? cb2->cb_cont + i2 : NULL;
+      if (co1 && (!co2 || co1->co_haut < co2->co_haut))
+        {
+          if (garde1)
+            mi_conteneur_copier (cbr->cb_cont + cbr->cb_nb++, co1);
+          i1++;
+          continue;
+        }
+      if (co2 && (!co1 || co2->co_haut < co1->co_haut))
+        {
+          if (garde2)
+            mi_conteneur_copier (cbr->cb_cont + cbr->cb_nb++, co2);
+          i2++;
+          continue;
+        }
+      // les deux cartes ont un conteneur pour ces poids forts
+      mi_conteneur_en_mots (co1, mots1);
+      mi_conteneur_en_mots (co2, mots2);
+      unsigned card = 0;
+      for (unsigned iw = 0; iw < MI_BITS_NBMOTS; iw++)
+        {
+          uint64_t w = 0;
+          switch (op)
+            {
+            case MiOpEns_Union:
+              w = mots1[iw] | mots2[iw];
+              break;
+            case MiOpEns_Inter:
+              w = mots1[iw] & mots2[iw];
+              break;
+            case MiOpEns_Diff:
+              w = mots1[iw] & ~mots2[iw];
+              break;
+            case MiOpEns_DiffSym:
+              w = mots1[iw] ^ mots2[iw];
+              break;
+            }
+          mots1[iw] = w;
+          card += __builtin_popcountll (w);
+        }
+      if (card > 0)
+        {
+          struct Mi_ConteneurBits_st *co = cbr->cb_cont + cbr->cb_nb++;
+          co->co_haut = co1->co_haut;
+          mi_conteneur_depuis_mots (co, mots1, card);
+        }
+      i1++, i2++;
+    }
+  mi_cartebits_ranger (cbr);
+  return cbr;
+}				/* fin mi_cartebits_operation */
+
+bool
+mi_cartebits_egales (const struct Mi_CarteBits_st *cb1,
+                     const struct Mi_CarteBits_st *cb2)
+{
+  if (cb1 == cb2)
+    return true;
+  if (!cb1 || !cb2 || cb1->cb_card != cb2->cb_card || cb1->cb_nb != cb2->cb_nb)
+    return false;
+  for (unsigned ix = 0; ix < cb1->cb_nb; ix++)
+    {
+      const struct Mi_ConteneurBits_st *co1 = cb1->cb_cont + ix;
+      const struct Mi_ConteneurBits_st *co2 = cb2->cb_cont + ix;
+      // la représentation ne dépend que du cardinal
+      if (co1->co_haut != co2->co_haut || co1->co_card != co2->co_card)
+        return false;
+      if (co1->co_enmots
+          ? memcmp (co1->co_mots, co2->co_mots,
+                    MI_BITS_NBMOTS * sizeof (uint64_t))
+          : memcmp (co1->co_tab, co2->co_tab,
+                    co1->co_card * sizeof (uint16_t)))
+        return false;
+    }
+  return true;
+}				/* fin mi_cartebits_egales */
+
+unsigned
+mi_cartebits_symboles (const struct Mi_CarteBits_st *cb, Mit_Symbole **tab)
+{
+  if (!cb || cb->cb_nmagiq != MI_CARTEBITS_NMAGIQ)
+    return 0;
+  unsigned n = 0;
+  for (unsigned ic = 0; ic < cb->cb_nb; ic++)
+    {
+      const struct Mi_ConteneurBits_st *co = cb->cb_cont + ic;
+      uint32_t haut = (uint32_t) co->co_haut << 16;
+      if (co->co_enmots)
+        {
+          for (unsigned iw = 0; iw < MI_BITS_NBMOTS; iw++)
+            for (uint64_t w = co->co_mots[iw]; w != 0; w &= w - 1)
+              tab[n++] =
+                mi_symbole_par_ident (haut | (iw * 64 + __builtin_ctzll (w)));
+        }
+      else
+        for (unsigned ix = 0; ix < co->co_card; ix++)
+          tab[n++] = mi_symbole_par_ident (haut | co->co_tab[ix]);
+    }
+  return n;
+}				/* fin mi_cartebits_symboles */
+
+// le n-ième élément dans l'ordre des identifiants: le conteneur est
+// trouvé par dichotomie sur les rangs, puis l'élément en comptant les
+// bits des mots
+Mit_Symbole *
+mi_cartebits_nieme (const struct Mi_CarteBits_st *cb, unsigned n)
+{
+  if (!cb || cb->cb_nmagiq != MI_CARTEBITS_NMAGIQ || n >= cb->cb_card)
+    return NULL;
+  unsigned g = 0, d = cb->cb_nb;
+  while (d - g > 1)
+    {
+      unsigned m = g + (d - g) / 2;
+      if (cb->cb_cont[m].co_rang <= n)
+        g = m;
+      else
+        d = m;
+    }
+  const struct Mi_ConteneurBits_st *co = cb->cb_cont + g;
+  uint32_t haut = (uint32_t) co->co_haut << 16;
+  unsigned k = n - co->co_rang;
+  assert (k < co->co_card);
+  if (!co->co_enmots)
+    return mi_symbole_par_ident (haut | co->co_tab[k]);
+  for (unsigned iw = 0; iw < MI_BITS_NBMOTS; iw++)
+    {
+      uint64_t w = co->co_mots[iw];
+      unsigned nbw = __builtin_popcountll (w);
+      if (k >= nbw)
+        {
+          k -= nbw;
+          continue;
+        }
+      while (k-- > 0)
+        w &= w - 1;
+      return mi_symbole_par_ident (haut | (iw * 64 + __builtin_ctzll (w)));
+    }
+  MI_FATALPRINTF ("carte de bits incohérente (%u éléments)", cb->cb_card);
+}				/* fin mi_cartebits_nieme */
+
+void
+mi_cartebits_iterer (const struct Mi_CarteBits_st *cb, mi_itersymb_sigt * f,
+                     void *client)
+{
+  if (!cb || cb->cb_nmagiq != MI_CARTEBITS_NMAGIQ || !f)
+    return;
+  for (unsigned ic = 0; ic < cb->cb_nb; ic++)
+    {
+      const struct Mi_ConteneurBits_st *co = cb->cb_cont + ic;
+      uint32_t haut = (uint32_t) co->co_haut << 16;
+      if (co->co_enmots)
+        {
+          for (unsigned iw = 0; iw < MI_BITS_NBMOTS; iw++)
+            for (uint64_t w = co->co_mots[iw]; w != 0; w &= w - 1)
+              if ((*f) (mi_symbole_par_ident
+                        (haut | (iw * 64 + __builtin_ctzll (w))), client))
+                return;
+        }
+      else
+        for (unsigned ix = 0; ix < co->co_card; ix++)
+          if ((*f) (mi_symbole_par_ident (haut | co->co_tab[ix]), client))
+            return;
+    }
+}				/* fin mi_cartebits_iterer */
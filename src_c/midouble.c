@@ -0,0 +1,454 @@
+// fichier midouble.c - écriture décimale des nombres doubles
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file midouble.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// On écrit les doubles avec l'algorithme Grisu2 de Florian Loitsch,
+/// "Printing Floating-Point Numbers Quickly and Accurately with
+/// Integers" (PLDI 2010). Il n'utilise que de l'arithmétique entière,
+/// donc son résultat ne dépend pas de la libc, et les chiffres
+/// produits sont toujours relus exactement par strtod; ils sont
+/// presque toujours les moins nombreux possibles. Quand Grisu2 donne
+/// plus de 15 chiffres, on essaie aussi les précisions de 15 jusqu'à
+/// la sienne avec snprintf, et on garde la première que strtod relit
+/// exactement: ainsi 1e23 ne s'écrit pas 9.999999999999999e+22.
+
+// un nombre "fait maison": une mantisse de 64 bits et un exposant binaire
+struct Mi_DiyFp_st
+{
+  uint64_t df_f;
+  int df_e;
+};
+
+// les puissances de dix 10^k en cache, pour k de -348 à 340 par pas de 8
+#define MI_PUISSDIX_MIN (-348)
+#define MI_PUISSDIX_PAS 8
+#define MI_PUISSDIX_NB 87
+static struct Mi_DiyFp_st mi_puissances_dix[MI_PUISSDIX_NB];
+static bool mi_puissances_dix_calculees;
+
+// un grand entier naturel, en mots de 32 bits de poids croissant,
+// juste assez grand pour 2^1400
+#define MI_GRANDENT_NBMOTS 48
+struct Mi_GrandEntier_st
+{
+  unsigned ge_nbmots;
+  uint32_t ge_mot[MI_GRANDENT_NBMOTS];
+};
+
+static void
+mi_grandent_multiplier (struct Mi_GrandEntier_st *ge, uint32_t m)
+{
+  uint64_t ret = 0;
+  for (unsigned ix = 0; ix < ge->ge_nbmots; ix++)
+    {
+      uint64_t p = (uint64_t) ge->ge_mot[ix] * m + ret;
+      ge->ge_mot[ix] = (uint32_t) p;
+      ret = p >> 32;
+    }
+  if (ret)
+    {
+      if (ge->ge_nbmots >= MI_GRANDENT_NBMOTS)
+        MI_FATALPRINTF ("grand entier trop grand (%u mots)", ge->ge_nbmots);
+      ge->ge_mot[ge->ge_nbmots++] = (uint32_t) ret;
+    }
+}				// fin mi_grandent_multiplier
+
+static void
+mi_grandent_diviser (struct Mi_GrandEntier_st *ge, uint32_t d)
+{
+  uint64_t reste = 0;
+  for (int ix = (int) ge->ge_nbmots - 1; ix >= 0; ix--)
+    {
+      uint64_t cour = (reste << 32) | ge->ge_mot[ix];
+      ge->ge_mot[ix] = (uint32_t) (cour / d);
+      reste = cour % d;
+    }
+  while (ge->ge_nbmots > 0 && ge->ge_mot[ge->ge_nbmots - 1] == 0)
+    ge->ge_nbmots--;
+}				// fin mi_grandent_diviser
+
+static inline uint32_t
+mi_grandent_mot (const struct Mi_GrandEntier_st *ge, unsigned ix)
+{
+  return (ix < ge->ge_nbmots) ? ge->ge_mot[ix] : 0;
+}
+
+// les 64 bits de poids fort, arrondis au plus proche, avec l'exposant
+// binaire correspondant
+static struct Mi_DiyFp_st
+mi_grandent_diyfp (const struct Mi_GrandEntier_st *ge)
+{
+  struct Mi_DiyFp_st d = { 0, 0 };
+  assert (ge->ge_nbmots > 0);
+  unsigned nbbits = 32 * (ge->ge_nbmots - 1)
+                    + (32 - __builtin_clz (ge->ge_mot[ge->ge_nbmots - 1]));
+  if (nbbits <= 64)
+    {
+      d.df_f = ((uint64_t) mi_grandent_mot (ge, 1) << 32)
+               | mi_grandent_mot (ge, 0);
+      d.df_f <<= 64 - nbbits;
+      d.df_e = (int) nbbits - 64;
+      return d;
+    }
+  unsigned bas = nbbits - 64;
+  unsigned im = bas / 32, dec = bas % 32;
+  uint64_t f = ((uint64_t) mi_grandent_mot (ge, im + 1) << 32)
+               | mi_grandent_mot (ge, im);
+  f >>= dec;
+  if (dec > 0)
+    f |= (uint64_t) mi_grandent_mot (ge, im + 2) << (64 - dec);
+  d.df_e = (int) bas;
+  // le bit juste en dessous décide de l'arrondi
+  if ((mi_grandent_mot (ge, (bas - 1) / 32) >> ((bas - 1) % 32)) & 1)
+    {
+      f++;
+      if (f == 0)
+        {
+          f = (uint64_t) 1 << 63;
+          d.df_e++;
+        }
+    }
+  d.df_f = f;
+  return d;
+}				// fin mi_grandent_diyfp
+
+// on calcule une fois pour toutes les puissances de dix en cache,
+// exactement, plutôt que de recopier une table de constantes
+static void
+mi_calculer_puissances_dix (void)
+{
+  struct Mi_GrandEntier_st ge;
+  // les puissances positives, par multiplications successives
+  memset (&ge, 0, sizeof (ge));
+  ge.ge_nbmots = 1;
+  ge.ge_mot[0] = 1;
+  for (int k = 1; k <= MI_PUISSDIX_MIN + MI_PUISSDIX_PAS * (MI_PUISSDIX_NB - 1);
+       k++)
+    {
+      mi_grandent_multiplier (&ge, 10);
+      if ((k - MI_PUISSDIX_MIN) % MI_PUISSDIX_PAS == 0)
+        mi_puissances_dix[(k - MI_PUISSDIX_MIN) / MI_PUISSDIX_PAS] =
+          mi_grandent_diyfp (&ge);
+    }
+  // les puissances négatives 10^-n sont approchées par 2^1400 / 10^n
+  // en divisions entières successives, sans perte car la partie
+  // entière de la partie entière d'un quotient est celle du quotient
+#define MI_PUISSDIX_DECAL 1400
+  memset (&ge, 0, sizeof (ge));
+  ge.ge_nbmots = MI_PUISSDIX_DECAL / 32 + 1;
+  ge.ge_mot[MI_PUISSDIX_DECAL / 32] = (uint32_t) 1 << (MI_PUISSDIX_DECAL % 32);
+  for (int n = 1; n <= -MI_PUISSDIX_MIN; n++)
+    {
+      mi_grandent_diviser (&ge, 10);
+      if ((-n - MI_PUISSDIX_MIN) % MI_PUISSDIX_PAS == 0)
+        {
+          struct Mi_DiyFp_st d = mi_grandent_diyfp (&ge);
+          d.df_e -= MI_PUISSDIX_DECAL;
+          mi_puissances_dix[(-n - MI_PUISSDIX_MIN) / MI_PUISSDIX_PAS] = d;
+        }
+    }
+#undef MI_PUISSDIX_DECAL
+  mi_puissances_dix_calculees = true;
+}				// fin mi_calculer_puissances_dix
+
+static inline struct Mi_DiyFp_st
+mi_diyfp_normaliser (struct Mi_DiyFp_st d)
+{
+  assert (d.df_f != 0);
+  int s = __builtin_clzll (d.df_f);
+  d.df_f <<= s;
+  d.df_e -= s;
+  return d;
+}
+
+static inline struct Mi_DiyFp_st
+mi_diyfp_multiplier (struct Mi_DiyFp_st a, struct Mi_DiyFp_st b)
+{
+  unsigned __int128 p = (unsigned __int128) a.df_f * b.df_f;
+  struct Mi_DiyFp_st r;
+  r.df_f = (uint64_t) (p >> 64);
+  if ((uint64_t) p & ((uint64_t) 1 << 63))
+    r.df_f++;			// arrondi
+  r.df_e = a.df_e + b.df_e + 64;
+  return r;
+}
+
+static const uint64_t mi_puiss10_entieres[20] =
+{
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+  10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+  100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+// rapprocher le dernier chiffre de la valeur exacte
+static void
+mi_grisu_arrondir (char *tamp, int lg, uint64_t delta, uint64_t reste,
+                   uint64_t dix_kappa, uint64_t wp_w)
+{
+  while (reste < wp_w && delta - reste >= dix_kappa
+         && (reste + dix_kappa < wp_w
+             || wp_w - reste > reste + dix_kappa - wp_w))
+    {
+      tamp[lg - 1]--;
+      reste += dix_kappa;
+    }
+}				// fin mi_grisu_arrondir
+
+// produire les chiffres de W, sachant que tout nombre entre Mp-delta
+// et Mp est relu comme le double; renvoie le nombre de chiffres
+static int
+mi_grisu_chiffres (struct Mi_DiyFp_st W, struct Mi_DiyFp_st Mp,
+                   uint64_t delta, char *tamp, int *pk)
+{
+  const struct Mi_DiyFp_st un = { (uint64_t) 1 << -Mp.df_e, Mp.df_e };
+  const uint64_t wp_w = Mp.df_f - W.df_f;
+  uint32_t p1 = (uint32_t) (Mp.df_f >> -un.df_e);
+  uint64_t p2 = Mp.df_f & (un.df_f - 1);
+  int kappa = 1;
+  while (kappa < 10 && p1 >= mi_puiss10_entieres[kappa])
+    kappa++;
+  int lg = 0;
+  while (kappa > 0)
+    {
+      uint32_t d = (uint32_t) (p1 / mi_puiss10_entieres[kappa - 1]);
+      p1 %= (uint32_t) mi_puiss10_entieres[kappa - 1];
+      if (d || lg)
+        tamp[lg++] = (char) ('0' + d);
+      kappa--;
+      uint64_t tmp = ((uint64_t) p1 << -un.df_e) + p2;
+      if (tmp <= delta)
+        {
+          *pk += kappa;
+          mi_grisu_arrondir (tamp, lg, delta, tmp,
+                             mi_puiss10_entieres[kappa] << -un.df_e, wp_w);
+          return lg;
+        }
+    }
+  for (;;)
+    {
+      p2 *= 10;
+      delta *= 10;
+      char d = (char) (p2 >> -un.df_e);
+      if (d || lg)
+        tamp[lg++] = (char) ('0' + d);
+      p2 &= un.df_f - 1;
+      kappa--;
+      if (p2 < delta)
+        {
+          *pk += kappa;
+          mi_grisu_arrondir (tamp, lg, delta, p2, un.df_f,
+                             (-kappa < 20) ?
+                             wp_w * mi_puiss10_entieres[-kappa] : 0);
+          return lg;
+        }
+    }
+}				// fin mi_grisu_chiffres
+
+// écrire dans tamp les chiffres décimaux d'un double fini et
+// strictement positif, qui vaut alors tamp * 10^(*pk)
+static int
+mi_grisu2 (double d, char *tamp, int *pk)
+{
+  assert (d > 0.0 && isfinite (d));
+  if (!mi_puissances_dix_calculees)
+    mi_calculer_puissances_dix ();
+  uint64_t bits = 0;
+  memcpy (&bits, &d, sizeof (bits));
+  const uint64_t bitcache = (uint64_t) 1 << 52;
+  uint64_t mant = bits & (bitcache - 1);
+  int expb = (int) ((bits >> 52) & 0x7ff);
+  struct Mi_DiyFp_st v;
+  if (expb)
+    {
+      v.df_f = mant | bitcache;
+      v.df_e = expb - 1075;
+    }
+  else
+    {
+      v.df_f = mant;
+      v.df_e = -1074;
+    }
+  // les frontières de l'intervalle relu comme d
+  struct Mi_DiyFp_st pl = { (v.df_f << 1) + 1, v.df_e - 1 };
+  pl = mi_diyfp_normaliser (pl);
+  struct Mi_DiyFp_st mo;
+  if (v.df_f == bitcache)
+    {
+      mo.df_f = (v.df_f << 2) - 1;
+      mo.df_e = v.df_e - 2;
+    }
+  else
+    {
+      mo.df_f = (v.df_f << 1) - 1;
+      mo.df_e = v.df_e - 1;
+    }
+  mo.df_f <<= mo.df_e - pl.df_e;
+  mo.df_e = pl.df_e;
+  // choisir la puissance de dix qui amène l'exposant binaire entre -60 et -32
+  double dk = (-61 - pl.df_e) * 0.30102999566398114 + 347;
+  int k = (int) dk;
+  if (dk - k > 0.0)
+    k++;
+  unsigned ix = (unsigned) ((k >> 3) + 1);
+  assert (ix < MI_PUISSDIX_NB);
+  *pk = -(MI_PUISSDIX_MIN + (int) ix * MI_PUISSDIX_PAS);
+  const struct Mi_DiyFp_st c = mi_puissances_dix[ix];
+  struct Mi_DiyFp_st W = mi_diyfp_multiplier (mi_diyfp_normaliser (v), c);
+  struct Mi_DiyFp_st Wp = mi_diyfp_multiplier (pl, c);
+  struct Mi_DiyFp_st Wm = mi_diyfp_multiplier (mo, c);
+  Wm.df_f++;
+  Wp.df_f--;
+  return mi_grisu_chiffres (W, Wp, Wp.df_f - Wm.df_f, tamp, pk);
+}				// fin mi_grisu2
+
+// les chiffres les moins nombreux d'un double fini et strictement
+// positif, qui vaut alors tamp * 10^(*pk)
+static int
+mi_double_chiffres_courts (double d, char *tamp, int *pk)
+{
+  int lg = mi_grisu2 (d, tamp, pk);
+  for (int prec = 15; prec < lg; prec++)
+    {
+      char essai[40];
+      snprintf (essai, sizeof (essai), "%.*e", prec - 1, d);
+      if (strtod (essai, NULL) != d)
+        continue;
+      // essai est de la forme c.ccccce±XX
+      char *pe = strchr (essai, 'e');
+      assert (pe != NULL && essai[1] == '.');
+      int n = 0;
+      tamp[n++] = essai[0];
+      for (const char *pc = essai + 2; pc < pe; pc++)
+        tamp[n++] = *pc;
+      while (n > 1 && tamp[n - 1] == '0')
+        n--;
+      *pk = atoi (pe + 1) - n + 1;
+      return n;
+    }
+  return lg;
+}				// fin mi_double_chiffres_courts
+
+int
+mi_double_chiffres (double d)
+{
+  if (!isfinite (d) || d == 0.0)
+    return 17;
+  if (d < 0.0)
+    d = -d;
+  uint64_t bits = 0;
+  memcpy (&bits, &d, sizeof (bits));
+  // pour une puissance de deux, l'intervalle relu n'est pas symétrique,
+  // et moins de 17 chiffres arrondis par printf pourraient en sortir
+  if ((bits & (((uint64_t) 1 << 52) - 1)) == 0)
+    return 17;
+  char chiffres[MI_TAILLE_TAMPON_DOUBLE];
+  int k = 0;
+  return mi_double_chiffres_courts (d, chiffres, &k);
+}				// fin mi_double_chiffres
+
+int
+mi_double_en_chaine (char tamp[MI_TAILLE_TAMPON_DOUBLE], double d)
+{
+  if (isnan (d))
+    {
+      strcpy (tamp, "+NAN");
+      return 4;
+    }
+  if (isinf (d))
+    {
+      strcpy (tamp, (d > 0.0) ? "+INF" : "-INF");
+      return 4;
+    }
+  char *pc = tamp;
+  if (signbit (d))
+    {
+      *(pc++) = '-';
+      d = -d;
+    }
+  if (d == 0.0)
+    {
+      strcpy (pc, "0.0");
+      return (int) (pc - tamp) + 3;
+    }
+  char chiffres[MI_TAILLE_TAMPON_DOUBLE];
+  int k = 0;
+  int lg = mi_double_chiffres_courts (d, chiffres, &k);
+  assert (lg > 0 && lg <= 17);
+  // la position du point décimal par rapport au premier chiffre
+  int pt = lg + k;
+  if (pt > 0 && pt <= 17)
+    {
+      if (pt < lg)
+        {
+          memcpy (pc, chiffres, pt);
+          pc += pt;
+          *(pc++) = '.';
+          memcpy (pc, chiffres + pt, lg - pt);
+          pc += lg - pt;
+        }
+      else
+        {
+          memcpy (pc, chiffres, lg);
+          pc += lg;
+          for (int ix = lg; ix < pt; ix++)
+            *(pc++) = '0';
+          *(pc++) = '.';
+          *(pc++) = '0';
+        }
+    }
+  else if (pt <= 0 && pt > -4)
+    {
+      *(pc++) = '0';
+      *(pc++) = '.';
+      for (int ix = pt; ix < 0; ix++)
+        *(pc++) = '0';
+      memcpy (pc, chiffres, lg);
+      pc += lg;
+    }
+  else
+    {
+      // notation scientifique, comme %e mais avec le moins de chiffres
+      *(pc++) = chiffres[0];
+      *(pc++) = '.';
+      if (lg > 1)
+        {
+          memcpy (pc, chiffres + 1, lg - 1);
+          pc += lg - 1;
+        }
+      else
+        *(pc++) = '0';
+      *(pc++) = 'e';
+      int ex = pt - 1;
+      if (ex < 0)
+        {
+          *(pc++) = '-';
+          ex = -ex;
+        }
+      else
+        *(pc++) = '+';
+      if (ex >= 100)
+        *(pc++) = (char) ('0' + ex / 100);
+      *(pc++) = (char) ('0' + (ex / 10) % 10);
+      *(pc++) = (char) ('0' + ex % 10);
+    }
+  *pc = (char) 0;
+  return (int) (pc - tamp);
+}				// fin mi_double_en_chaine
@@ -24,7 +24,8 @@ static const Mit_Ensemble mi_ensvide =
   .mi_taille = 0,
   .mi_marq = true,
   .mi_hash = 11,
-  .mi_elements = {NULL}
+  .mi_elements = NULL,
+  .mi_compact = NULL
 };
 
 #define MI_ENSHASH_NMAGIQ 0x30e595d7	/*820352471 */
@@ -32,26 +33,50 @@ static const Mit_Ensemble mi_ensvide =
 
 
 
-void
-mi_calculer_hash_ensemble (Mit_Ensemble * e)
+// un ensemble frais, dont les éléments seront dans mi_tabelem
+Mit_Ensemble *
+mi_allouer_ensemble (unsigned ta)
+{
+  Mit_Ensemble *en = mi_allouer_valeur (MiTy_Ensemble,
+                                        sizeof (Mit_Ensemble) +
+                                        ta * sizeof (Mit_Symbole *));
+  en->mi_elements = en->mi_tabelem;
+  return en;
+}				// fin mi_allouer_ensemble
+
+// le hash d'un ensemble se calcule élément par élément, dans l'ordre
+// des clefs, en partant de h1 = 0 et h2 = cardinal
+static inline void
+mi_hash_ensemble_pas (unsigned *h1, unsigned *h2, unsigned ix,
+                      const Mit_Symbole * sy)
+{
+  assert (sy != NULL);
+  assert (sy->mi_type == MiTy_Symbole);
+  if (ix % 2)
+    *h1 = (25031 * sy->mi_hash + ix) ^ (271 * *h1);
+  else
+    *h2 = (31033 * sy->mi_hash) ^ (151 * *h2 + ix * 11);
+}				// fin mi_hash_ensemble_pas
+
+static inline unsigned
+mi_hash_ensemble_fin (unsigned h1, unsigned h2, unsigned c)
+{
+  unsigned h = (11 * h1) ^ (31 * h2);
+  if (!h)
+    h = (h1 & 0xffff) + (h2 & 0xfffff) + (c % 31091) + 11;
+  return h;
+}				// fin mi_hash_ensemble_fin
+
+// calcule le hash de l'ensemble e, d'éléments ordonnés el
+static void
+mi_calculer_hash_ensemble (Mit_Ensemble * e, Mit_Symbole * const *el)
 {
   unsigned c = e->mi_taille;
   assert (e->mi_type == MiTy_Ensemble && e->mi_hash == 0);
   unsigned h1 = 0, h2 = c;
   for (unsigned ix = 0; ix < c; ix++)
-    {
-      const Mit_Symbole *sy = e->mi_elements[ix];
-      assert (sy != NULL);
-      assert (sy->mi_type == MiTy_Symbole);
-      if (ix % 2)
-        h1 = (25031 * sy->mi_hash + ix) ^ (271 * h1);
-      else
-        h2 = (31033 * sy->mi_hash) ^ (151 * h2 + ix * 11);
-    }
-  unsigned h = (11 * h1) ^ (31 * h2);
-  if (!h)
-    h = (h1 & 0xffff) + (h2 & 0xfffff) + (c % 31091) + 11;
-  e->mi_hash = h;
+    mi_hash_ensemble_pas (&h1, &h2, ix, el[ix]);
+  e->mi_hash = mi_hash_ensemble_fin (h1, h2, c);
 }
 
 
@@ -61,6 +86,84 @@ mi_ensemble_vide ()
   return &mi_ensvide;
 }				/* fin mi_ensemble_vide */
 
+/// Le tri des symboles se fait sur leurs clefs entières, par un tri
+/// par base (radix) des poids faibles aux poids forts, octet par
+/// octet; les passes sur un octet commun à toutes les clefs sont
+/// sautées, si bien que les indices nuls ne coûtent rien. Les petits
+/// tableaux sont triés par insertion.
+#define MI_TRI_SEUIL_INSERTION 48
+struct Mi_ClefSymbole_st
+{
+  uint64_t cs_cle;
+  Mit_Symbole *cs_sy;
+};
+
+void
+mi_trier_symboles (unsigned nb, Mit_Symbole **tab)
+{
+  if (nb < 2 || !tab)
+    return;
+  if (nb < MI_TRI_SEUIL_INSERTION)
+    {
+      for (unsigned ix = 1; ix < nb; ix++)
+        {
+          Mit_Symbole *sy = tab[ix];
+          uint64_t cle = mi_cle_symbole (sy);
+          unsigned j = ix;
+          for (; j > 0 && mi_cle_symbole (tab[j - 1]) > cle; j--)
+            tab[j] = tab[j - 1];
+          tab[j] = sy;
+        }
+      return;
+    }
+  struct Mi_ClefSymbole_st *cs =
+    malloc (2 * (size_t) nb * sizeof (struct Mi_ClefSymbole_st));
+  if (!cs)
+    MI_FATALPRINTF ("impossible d'allouer le tri de %u symboles (%s)",
+                    nb, strerror (errno));
+  struct Mi_ClefSymbole_st *src = cs, *dst = cs + nb;
+  static unsigned compte[8][256];
+  memset (compte, 0, sizeof (compte));
+  bool trie = true;
+  for (unsigned ix = 0; ix < nb; ix++)
+    {
+      uint64_t cle = mi_cle_symbole (tab[ix]);
+      src[ix].cs_cle = cle;
+      src[ix].cs_sy = tab[ix];
+      if (ix > 0 && src[ix - 1].cs_cle > cle)
+        trie = false;
+      for (unsigned oc = 0; oc < 8; oc++)
+        compte[oc][(cle >> (8 * oc)) & 0xff]++;
+    }
+  if (trie)
+    {
+      free (cs);
+      return;
+    }
+  for (unsigned oc = 0; oc < 8; oc++)
+    {
+      unsigned *co = compte[oc];
+      // toutes les clefs ont le même octet
+      if (co[(src[0].cs_cle >> (8 * oc)) & 0xff] == nb)
+        continue;
+      unsigned pos = 0;
+      for (unsigned b = 0; b < 256; b++)
+        {
+          unsigned c = co[b];
+          co[b] = pos;
+          pos += c;
+        }
+      for (unsigned ix = 0; ix < nb; ix++)
+        dst[co[(src[ix].cs_cle >> (8 * oc)) & 0xff]++] = src[ix];
+      struct Mi_ClefSymbole_st *t = src;
+      src = dst;
+      dst = t;
+    }
+  for (unsigned ix = 0; ix < nb; ix++)
+    tab[ix] = src[ix].cs_sy;
+  free (cs);
+}				// fin mi_trier_symboles
+
 const Mit_Ensemble *
 mi_creer_ensemble_enshash (struct Mi_EnsHash_st *eh)
 {
@@ -72,9 +175,7 @@ mi_creer_ensemble_enshash (struct Mi_EnsHash_st *eh)
     return mi_ensemble_vide ();
   assert (c < t);
   unsigned n = 0;
-  Mit_Ensemble *e = mi_allouer_valeur (MiTy_Ensemble,
-                                       sizeof (Mit_Ensemble) +
-                                       c * sizeof (Mit_Symbole *));
+  Mit_Ensemble *e = mi_allouer_ensemble (c);
   for (unsigned ix = 0; ix < t; ix++)
     {
       const Mit_Symbole *sy = eh->eh_table[ix];
@@ -85,10 +186,8 @@ mi_creer_ensemble_enshash (struct Mi_EnsHash_st *eh)
       e->mi_elements[n++] = (Mit_Symbole *) sy;
     }
   assert (n == c);
-  qsort (e->mi_elements, n, sizeof (Mit_Symbole *), mi_cmp_symboleptr);
-  e->mi_taille = c;
-  mi_calculer_hash_ensemble (e);
-  return e;
+  mi_trier_symboles (n, e->mi_elements);
+  return mi_finir_ensemble (e, c, c);
 }				// fin mi_creer_ensemble_enshash
 
 const Mit_Ensemble *
@@ -98,6 +197,26 @@ mi_creer_ensemble_symboles (unsigned nb, const Mit_Symbole **tab)
     return NULL;
   if (nb == 0)
     return mi_ensemble_vide ();
+  // des symboles valides déjà strictement ordonnés sont recopiés tels
+  // quels, sans table de hash ni tri
+  uint64_t cleprec = 0;
+  unsigned nbord = 0;
+  for (; nbord < nb; nbord++)
+    {
+      const Mit_Symbole *sy = tab[nbord];
+      if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole)
+        break;
+      uint64_t cle = mi_cle_symbole (sy);
+      if (nbord > 0 && cle <= cleprec)
+        break;
+      cleprec = cle;
+    }
+  if (nbord == nb)
+    {
+      Mit_Ensemble *e = mi_allouer_ensemble (nb);
+      memcpy (e->mi_tabelem, tab, nb * sizeof (Mit_Symbole *));
+      return mi_finir_ensemble (e, nb, nb);
+    }
   struct Mi_EnsHash_st eh = { };
   mi_enshash_initialiser (&eh, 4 * nb / 3 + 5);
   for (unsigned ix = 0; ix < nb; ix++)
@@ -261,7 +380,7 @@ mi_enshash_reserver (struct Mi_EnsHash_st *eh, unsigned nb)
     {
       unsigned nouvtail =
         mi_nombre_premier_apres (4 * (c + nb) / 3 + nb / 8 + c / 32 + 3);
-      if (!nouvtail || nouvtail)
+      if (!nouvtail)
         MI_FATALPRINTF ("débordement ensemble de hash (%d+%d)", c, nb);
       const Mit_Symbole **nouvtable =
         calloc (nouvtail, sizeof (Mit_Symbole *));
@@ -320,6 +439,13 @@ mi_enshash_ajouter (struct Mi_EnsHash_st *eh, const Mit_Symbole *sy)
 }				// fin mi_enshash_ajouter
 
 
+static bool
+mi_enshash_ajouter_iter (Mit_Symbole * sy, void *client)
+{
+  mi_enshash_ajouter ((struct Mi_EnsHash_st *) client, sy);
+  return false;
+}				// fin mi_enshash_ajouter_iter
+
 void
 mi_enshash_ajouter_valeur (struct Mi_EnsHash_st *eh, const Mit_Val va)
 {
@@ -331,24 +457,29 @@ mi_enshash_ajouter_valeur (struct Mi_EnsHash_st *eh, const Mit_Val va)
       mi_enshash_ajouter (eh, va.miva_sym);
       return;
     case MiTy_Ensemble:
+    case MiTy_EnsPersistant:
     {
-      const Mit_Ensemble *e = va.miva_ens;
+      const Mit_Ensemble *e = mi_en_ensemble_plat (va);
       unsigned c = e->mi_taille;
       mi_enshash_reserver (eh, 5 * c / 4 + 2);
-      for (unsigned ix = 0; ix < c; ix++)
-        mi_enshash_ajouter (eh, e->mi_elements[ix]);
+      if (e->mi_compact)
+        mi_cartebits_iterer (e->mi_compact, mi_enshash_ajouter_iter, eh);
+      else
+        for (unsigned ix = 0; ix < c; ix++)
+          mi_enshash_ajouter (eh, e->mi_elements[ix]);
     }
     break;
     case MiTy_Tuple:
+    case MiTy_VueTuple:
     {
-      const Mit_Tuple *tu = va.miva_tup;
-      unsigned t = tu->mi_taille;
+      unsigned t = mi_sequence_taille (va);
       mi_enshash_reserver (eh, 5 * t / 4 + 2);
       for (unsigned ix = 0; ix < t; ix++)
-        mi_enshash_ajouter (eh, tu->mi_composants[ix]);
-      default:
-        return;
-      }
+        mi_enshash_ajouter (eh, mi_sequence_nieme (va, ix));
+    }
+    break;
+    default:
+      return;
     }
 }				// fin mi_enshash_ajouter_valeur
 
@@ -408,6 +539,11 @@ mi_ensemble_iterer (const Mit_Ensemble * en, mi_itersymb_sigt * f,
 {
   if (!en || en->mi_type != MiTy_Ensemble || !f)
     return;
+  if (en->mi_compact)
+    {
+      mi_cartebits_iterer (en->mi_compact, f, client);
+      return;
+    }
   unsigned t = en->mi_taille;
   for (unsigned ix = 0; ix < t; ix++)
     if ((*f) (en->mi_elements[ix], client))
@@ -415,8 +551,555 @@ mi_ensemble_iterer (const Mit_Ensemble * en, mi_itersymb_sigt * f,
 }
 
 
+// le premier rang dans [deb,fin[ d'un élément au moins égal à sy,
+// par une recherche exponentielle depuis deb puis dichotomique; son
+// coût est logarithmique en la distance parcourue
+static unsigned
+mi_ensemble_galoper (Mit_Symbole *const *tab, unsigned deb, unsigned fin,
+                     const Mit_Symbole *sy)
+{
+  uint64_t cle = mi_cle_symbole (sy);
+  unsigned bas = deb, pas = 1;
+  while (bas + pas < fin && mi_cle_symbole (tab[bas + pas]) < cle)
+    {
+      bas += pas;
+      pas *= 2;
+    }
+  unsigned haut = (bas + pas < fin) ? bas + pas : fin;
+  // tab[bas-1] < sy <= tab[haut] s'il existe
+  if (bas < haut && mi_cle_symbole (tab[bas]) >= cle)
+    return bas;
+  while (haut - bas > 1)
+    {
+      unsigned mil = bas + (haut - bas) / 2;
+      if (mi_cle_symbole (tab[mil]) < cle)
+        bas = mil;
+      else
+        haut = mil;
+    }
+  return haut;
+}				// fin mi_ensemble_galoper
+
+/// Les fusions de deux ensembles de tailles voisines comparent les
+/// clefs par paquets de quatre, avec les vecteurs de GCC comme dans
+/// mitabnum.c: une comparaison vectorielle compte d'un coup combien
+/// d'éléments d'un paquet précèdent la clef courante de l'autre
+/// ensemble, et toute la suite de ces éléments est copiée ou sautée
+/// ensemble. Les clefs sont lues dans les symboles, donc un paquet
+/// n'est pas chargé en une instruction.
+typedef uint64_t mi_v4cle __attribute__ ((vector_size (4 * sizeof (uint64_t))));
+#define MI_PAQUET_CLES 4
+
+// le premier rang dans [deb,fin[ d'un élément de clef au moins cle
+static inline unsigned
+mi_ensemble_avancer (Mit_Symbole *const *tab, unsigned deb, unsigned fin,
+                     uint64_t cle)
+{
+  for (; deb + MI_PAQUET_CLES <= fin; deb += MI_PAQUET_CLES)
+    {
+      mi_v4cle v = { mi_cle_symbole (tab[deb]), mi_cle_symbole (tab[deb + 1]),
+                     mi_cle_symbole (tab[deb + 2]),
+                     mi_cle_symbole (tab[deb + 3])
+                   };
+      // chaque case vaut -1 si sa clef est inférieure, 0 sinon
+      mi_v4cle m = (mi_v4cle) (v < cle);
+      unsigned nbinf = (unsigned) - (m[0] + m[1] + m[2] + m[3]);
+      if (nbinf < MI_PAQUET_CLES)
+        return deb + nbinf;
+    }
+  while (deb < fin && mi_cle_symbole (tab[deb]) < cle)
+    deb++;
+  return deb;
+}				// fin mi_ensemble_avancer
+
+/// Les clefs des éléments d'un grand ensemble, rangées en ordre
+/// d'Eytzinger: la racine de l'arbre binaire de recherche implicite
+/// en 1, les fils de k en 2k et 2k+1. La recherche ne compare que des
+/// entiers contigus en mémoire, sans branchement, et précharge les
+/// descendants quelques niveaux plus bas. Les clefs changent quand
+/// les rangs des radicaux sont renumérotés, d'où la génération.
+#define MI_EYTZ_PRECHARGE 8	// clefs par ligne de cache
+struct Mi_ClefsEytz_st
+{
+  unsigned long ce_generation;	// valeur de mi_generation_rangs
+  unsigned ce_nb;
+  uint64_t ce_cle[];		// de 1 à ce_nb
+};
+
+// remplit le sous-arbre de racine k par les éléments à partir de ix
+static unsigned
+mi_eytz_remplir (struct Mi_ClefsEytz_st *ce, Mit_Symbole *const *el,
+                 unsigned ix, unsigned long k)
+{
+  if (k > ce->ce_nb)
+    return ix;
+  ix = mi_eytz_remplir (ce, el, ix, 2 * k);
+  ce->ce_cle[k] = mi_cle_symbole (el[ix++]);
+  return mi_eytz_remplir (ce, el, ix, 2 * k + 1);
+}				// fin mi_eytz_remplir
+
+static const struct Mi_ClefsEytz_st *
+mi_ensemble_eytz (const Mit_Ensemble * en)
+{
+  struct Mi_ClefsEytz_st *ce = en->mi_eytz;
+  if (ce && ce->ce_generation == mi_generation_rangs)
+    return ce;
+  unsigned nb = en->mi_taille;
+  if (!ce)
+    {
+      ce = malloc (sizeof (struct Mi_ClefsEytz_st)
+                   + (nb + 1) * sizeof (uint64_t));
+      if (!ce)
+        MI_FATALPRINTF ("impossible d'allouer %u clefs d'ensemble (%s)",
+                        nb, strerror (errno));
+      ce->ce_nb = nb;
+      ce->ce_cle[0] = 0;
+      ((Mit_Ensemble *) en)->mi_eytz = ce;
+    }
+  ce->ce_generation = mi_generation_rangs;
+  unsigned n = mi_eytz_remplir (ce, en->mi_elements, 0, 1);
+  assert (n == nb);
+  return ce;
+}				// fin mi_ensemble_eytz
+
+static bool
+mi_eytz_contient (const struct Mi_ClefsEytz_st *ce, uint64_t cle)
+{
+  const uint64_t *b = ce->ce_cle;
+  unsigned long n = ce->ce_nb, k = 1;
+  while (k <= n)
+    {
+      __builtin_prefetch (b + k * MI_EYTZ_PRECHARGE);
+      k = 2 * k + (b[k] < cle);
+    }
+  // remonter au dernier ancêtre dont on est descendu à gauche
+  k >>= __builtin_ffsl (~k);
+  return k != 0 && b[k] == cle;
+}				// fin mi_eytz_contient
+
+bool
+mi_ensemble_contient (const Mit_Ensemble * en, const Mit_Symbole *sy)
+{
+  if (!en || en->mi_type != MiTy_Ensemble)
+    return false;
+  if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole)
+    return false;
+  if (en->mi_compact)
+    return mi_cartebits_contient (en->mi_compact, sy->mi_ident);
+  unsigned ca = en->mi_taille;
+  if (ca >= MI_ENSEMBLE_SEUIL_EYTZ)
+    return mi_eytz_contient (mi_ensemble_eytz (en), mi_cle_symbole (sy));
+  unsigned pos = mi_ensemble_galoper (en->mi_elements, 0, ca, sy);
+  return pos < ca && en->mi_elements[pos] == sy;
+}				// fin mi_ensemble_contient
+
+/// Quand un ensemble est beaucoup plus petit que l'autre, l'union et
+/// l'intersection cherchent chacun de ses éléments dans le grand
+/// ensemble en galopant, au lieu de tout parcourir.
+#define MI_ENSEMBLE_RAPPORT_GALOP 8
+
+// l'ensemble frais de taille maximale ta, rempli de nb éléments
+// ordonnés; au delà du seuil il est remplacé par un ensemble compact,
+// dont le hash et la carte de bits sont calculés en un seul parcours
 const Mit_Ensemble *
-mi_ensemble_union (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
+mi_finir_ensemble (Mit_Ensemble * enr, unsigned ta, unsigned nb)
+{
+  if (nb == 0)
+    {
+      mi_liberer_valeur_fraiche (enr);
+      return mi_ensemble_vide ();
+    }
+  enr->mi_taille = nb;
+  if (nb >= MI_ENSEMBLE_SEUIL_COMPACT)
+    {
+      struct Mi_ConstrCarte_st *cc =
+        mi_constrcarte_creer (mi_symbole_borne_ident ());
+      unsigned h1 = 0, h2 = nb;
+      for (unsigned ix = 0; ix < nb; ix++)
+        {
+          const Mit_Symbole *sy = enr->mi_tabelem[ix];
+          mi_hash_ensemble_pas (&h1, &h2, ix, sy);
+          mi_constrcarte_ajouter (cc, sy->mi_ident);
+        }
+      mi_liberer_valeur_fraiche (enr);
+      Mit_Ensemble *enc = mi_allouer_ensemble (0);
+      enc->mi_elements = NULL;
+      enc->mi_compact = mi_constrcarte_finir (cc);
+      assert (mi_cartebits_cardinal (enc->mi_compact) == nb);
+      enc->mi_taille = nb;
+      enc->mi_hash = mi_hash_ensemble_fin (h1, h2, nb);
+      return enc;
+    }
+  if (nb < ta)
+    {
+      enr = mi_retrecir_valeur_fraiche (enr, sizeof (Mit_Ensemble)
+                                        + nb * sizeof (Mit_Symbole *));
+      enr->mi_elements = enr->mi_tabelem;
+    }
+  mi_calculer_hash_ensemble (enr, enr->mi_elements);
+  return mi_partager_ensemble (enr);
+}				// fin mi_finir_ensemble
+
+// l'ensemble d'une carte de bits fraîche, qui lui est donnée
+static const Mit_Ensemble *
+mi_ensemble_carte (struct Mi_CarteBits_st *cb)
+{
+  unsigned ca = mi_cartebits_cardinal (cb);
+  if (ca == 0)
+    {
+      mi_cartebits_detruire (cb);
+      return mi_ensemble_vide ();
+    }
+  if (ca < MI_ENSEMBLE_SEUIL_COMPACT)
+    {
+      Mit_Ensemble *enr = mi_allouer_ensemble (ca);
+      mi_cartebits_symboles (cb, enr->mi_tabelem);
+      mi_cartebits_detruire (cb);
+      mi_trier_symboles (ca, enr->mi_tabelem);
+      return mi_finir_ensemble (enr, ca, ca);
+    }
+  Mit_Ensemble *enc = mi_allouer_ensemble (0);
+  enc->mi_elements = NULL;
+  enc->mi_compact = cb;
+  enc->mi_taille = ca;
+  return enc;
+}				// fin mi_ensemble_carte
+
+Mit_Symbole *const *
+mi_ensemble_prendre_elements (const Mit_Ensemble * en)
+{
+  if (!en || en->mi_type != MiTy_Ensemble)
+    return NULL;
+  if (!en->mi_compact)
+    return en->mi_elements;
+  // un tableau temporaire, ordonné par clefs, que l'appelant rend
+  unsigned ca = en->mi_taille;
+  Mit_Symbole **tab = malloc (ca * sizeof (Mit_Symbole *));
+  if (!tab)
+    MI_FATALPRINTF ("impossible d'allouer %u éléments d'ensemble (%s)",
+                    ca, strerror (errno));
+  mi_cartebits_symboles (en->mi_compact, tab);
+  mi_trier_symboles (ca, tab);
+  return tab;
+}				// fin mi_ensemble_prendre_elements
+
+void
+mi_ensemble_rendre_elements (const Mit_Ensemble * en,
+                             Mit_Symbole * const *el)
+{
+  if (en && en->mi_type == MiTy_Ensemble && en->mi_compact && el
+      && el != en->mi_elements)
+    free ((void *) el);
+}				// fin mi_ensemble_rendre_elements
+
+unsigned
+mi_ensemble_hash (const Mit_Ensemble * en)
+{
+  if (!en || en->mi_type != MiTy_Ensemble)
+    return 0;
+  if (!en->mi_hash)
+    {
+      Mit_Symbole *const *el = mi_ensemble_prendre_elements (en);
+      mi_calculer_hash_ensemble ((Mit_Ensemble *) en, el);
+      mi_ensemble_rendre_elements (en, el);
+    }
+  return en->mi_hash;
+}				// fin mi_ensemble_hash
+
+// l'opération sur les cartes de bits, en en faisant une pour un
+// ensemble qui n'est pas compact
+static const Mit_Ensemble *
+mi_ensemble_operation_cartes (enum mi_opens_en op,
+                              const Mit_Ensemble * en1,
+                              const Mit_Ensemble * en2)
+{
+  struct Mi_CarteBits_st *cb1 = en1->mi_compact;
+  struct Mi_CarteBits_st *cb2 = en2->mi_compact;
+  if (!cb1)
+    cb1 = mi_cartebits_creer (en1->mi_taille, en1->mi_elements);
+  if (!cb2)
+    cb2 = mi_cartebits_creer (en2->mi_taille, en2->mi_elements);
+  struct Mi_CarteBits_st *cbr = mi_cartebits_operation (op, cb1, cb2);
+  if (cb1 != en1->mi_compact)
+    mi_cartebits_detruire (cb1);
+  if (cb2 != en2->mi_compact)
+    mi_cartebits_detruire (cb2);
+  unsigned ca = mi_cartebits_cardinal (cbr);
+  // le résultat est parfois un des opérandes
+  const Mit_Ensemble *enr = NULL;
+  if (ca == en1->mi_taille && (op == MiOpEns_Diff
+                               || (op == MiOpEns_Union
+                                   && en1->mi_taille >= en2->mi_taille)
+                               || (op == MiOpEns_Inter
+                                   && en1->mi_taille <= en2->mi_taille)))
+    enr = en1;
+  else if (ca == en2->mi_taille
+           && ((op == MiOpEns_Union && en2->mi_taille >= en1->mi_taille)
+               || (op == MiOpEns_Inter && en2->mi_taille <= en1->mi_taille)))
+    enr = en2;
+  if (enr)
+    {
+      mi_cartebits_detruire (cbr);
+      return enr;
+    }
+  return mi_ensemble_carte (cbr);
+}				// fin mi_ensemble_operation_cartes
+
+/// Les résultats des unions et intersections d'ensembles assez
+/// grands sont mémorisés dans un cache, qui retient les plus
+/// récemment utilisés dans la limite d'un budget en octets. La clef
+/// est l'opération et l'identité des opérandes, dont les hash, quand
+/// ils sont connus, doivent aussi correspondre. Le cache garde en vie
+/// ses résultats; mi_detruire_symboles le vide, comme devra le faire
+/// le ramasse-miettes.
+#define MI_MEMO_SEUIL 256	// cardinal total minimal des opérandes
+#define MI_MEMO_BUDGET_DEFAUT (64 << 20)
+struct Mi_EntreeMemo_st
+{
+  enum mi_opens_en me_op;
+  unsigned me_hash1, me_hash2;
+  const Mit_Ensemble *me_ens1;
+  const Mit_Ensemble *me_ens2;
+  const Mit_Ensemble *me_res;
+  size_t me_octets;
+  struct Mi_EntreeMemo_st *me_suivseau;	// suivant dans le seau
+  struct Mi_EntreeMemo_st *me_plusrecent;
+  struct Mi_EntreeMemo_st *me_moinsrecent;
+};
+
+static struct
+{
+  unsigned mo_nbseaux;
+  unsigned mo_nombre;
+  size_t mo_octets;
+  size_t mo_budget;
+  struct Mi_EntreeMemo_st **mo_seaux;
+  struct Mi_EntreeMemo_st *mo_recent;	// tête de la liste LRU
+  struct Mi_EntreeMemo_st *mo_ancien;	// queue de la liste LRU
+  unsigned long mo_succes, mo_echecs, mo_evictions;
+} mi_memo = {.mo_budget = MI_MEMO_BUDGET_DEFAUT };
+
+static inline unsigned
+mi_memo_seau (enum mi_opens_en op, const Mit_Ensemble * en1,
+              const Mit_Ensemble * en2)
+{
+  uint64_t h = ((uintptr_t) en1 >> 4) * 0x9E3779B97F4A7C15ULL
+               ^ ((uintptr_t) en2 >> 4) * 0xC2B2AE3D27D4EB4FULL ^ op;
+  return (unsigned) (h >> 32) % mi_memo.mo_nbseaux;
+}				// fin mi_memo_seau
+
+// la place retenue par un résultat qui n'est pas un des opérandes
+static size_t
+mi_memo_octets (const Mit_Ensemble * en1, const Mit_Ensemble * en2,
+                const Mit_Ensemble * res)
+{
+  size_t o = sizeof (struct Mi_EntreeMemo_st);
+  if (res == en1 || res == en2 || res->mi_taille == 0)
+    return o;
+  o += sizeof (Mit_Ensemble);
+  if (res->mi_compact)
+    o += res->mi_taille / 8 + 2 * sizeof (uint64_t);
+  else
+    o += res->mi_taille * sizeof (Mit_Symbole *);
+  return o;
+}				// fin mi_memo_octets
+
+static void
+mi_memo_delier (struct Mi_EntreeMemo_st *me)
+{
+  if (me->me_plusrecent)
+    me->me_plusrecent->me_moinsrecent = me->me_moinsrecent;
+  else
+    mi_memo.mo_recent = me->me_moinsrecent;
+  if (me->me_moinsrecent)
+    me->me_moinsrecent->me_plusrecent = me->me_plusrecent;
+  else
+    mi_memo.mo_ancien = me->me_plusrecent;
+  me->me_plusrecent = me->me_moinsrecent = NULL;
+}				// fin mi_memo_delier
+
+static void
+mi_memo_en_tete (struct Mi_EntreeMemo_st *me)
+{
+  me->me_moinsrecent = mi_memo.mo_recent;
+  me->me_plusrecent = NULL;
+  if (mi_memo.mo_recent)
+    mi_memo.mo_recent->me_plusrecent = me;
+  else
+    mi_memo.mo_ancien = me;
+  mi_memo.mo_recent = me;
+}				// fin mi_memo_en_tete
+
+static void
+mi_memo_enlever (struct Mi_EntreeMemo_st *me)
+{
+  unsigned s = mi_memo_seau (me->me_op, me->me_ens1, me->me_ens2);
+  struct Mi_EntreeMemo_st **pm = mi_memo.mo_seaux + s;
+  while (*pm != me)
+    pm = &(*pm)->me_suivseau;
+  *pm = me->me_suivseau;
+  mi_memo_delier (me);
+  mi_memo.mo_nombre--;
+  mi_memo.mo_octets -= me->me_octets;
+  memset (me, 0, sizeof (*me));
+  free (me);
+}				// fin mi_memo_enlever
+
+// oublier les moins récents jusqu'à respecter le budget
+static void
+mi_memo_restreindre (size_t budget)
+{
+  while (mi_memo.mo_ancien && mi_memo.mo_octets > budget)
+    {
+      mi_memo_enlever (mi_memo.mo_ancien);
+      mi_memo.mo_evictions++;
+    }
+}				// fin mi_memo_restreindre
+
+static void
+mi_memo_agrandir (void)
+{
+  unsigned nouvnb = 2 * mi_memo.mo_nbseaux + 61;
+  struct Mi_EntreeMemo_st **nouvseaux =
+    calloc (nouvnb, sizeof (struct Mi_EntreeMemo_st *));
+  if (!nouvseaux)
+    MI_FATALPRINTF ("impossible d'allouer %u seaux du cache (%s)", nouvnb,
+                    strerror (errno));
+  struct Mi_EntreeMemo_st **ancseaux = mi_memo.mo_seaux;
+  unsigned ancnb = mi_memo.mo_nbseaux;
+  mi_memo.mo_seaux = nouvseaux;
+  mi_memo.mo_nbseaux = nouvnb;
+  for (unsigned ix = 0; ix < ancnb; ix++)
+    for (struct Mi_EntreeMemo_st * me = ancseaux[ix], *suiv = NULL; me;
+         me = suiv)
+      {
+        suiv = me->me_suivseau;
+        unsigned s = mi_memo_seau (me->me_op, me->me_ens1, me->me_ens2);
+        me->me_suivseau = nouvseaux[s];
+        nouvseaux[s] = me;
+      }
+  free (ancseaux);
+}				// fin mi_memo_agrandir
+
+// les hash ne sont comparés que s'ils sont tous deux calculés
+static inline bool
+mi_memo_hash_compatible (unsigned h, const Mit_Ensemble * en)
+{
+  return !h || !en->mi_hash || h == en->mi_hash;
+}				// fin mi_memo_hash_compatible
+
+static const Mit_Ensemble *
+mi_memo_chercher (enum mi_opens_en op, const Mit_Ensemble * en1,
+                  const Mit_Ensemble * en2)
+{
+  if (!mi_memo.mo_nombre)
+    return NULL;
+  for (struct Mi_EntreeMemo_st * me =
+         mi_memo.mo_seaux[mi_memo_seau (op, en1, en2)]; me;
+       me = me->me_suivseau)
+    if (me->me_op == op && me->me_ens1 == en1 && me->me_ens2 == en2
+        && mi_memo_hash_compatible (me->me_hash1, en1)
+        && mi_memo_hash_compatible (me->me_hash2, en2))
+      {
+        mi_memo_delier (me);
+        mi_memo_en_tete (me);
+        return me->me_res;
+      }
+  return NULL;
+}				// fin mi_memo_chercher
+
+static void
+mi_memo_ajouter (enum mi_opens_en op, const Mit_Ensemble * en1,
+                 const Mit_Ensemble * en2, const Mit_Ensemble * res)
+{
+  size_t octets = mi_memo_octets (en1, en2, res);
+  if (octets > mi_memo.mo_budget / 4)
+    return;
+  mi_memo_restreindre (mi_memo.mo_budget - octets);
+  if (mi_memo.mo_nombre >= 2 * mi_memo.mo_nbseaux)
+    mi_memo_agrandir ();
+  struct Mi_EntreeMemo_st *me = calloc (1, sizeof (struct Mi_EntreeMemo_st));
+  if (!me)
+    MI_FATALPRINTF ("impossible d'allouer une entrée du cache (%s)",
+                    strerror (errno));
+  me->me_op = op;
+  me->me_ens1 = en1;
+  me->me_ens2 = en2;
+  me->me_hash1 = en1->mi_hash;
+  me->me_hash2 = en2->mi_hash;
+  me->me_res = res;
+  me->me_octets = octets;
+  unsigned s = mi_memo_seau (op, en1, en2);
+  me->me_suivseau = mi_memo.mo_seaux[s];
+  mi_memo.mo_seaux[s] = me;
+  mi_memo_en_tete (me);
+  mi_memo.mo_nombre++;
+  mi_memo.mo_octets += octets;
+}				// fin mi_memo_ajouter
+
+size_t
+mi_memo_ensembles_budget (size_t budget)
+{
+  size_t ancien = mi_memo.mo_budget;
+  mi_memo.mo_budget = budget;
+  mi_memo_restreindre (budget);
+  return ancien;
+}				// fin mi_memo_ensembles_budget
+
+void
+mi_memo_ensembles_vider (void)
+{
+  mi_memo_restreindre (0);
+  assert (mi_memo.mo_nombre == 0 && mi_memo.mo_octets == 0);
+}				// fin mi_memo_ensembles_vider
+
+void
+mi_memo_ensembles_stat (struct Mi_StatMemo_st *st)
+{
+  if (!st)
+    return;
+  st->sm_succes = mi_memo.mo_succes;
+  st->sm_echecs = mi_memo.mo_echecs;
+  st->sm_evictions = mi_memo.mo_evictions;
+  st->sm_nombre = mi_memo.mo_nombre;
+  st->sm_octets = mi_memo.mo_octets;
+  st->sm_budget = mi_memo.mo_budget;
+}				// fin mi_memo_ensembles_stat
+
+// l'union ou l'intersection, par le cache quand les opérandes sont
+// assez grands; elles sont commutatives, donc les opérandes sont
+// rangés par adresse
+static const Mit_Ensemble *
+mi_memo_operation (enum mi_opens_en op, const Mit_Ensemble * en1,
+                   const Mit_Ensemble * en2,
+                   const Mit_Ensemble * (*calcul) (const Mit_Ensemble *,
+                       const Mit_Ensemble *))
+{
+  if (!en1 || en1->mi_type != MiTy_Ensemble || !en2
+      || en2->mi_type != MiTy_Ensemble || en1 == en2
+      || (unsigned long) en1->mi_taille + en2->mi_taille < MI_MEMO_SEUIL
+      || en1->mi_taille == 0 || en2->mi_taille == 0 || !mi_memo.mo_budget)
+    return (*calcul) (en1, en2);
+  if ((uintptr_t) en1 > (uintptr_t) en2)
+    {
+      const Mit_Ensemble *e = en1;
+      en1 = en2;
+      en2 = e;
+    }
+  const Mit_Ensemble *res = mi_memo_chercher (op, en1, en2);
+  if (res)
+    {
+      mi_memo.mo_succes++;
+      return res;
+    }
+  mi_memo.mo_echecs++;
+  res = (*calcul) (en1, en2);
+  mi_memo_ajouter (op, en1, en2, res);
+  return res;
+}				// fin mi_memo_operation
+
+static const Mit_Ensemble *
+mi_ensemble_union_directe (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
 {
   unsigned ca1 = 0, ca2 = 0;
   if (!en1 || en1->mi_type != MiTy_Ensemble)
@@ -427,59 +1110,105 @@ mi_ensemble_union (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
   ca2 = en2 ? en2->mi_taille : 0;
   if (ca1 == 0 && ca2 == 0)
     return mi_ensemble_vide ();
-  unsigned ta = ca1 + ca2 + 1;
-  const Mit_Symbole **tab = calloc (ta, sizeof (Mit_Symbole *));
-  if (!tab)
-    MI_FATALPRINTF ("impossible d'allouer table de %u symboles", ta);
+  if (ca2 == 0 || en1 == en2)
+    return en1;
+  if (ca1 == 0)
+    return en2;
+  // le premier ensemble est le plus grand
+  if (ca1 < ca2)
+    {
+      const Mit_Ensemble *e = en1;
+      en1 = en2;
+      en2 = e;
+      ca1 = en1->mi_taille;
+      ca2 = en2->mi_taille;
+    }
+  if ((unsigned long) ca1 + ca2 > INT_MAX / 2)
+    MI_FATALPRINTF ("trop d'elements %u+%u dans l'union de deux ensembles",
+                    ca1, ca2);
+  if (en1->mi_compact)
+    return mi_ensemble_operation_cartes (MiOpEns_Union, en1, en2);
+  Mit_Symbole *const *el1 = en1->mi_elements;
+  Mit_Symbole *const *el2 = en2->mi_elements;
+  unsigned ta = ca1 + ca2;
+  Mit_Ensemble *enr = mi_allouer_ensemble (ta);
+  Mit_Symbole **tab = enr->mi_elements;
+  // ensembles disjoints et ordonnés: deux copies suffisent
+  if (mi_cle_symbole (el1[ca1 - 1]) < mi_cle_symbole (el2[0]))
+    {
+      memcpy (tab, el1, ca1 * sizeof (Mit_Symbole *));
+      memcpy (tab + ca1, el2, ca2 * sizeof (Mit_Symbole *));
+      return mi_finir_ensemble (enr, ta, ta);
+    }
+  if (mi_cle_symbole (el2[ca2 - 1]) < mi_cle_symbole (el1[0]))
+    {
+      memcpy (tab, el2, ca2 * sizeof (Mit_Symbole *));
+      memcpy (tab + ca2, el1, ca1 * sizeof (Mit_Symbole *));
+      return mi_finir_ensemble (enr, ta, ta);
+    }
   unsigned i1 = 0, i2 = 0, nbun = 0;
-  while (i1 < ca1 && i2 < ca2)
+  if (ca1 / ca2 >= MI_ENSEMBLE_RAPPORT_GALOP)
     {
-      const Mit_Symbole *sy1 = en1->mi_elements[i1];
-      const Mit_Symbole *sy2 = en2->mi_elements[i2];
-      assert (sy1 && sy1->mi_type == MiTy_Symbole);
-      assert (sy2 && sy2->mi_type == MiTy_Symbole);
-      assert (nbun < ta);
-      int cmp = mi_cmp_symbole (sy1, sy2);
-      if (cmp < 0)
+      for (i2 = 0; i2 < ca2; i2++)
         {
-          tab[nbun++] = sy1;
-          i1++;
+          const Mit_Symbole *sy2 = el2[i2];
+          unsigned j = mi_ensemble_galoper (el1, i1, ca1, sy2);
+          memcpy (tab + nbun, el1 + i1, (j - i1) * sizeof (Mit_Symbole *));
+          nbun += j - i1;
+          i1 = j;
+          if (i1 < ca1 && el1[i1] == sy2)
+            i1++;
+          tab[nbun++] = (Mit_Symbole *) sy2;
         }
-      else if (cmp > 0)
+    }
+  else
+    {
+      // copier chaque suite d'éléments d'un ensemble qui précède
+      // l'élément courant de l'autre
+      while (i1 < ca1 && i2 < ca2)
         {
-          tab[nbun++] = sy2;
-          i2++;
+          uint64_t c2 = mi_cle_symbole (el2[i2]);
+          unsigned j = mi_ensemble_avancer (el1, i1, ca1, c2);
+          while (i1 < j)
+            tab[nbun++] = el1[i1++];
+          if (i1 >= ca1)
+            break;
+          uint64_t c1 = mi_cle_symbole (el1[i1]);
+          if (c1 == c2)
+            {
+              assert (el1[i1] == el2[i2]);
+              tab[nbun++] = el1[i1];
+              i1++, i2++;
+              continue;
+            }
+          j = mi_ensemble_avancer (el2, i2, ca2, c1);
+          while (i2 < j)
+            tab[nbun++] = el2[i2++];
         }
-      else
+      if (i2 < ca2)
         {
-          assert (sy1 == sy2);
-          tab[nbun++] = sy1;
-          i1++, i2++;
+          memcpy (tab + nbun, el2 + i2, (ca2 - i2) * sizeof (Mit_Symbole *));
+          nbun += ca2 - i2;
         }
     }
   if (i1 < ca1)
-    for (unsigned ix = i1; ix < ca1; ix++)
-      tab[nbun++] = en1->mi_elements[ix];
-  else if (i2 < ca2)
-    for (unsigned ix = i2; ix < ca2; ix++)
-      tab[nbun++] = en2->mi_elements[ix];
-  if (nbun > INT_MAX / 2)
-    MI_FATALPRINTF ("trop d'elements %d dans l'union de deux ensembles",
-                    nbun);
-  Mit_Ensemble *enr = mi_allouer_valeur (MiTy_Ensemble,
-                                         sizeof (Mit_Ensemble) +
-                                         nbun * sizeof (Mit_Symbole *));
-  enr->mi_taille = nbun;
-  if (nbun > 0)
-    memcpy (enr->mi_elements, tab, nbun * sizeof (Mit_Symbole *));
-  mi_calculer_hash_ensemble (enr);
-  free (tab);
-  return enr;
-}				/* fin mi_ensemble_union */
+    {
+      memcpy (tab + nbun, el1 + i1, (ca1 - i1) * sizeof (Mit_Symbole *));
+      nbun += ca1 - i1;
+    }
+  // le petit ensemble était inclus dans le grand
+  if (nbun == ca1)
+    {
+      mi_liberer_valeur_fraiche (enr);
+      return en1;
+    }
+  return mi_finir_ensemble (enr, ta, nbun);
+}				/* fin mi_ensemble_union_directe */
 
 
-const Mit_Ensemble *
-mi_ensemble_intersection (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
+static const Mit_Ensemble *
+mi_ensemble_intersection_directe (const Mit_Ensemble * en1,
+                                  const Mit_Ensemble * en2)
 {
   unsigned ca1 = 0, ca2 = 0;
   if (!en1 || en1->mi_type != MiTy_Ensemble)
@@ -490,42 +1219,559 @@ mi_ensemble_intersection (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
   ca2 = en2 ? en2->mi_taille : 0;
   if (ca1 == 0 || ca2 == 0)
     return mi_ensemble_vide ();
-  unsigned ta = ((ca1 > ca2) ? ca1 : ca2) + 1;
-  const Mit_Symbole **tab = calloc (ta, sizeof (Mit_Symbole *));
-  if (!tab)
-    MI_FATALPRINTF ("impossible d'allouer table de %u symboles", ta);
+  if (en1 == en2)
+    return en1;
+  // le premier ensemble est le plus grand
+  if (ca1 < ca2)
+    {
+      const Mit_Ensemble *e = en1;
+      en1 = en2;
+      en2 = e;
+      ca1 = en1->mi_taille;
+      ca2 = en2->mi_taille;
+    }
+  if (en2->mi_compact)
+    return mi_ensemble_operation_cartes (MiOpEns_Inter, en1, en2);
+  unsigned ta = ca2;
   unsigned i1 = 0, i2 = 0, nbin = 0;
-  while (i1 < ca1 && i2 < ca2)
+  Mit_Symbole *const *el2 = en2->mi_elements;
+  if (en1->mi_compact)
     {
-      const Mit_Symbole *sy1 = en1->mi_elements[i1];
-      const Mit_Symbole *sy2 = en2->mi_elements[i2];
-      assert (sy1 && sy1->mi_type == MiTy_Symbole);
-      assert (sy2 && sy2->mi_type == MiTy_Symbole);
-      assert (nbin < ta);
-      int cmp = mi_cmp_symbole (sy1, sy2);
-      if (cmp < 0)
-        i1++;
-      else if (cmp > 0)
-        i2++;
-      else
+      // chercher chaque élément du petit ensemble dans la carte
+      Mit_Ensemble *enr = mi_allouer_ensemble (ta);
+      for (i2 = 0; i2 < ca2; i2++)
+        if (mi_cartebits_contient (en1->mi_compact, el2[i2]->mi_ident))
+          enr->mi_tabelem[nbin++] = el2[i2];
+      if (nbin == ca2)
+        {
+          mi_liberer_valeur_fraiche (enr);
+          return en2;
+        }
+      return mi_finir_ensemble (enr, ta, nbin);
+    }
+  Mit_Symbole *const *el1 = en1->mi_elements;
+  if (mi_cle_symbole (el1[ca1 - 1]) < mi_cle_symbole (el2[0])
+      || mi_cle_symbole (el2[ca2 - 1]) < mi_cle_symbole (el1[0]))
+    return mi_ensemble_vide ();
+  Mit_Ensemble *enr = mi_allouer_ensemble (ta);
+  Mit_Symbole **tab = enr->mi_elements;
+  if (ca1 / ca2 >= MI_ENSEMBLE_RAPPORT_GALOP)
+    {
+      for (i2 = 0; i2 < ca2 && i1 < ca1; i2++)
         {
-          assert (sy1 == sy2);
-          tab[nbin++] = sy1;
-          i1++, i2++;
+          const Mit_Symbole *sy2 = el2[i2];
+          i1 = mi_ensemble_galoper (el1, i1, ca1, sy2);
+          if (i1 < ca1 && el1[i1] == sy2)
+            tab[nbin++] = (Mit_Symbole *) sy2, i1++;
         }
     }
-  if (nbin == 0)
+  else
     {
-      free (tab);
-      return mi_ensemble_vide ();
+      // sauter chaque suite d'éléments d'un ensemble qui précède
+      // l'élément courant de l'autre
+      while (i1 < ca1 && i2 < ca2)
+        {
+          uint64_t c2 = mi_cle_symbole (el2[i2]);
+          i1 = mi_ensemble_avancer (el1, i1, ca1, c2);
+          if (i1 >= ca1)
+            break;
+          uint64_t c1 = mi_cle_symbole (el1[i1]);
+          if (c1 == c2)
+            {
+              assert (el1[i1] == el2[i2]);
+              tab[nbin++] = el1[i1];
+              i1++, i2++;
+              continue;
+            }
+          i2 = mi_ensemble_avancer (el2, i2, ca2, c1);
+        }
     }
-  Mit_Ensemble *enr = mi_allouer_valeur (MiTy_Ensemble,
-                                         sizeof (Mit_Ensemble) +
-                                         nbin * sizeof (Mit_Symbole *));
-  enr->mi_taille = nbin;
-  if (nbin > 0)
-    memcpy (enr->mi_elements, tab, nbin * sizeof (Mit_Symbole *));
-  mi_calculer_hash_ensemble (enr);
-  free (tab);
-  return enr;
+  // le petit ensemble était inclus dans le grand
+  if (nbin == ca2)
+    {
+      mi_liberer_valeur_fraiche (enr);
+      return en2;
+    }
+  return mi_finir_ensemble (enr, ta, nbin);
+}				/* fin mi_ensemble_intersection_directe */
+
+const Mit_Ensemble *
+mi_ensemble_union (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
+{
+  return mi_memo_operation (MiOpEns_Union, en1, en2,
+                            mi_ensemble_union_directe);
+}				/* fin mi_ensemble_union */
+
+const Mit_Ensemble *
+mi_ensemble_intersection (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
+{
+  return mi_memo_operation (MiOpEns_Inter, en1, en2,
+                            mi_ensemble_intersection_directe);
 }				/* fin mi_ensemble_intersection */
+
+
+/// Les opérations sur plusieurs ensembles n'allouent que le résultat.
+/// L'union fusionne les ensembles par un tas de curseurs ordonné par
+/// la clef de leur symbole courant; l'intersection parcourt le plus
+/// petit ensemble et cherche chacun de ses éléments dans les autres,
+/// du plus petit au plus grand, en galopant.
+struct Mi_CurseurEns_st
+{
+  uint64_t ce_cle;		// clef du symbole courant
+  unsigned ce_pos;		// rang du symbole courant
+  const Mit_Ensemble *ce_ens;
+};
+
+static void
+mi_tas_curseurs_descendre (struct Mi_CurseurEns_st *tas, unsigned nb,
+                           unsigned ix)
+{
+  struct Mi_CurseurEns_st c = tas[ix];
+  for (;;)
+    {
+      unsigned fils = 2 * ix + 1;
+      if (fils >= nb)
+        break;
+      if (fils + 1 < nb && tas[fils + 1].ce_cle < tas[fils].ce_cle)
+        fils++;
+      if (c.ce_cle <= tas[fils].ce_cle)
+        break;
+      tas[ix] = tas[fils];
+      ix = fils;
+    }
+  tas[ix] = c;
+}				// fin mi_tas_curseurs_descendre
+
+// garde les ensembles non vides, et renvoie leur nombre
+static unsigned
+mi_ensembles_non_vides (unsigned nb, const Mit_Ensemble **tabens,
+                        const Mit_Ensemble **tabnv)
+{
+  unsigned n = 0;
+  for (unsigned ix = 0; ix < nb; ix++)
+    {
+      const Mit_Ensemble *en = tabens[ix];
+      if (en && en->mi_type == MiTy_Ensemble && en->mi_taille > 0)
+        tabnv[n++] = en;
+    }
+  return n;
+}				// fin mi_ensembles_non_vides
+
+const Mit_Ensemble *
+mi_ensemble_union_multiple (unsigned nb, const Mit_Ensemble **tabens)
+{
+  if (nb == 0 || !tabens)
+    return mi_ensemble_vide ();
+  const Mit_Ensemble **tabnv = calloc (nb, sizeof (Mit_Ensemble *));
+  if (!tabnv)
+    MI_FATALPRINTF ("impossible d'allouer %u ensembles (%s)", nb,
+                    strerror (errno));
+  unsigned nbe = mi_ensembles_non_vides (nb, tabens, tabnv);
+  const Mit_Ensemble *enr = NULL;
+  if (nbe == 0)
+    enr = mi_ensemble_vide ();
+  else if (nbe == 1)
+    enr = tabnv[0];
+  else if (nbe == 2)
+    enr = mi_ensemble_union (tabnv[0], tabnv[1]);
+  if (enr)
+    {
+      free (tabnv);
+      return enr;
+    }
+  // avec un ensemble compact, l'union se fait sur les cartes de bits:
+  // une pour tous les ensembles ordinaires, réunie aux compacts
+  bool aveccompact = false;
+  for (unsigned ix = 0; ix < nbe; ix++)
+    aveccompact = aveccompact || tabnv[ix]->mi_compact != NULL;
+  if (aveccompact)
+    {
+      struct Mi_ConstrCarte_st *cc =
+        mi_constrcarte_creer (mi_symbole_borne_ident ());
+      for (unsigned ix = 0; ix < nbe; ix++)
+        if (!tabnv[ix]->mi_compact)
+          for (unsigned iy = 0; iy < tabnv[ix]->mi_taille; iy++)
+            mi_constrcarte_ajouter (cc, tabnv[ix]->mi_elements[iy]->mi_ident);
+      struct Mi_CarteBits_st *cb = mi_constrcarte_finir (cc);
+      for (unsigned ix = 0; ix < nbe; ix++)
+        if (tabnv[ix]->mi_compact)
+          {
+            struct Mi_CarteBits_st *cbu =
+              mi_cartebits_operation (MiOpEns_Union, cb,
+                                      tabnv[ix]->mi_compact);
+            mi_cartebits_detruire (cb);
+            cb = cbu;
+          }
+      enr = mi_ensemble_carte (cb);
+    }
+  if (enr)
+    {
+      free (tabnv);
+      return enr;
+    }
+  unsigned long total = 0;
+  const Mit_Ensemble *plusgrand = NULL;
+  struct Mi_CurseurEns_st *tas =
+    calloc (nbe, sizeof (struct Mi_CurseurEns_st));
+  if (!tas)
+    MI_FATALPRINTF ("impossible d'allouer %u curseurs (%s)", nbe,
+                    strerror (errno));
+  for (unsigned ix = 0; ix < nbe; ix++)
+    {
+      const Mit_Ensemble *en = tabnv[ix];
+      total += en->mi_taille;
+      if (!plusgrand || en->mi_taille > plusgrand->mi_taille)
+        plusgrand = en;
+      tas[ix].ce_ens = en;
+      tas[ix].ce_pos = 0;
+      tas[ix].ce_cle = mi_cle_symbole (en->mi_elements[0]);
+    }
+  free (tabnv);
+  if (total > INT_MAX / 2)
+    MI_FATALPRINTF ("trop d'elements %lu dans l'union de %u ensembles",
+                    total, nbe);
+  for (unsigned ix = nbe / 2; ix > 0; ix--)
+    mi_tas_curseurs_descendre (tas, nbe, ix - 1);
+  Mit_Ensemble *ennouv = mi_allouer_ensemble (total);
+  Mit_Symbole **tab = ennouv->mi_elements;
+  unsigned nbun = 0;
+  unsigned nbtas = nbe;
+  while (nbtas > 0)
+    {
+      struct Mi_CurseurEns_st *c = tas;
+      Mit_Symbole *sy = c->ce_ens->mi_elements[c->ce_pos];
+      if (nbun == 0 || tab[nbun - 1] != sy)
+        tab[nbun++] = sy;
+      if (++c->ce_pos < c->ce_ens->mi_taille)
+        c->ce_cle = mi_cle_symbole (c->ce_ens->mi_elements[c->ce_pos]);
+      else
+        tas[0] = tas[--nbtas];
+      if (nbtas > 0)
+        mi_tas_curseurs_descendre (tas, nbtas, 0);
+    }
+  free (tas);
+  // un des ensembles contenait tous les autres
+  if (nbun == plusgrand->mi_taille)
+    {
+      mi_liberer_valeur_fraiche (ennouv);
+      return plusgrand;
+    }
+  return mi_finir_ensemble (ennouv, total, nbun);
+}				/* fin mi_ensemble_union_multiple */
+
+static int
+mi_cmp_taille_ensemble (const void *p1, const void *p2)
+{
+  const Mit_Ensemble *en1 = *(const Mit_Ensemble **) p1;
+  const Mit_Ensemble *en2 = *(const Mit_Ensemble **) p2;
+  if (en1->mi_taille < en2->mi_taille)
+    return -1;
+  if (en1->mi_taille > en2->mi_taille)
+    return 1;
+  return 0;
+}				// fin mi_cmp_taille_ensemble
+
+const Mit_Ensemble *
+mi_ensemble_intersection_multiple (unsigned nb, const Mit_Ensemble **tabens)
+{
+  if (nb == 0 || !tabens)
+    return mi_ensemble_vide ();
+  const Mit_Ensemble **tabnv = calloc (nb, sizeof (Mit_Ensemble *));
+  unsigned *tabpos = calloc (nb, sizeof (unsigned));
+  if (!tabnv || !tabpos)
+    MI_FATALPRINTF ("impossible d'allouer %u ensembles (%s)", nb,
+                    strerror (errno));
+  const Mit_Ensemble *enr = NULL;
+  unsigned nbe = mi_ensembles_non_vides (nb, tabens, tabnv);
+  // un ensemble vide ou invalide rend l'intersection vide
+  if (nbe < nb)
+    enr = mi_ensemble_vide ();
+  else if (nbe == 1)
+    enr = tabnv[0];
+  else if (nbe == 2)
+    enr = mi_ensemble_intersection (tabnv[0], tabnv[1]);
+  if (!enr)
+    {
+      qsort (tabnv, nbe, sizeof (Mit_Ensemble *), mi_cmp_taille_ensemble);
+      // le plus petit ensemble est compact: tous le sont
+      if (tabnv[0]->mi_compact)
+        {
+          struct Mi_CarteBits_st *cb =
+            mi_cartebits_operation (MiOpEns_Inter, tabnv[0]->mi_compact,
+                                    tabnv[1]->mi_compact);
+          for (unsigned ix = 2; ix < nbe; ix++)
+            {
+              struct Mi_CarteBits_st *cbi =
+                mi_cartebits_operation (MiOpEns_Inter, cb,
+                                        tabnv[ix]->mi_compact);
+              mi_cartebits_detruire (cb);
+              cb = cbi;
+            }
+          enr = mi_ensemble_carte (cb);
+        }
+    }
+  if (!enr)
+    {
+      // les intervalles de clefs des ensembles non compacts doivent se
+      // recouvrir
+      uint64_t clemin = 0, clemax = UINT64_MAX;
+      for (unsigned ix = 0; ix < nbe; ix++)
+        {
+          const Mit_Ensemble *en = tabnv[ix];
+          if (en->mi_compact)
+            continue;
+          Mit_Symbole *const *el = en->mi_elements;
+          uint64_t c0 = mi_cle_symbole (el[0]);
+          uint64_t c1 = mi_cle_symbole (el[en->mi_taille - 1]);
+          if (c0 > clemin)
+            clemin = c0;
+          if (c1 < clemax)
+            clemax = c1;
+        }
+      if (clemin > clemax)
+        enr = mi_ensemble_vide ();
+    }
+  if (enr)
+    {
+      free (tabnv);
+      free (tabpos);
+      return enr;
+    }
+  const Mit_Ensemble *petit = tabnv[0];
+  unsigned ta = petit->mi_taille;
+  Mit_Ensemble *ennouv = mi_allouer_ensemble (ta);
+  Mit_Symbole **tab = ennouv->mi_elements;
+  unsigned nbin = 0;
+  bool fini = false;
+  for (unsigned i0 = 0; i0 < ta && !fini; i0++)
+    {
+      Mit_Symbole *sy = petit->mi_elements[i0];
+      bool partout = true;
+      for (unsigned ix = 1; ix < nbe && partout; ix++)
+        {
+          const Mit_Ensemble *en = tabnv[ix];
+          if (en->mi_compact)
+            {
+              partout = mi_cartebits_contient (en->mi_compact, sy->mi_ident);
+              continue;
+            }
+          unsigned p = mi_ensemble_galoper (en->mi_elements, tabpos[ix],
+                                            en->mi_taille, sy);
+          tabpos[ix] = p;
+          if (p >= en->mi_taille)
+            fini = true, partout = false;
+          else if (en->mi_elements[p] != sy)
+            partout = false;
+        }
+      if (partout)
+        tab[nbin++] = sy;
+    }
+  free (tabnv);
+  free (tabpos);
+  if (nbin == ta)
+    {
+      mi_liberer_valeur_fraiche (ennouv);
+      return petit;
+    }
+  return mi_finir_ensemble (ennouv, ta, nbin);
+}				/* fin mi_ensemble_intersection_multiple */
+
+
+const Mit_Ensemble *
+mi_ensemble_difference (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
+{
+  if (!en1 || en1->mi_type != MiTy_Ensemble || en1->mi_taille == 0
+      || en1 == en2)
+    return mi_ensemble_vide ();
+  if (!en2 || en2->mi_type != MiTy_Ensemble || en2->mi_taille == 0)
+    return en1;
+  unsigned ca1 = en1->mi_taille, ca2 = en2->mi_taille;
+  if (en1->mi_compact)
+    return mi_ensemble_operation_cartes (MiOpEns_Diff, en1, en2);
+  Mit_Symbole *const *el1 = en1->mi_elements;
+  unsigned i1 = 0, i2 = 0, nbdif = 0;
+  if (en2->mi_compact)
+    {
+      Mit_Ensemble *enr = mi_allouer_ensemble (ca1);
+      for (i1 = 0; i1 < ca1; i1++)
+        if (!mi_cartebits_contient (en2->mi_compact, el1[i1]->mi_ident))
+          enr->mi_tabelem[nbdif++] = el1[i1];
+      if (nbdif == ca1)
+        {
+          mi_liberer_valeur_fraiche (enr);
+          return en1;
+        }
+      return mi_finir_ensemble (enr, ca1, nbdif);
+    }
+  Mit_Symbole *const *el2 = en2->mi_elements;
+  if (mi_cle_symbole (el1[ca1 - 1]) < mi_cle_symbole (el2[0])
+      || mi_cle_symbole (el2[ca2 - 1]) < mi_cle_symbole (el1[0]))
+    return en1;
+  Mit_Ensemble *enr = mi_allouer_ensemble (ca1);
+  Mit_Symbole **tab = enr->mi_elements;
+  if (ca2 / ca1 >= MI_ENSEMBLE_RAPPORT_GALOP)
+    {
+      // chercher chaque élément du petit premier ensemble dans le grand
+      for (i1 = 0; i1 < ca1; i1++)
+        {
+          Mit_Symbole *sy1 = el1[i1];
+          i2 = mi_ensemble_galoper (el2, i2, ca2, sy1);
+          if (i2 >= ca2 || el2[i2] != sy1)
+            tab[nbdif++] = sy1;
+        }
+    }
+  else if (ca1 / ca2 >= MI_ENSEMBLE_RAPPORT_GALOP)
+    {
+      // recopier les plages du grand premier ensemble entre les
+      // éléments du second
+      for (i2 = 0; i2 < ca2 && i1 < ca1; i2++)
+        {
+          unsigned j = mi_ensemble_galoper (el1, i1, ca1, el2[i2]);
+          memcpy (tab + nbdif, el1 + i1, (j - i1) * sizeof (Mit_Symbole *));
+          nbdif += j - i1;
+          i1 = (j < ca1 && el1[j] == el2[i2]) ? j + 1 : j;
+        }
+      memcpy (tab + nbdif, el1 + i1, (ca1 - i1) * sizeof (Mit_Symbole *));
+      nbdif += ca1 - i1;
+    }
+  else
+    {
+      while (i1 < ca1 && i2 < ca2)
+        {
+          uint64_t c1 = mi_cle_symbole (el1[i1]);
+          uint64_t c2 = mi_cle_symbole (el2[i2]);
+          if (c1 < c2)
+            tab[nbdif++] = el1[i1++];
+          else if (c1 > c2)
+            i2++;
+          else
+            i1++, i2++;
+        }
+      memcpy (tab + nbdif, el1 + i1, (ca1 - i1) * sizeof (Mit_Symbole *));
+      nbdif += ca1 - i1;
+    }
+  if (nbdif == ca1)
+    {
+      mi_liberer_valeur_fraiche (enr);
+      return en1;
+    }
+  return mi_finir_ensemble (enr, ca1, nbdif);
+}				/* fin mi_ensemble_difference */
+
+const Mit_Ensemble *
+mi_ensemble_difference_symetrique (const Mit_Ensemble * en1,
+                                   const Mit_Ensemble * en2)
+{
+  if (!en1 || en1->mi_type != MiTy_Ensemble || en1->mi_taille == 0)
+    return mi_ensemble_difference (en2, NULL);
+  if (!en2 || en2->mi_type != MiTy_Ensemble || en2->mi_taille == 0
+      || en1 == en2)
+    return mi_ensemble_difference (en1, en2);
+  unsigned ca1 = en1->mi_taille, ca2 = en2->mi_taille;
+  if (en1->mi_compact || en2->mi_compact)
+    return mi_ensemble_operation_cartes (MiOpEns_DiffSym, en1, en2);
+  // des ensembles disjoints ont pour différence symétrique leur union
+  if (mi_cle_symbole (en1->mi_elements[ca1 - 1])
+      < mi_cle_symbole (en2->mi_elements[0])
+      || mi_cle_symbole (en2->mi_elements[ca2 - 1])
+      < mi_cle_symbole (en1->mi_elements[0]))
+    return mi_ensemble_union (en1, en2);
+  if ((unsigned long) ca1 + ca2 > INT_MAX / 2)
+    MI_FATALPRINTF ("trop d'elements %u+%u dans la différence symétrique",
+                    ca1, ca2);
+  Mit_Symbole *const *el1 = en1->mi_elements;
+  Mit_Symbole *const *el2 = en2->mi_elements;
+  unsigned ta = ca1 + ca2;
+  Mit_Ensemble *enr = mi_allouer_ensemble (ta);
+  Mit_Symbole **tab = enr->mi_elements;
+  unsigned i1 = 0, i2 = 0, nbdif = 0;
+  while (i1 < ca1 && i2 < ca2)
+    {
+      uint64_t c1 = mi_cle_symbole (el1[i1]);
+      uint64_t c2 = mi_cle_symbole (el2[i2]);
+      if (c1 < c2)
+        tab[nbdif++] = el1[i1++];
+      else if (c1 > c2)
+        tab[nbdif++] = el2[i2++];
+      else
+        i1++, i2++;
+    }
+  memcpy (tab + nbdif, el1 + i1, (ca1 - i1) * sizeof (Mit_Symbole *));
+  nbdif += ca1 - i1;
+  memcpy (tab + nbdif, el2 + i2, (ca2 - i2) * sizeof (Mit_Symbole *));
+  nbdif += ca2 - i2;
+  return mi_finir_ensemble (enr, ta, nbdif);
+}				/* fin mi_ensemble_difference_symetrique */
+
+bool
+mi_ensemble_egal (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
+{
+  if (en1 == en2)
+    return true;
+  if (!en1 || en1->mi_type != MiTy_Ensemble || !en2
+      || en2->mi_type != MiTy_Ensemble)
+    return false;
+  // deux ensembles partagés distincts sont différents
+  if (en1->mi_partage && en2->mi_partage)
+    return false;
+  if (en1->mi_taille != en2->mi_taille)
+    return false;
+  if (en1->mi_compact && en2->mi_compact)
+    return mi_cartebits_egales (en1->mi_compact, en2->mi_compact);
+  // le hash d'un ensemble compact n'est peut-être pas encore calculé
+  if (en1->mi_hash && en2->mi_hash && en1->mi_hash != en2->mi_hash)
+    return false;
+  // de même cardinal, aucun des deux n'est compact
+  return !memcmp (en1->mi_elements, en2->mi_elements,
+                  en1->mi_taille * sizeof (Mit_Symbole *));
+}				/* fin mi_ensemble_egal */
+
+/// vrai si tous les éléments de en1 sont dans en2
+bool
+mi_ensemble_inclus (const Mit_Ensemble * en1, const Mit_Ensemble * en2)
+{
+  if (!en1 || en1->mi_type != MiTy_Ensemble || en1->mi_taille == 0
+      || en1 == en2)
+    return true;
+  if (!en2 || en2->mi_type != MiTy_Ensemble)
+    return false;
+  unsigned ca1 = en1->mi_taille, ca2 = en2->mi_taille;
+  if (ca1 > ca2)
+    return false;
+  if (ca1 == ca2)
+    return mi_ensemble_egal (en1, en2);
+  if (en1->mi_compact && en2->mi_compact)
+    {
+      struct Mi_CarteBits_st *cb =
+        mi_cartebits_operation (MiOpEns_Diff, en1->mi_compact,
+                                en2->mi_compact);
+      bool vide = mi_cartebits_cardinal (cb) == 0;
+      mi_cartebits_detruire (cb);
+      return vide;
+    }
+  if (en2->mi_compact)
+    {
+      Mit_Symbole *const *el = en1->mi_elements;
+      for (unsigned i1 = 0; i1 < ca1; i1++)
+        if (!mi_cartebits_contient (en2->mi_compact, el[i1]->mi_ident))
+          return false;
+      return true;
+    }
+  Mit_Symbole *const *el1 = en1->mi_elements;
+  Mit_Symbole *const *el2 = en2->mi_elements;
+  if (mi_cle_symbole (el1[0]) < mi_cle_symbole (el2[0])
+      || mi_cle_symbole (el1[ca1 - 1]) > mi_cle_symbole (el2[ca2 - 1]))
+    return false;
+  unsigned i2 = 0;
+  for (unsigned i1 = 0; i1 < ca1; i1++)
+    {
+      // il doit rester assez d'éléments dans en2
+      if (ca2 - i2 < ca1 - i1)
+        return false;
+      i2 = mi_ensemble_galoper (el2, i2, ca2, el1[i1]);
+      if (i2 >= ca2 || el2[i2] != el1[i1])
+        return false;
+      i2++;
+    }
+  return true;
+}				/* fin mi_ensemble_inclus */
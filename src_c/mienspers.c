@@ -0,0 +1,375 @@
+// fichier mienspers.c - ensembles persistants de symboles
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file mienspers.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// Un ensemble persistant est un arbre de préfixes à 32 branches
+/// (hash array mapped trie, dans sa variante CHAMP) sur les
+/// identifiants des symboles, qui sont uniques et servent donc de
+/// hash sans collision possible. Chaque noeud a deux cartes de bits:
+/// celle des branches portant directement un symbole et celle des
+/// branches portant un sous-noeud; ses entrées sont les symboles
+/// puis les sous-noeuds. Ajouter ou ôter un symbole ne recopie que
+/// le chemin jusqu'à lui, le reste de l'arbre étant partagé avec
+/// l'ensemble d'origine, qui est inchangé. Un sous-noeud a toujours
+/// au moins deux symboles, si bien que la forme de l'arbre ne dépend
+/// que de son contenu.
+#define MI_HAMT_BITS 5
+#define MI_HAMT_MASQUE ((1u << MI_HAMT_BITS) - 1)
+
+struct Mi_NoeudHamt_st
+{
+  uint32_t nh_symboles;		// branches portant un symbole
+  uint32_t nh_fils;		// branches portant un sous-noeud
+  void *nh_ent[];		// les symboles, puis les sous-noeuds
+};
+
+static const Mit_EnsPersistant mi_enspvide =
+{
+  .mi_type = MiTy_EnsPersistant,
+  .mi_marq = true,
+  .mi_hash = 11,		// comme l'ensemble vide
+  .mi_taille = 0,
+  .mi_racine = NULL,
+  .mi_plat = NULL
+};
+
+static inline unsigned
+mi_hamt_branche (uint32_t id, unsigned niv)
+{
+  return (id >> (MI_HAMT_BITS * niv)) & MI_HAMT_MASQUE;
+}				// fin mi_hamt_branche
+
+static inline unsigned
+mi_hamt_nbent (const struct Mi_NoeudHamt_st *nh)
+{
+  return __builtin_popcount (nh->nh_symboles)
+         + __builtin_popcount (nh->nh_fils);
+}				// fin mi_hamt_nbent
+
+// le rang parmi les entrées de même sorte de la branche de bit donné
+static inline unsigned
+mi_hamt_rang (uint32_t carte, uint32_t bit)
+{
+  return __builtin_popcount (carte & (bit - 1));
+}				// fin mi_hamt_rang
+
+static struct Mi_NoeudHamt_st *
+mi_hamt_allouer (uint32_t symboles, uint32_t fils)
+{
+  unsigned nb = __builtin_popcount (symboles) + __builtin_popcount (fils);
+  struct Mi_NoeudHamt_st *nh =
+    malloc (sizeof (struct Mi_NoeudHamt_st) + nb * sizeof (void *));
+  if (!nh)
+    MI_FATALPRINTF ("impossible d'allouer un noeud de %u entrées (%s)",
+                    nb, strerror (errno));
+  nh->nh_symboles = symboles;
+  nh->nh_fils = fils;
+  return nh;
+}				// fin mi_hamt_allouer
+
+// le noeud de deux symboles distincts, depuis le niveau niv
+static struct Mi_NoeudHamt_st *
+mi_hamt_paire (Mit_Symbole *sy1, Mit_Symbole *sy2, unsigned niv)
+{
+  unsigned b1 = mi_hamt_branche (sy1->mi_ident, niv);
+  unsigned b2 = mi_hamt_branche (sy2->mi_ident, niv);
+  if (b1 == b2)
+    {
+      struct Mi_NoeudHamt_st *nh = mi_hamt_allouer (0, 1u << b1);
+      nh->nh_ent[0] = mi_hamt_paire (sy1, sy2, niv + 1);
+      return nh;
+    }
+  struct Mi_NoeudHamt_st *nh = mi_hamt_allouer ((1u << b1) | (1u << b2), 0);
+  nh->nh_ent[b1 < b2 ? 0 : 1] = sy1;
+  nh->nh_ent[b1 < b2 ? 1 : 0] = sy2;
+  return nh;
+}				// fin mi_hamt_paire
+
+// le noeud avec sy, ou nh lui-même s'il le contient déjà
+static struct Mi_NoeudHamt_st *
+mi_hamt_ajouter (struct Mi_NoeudHamt_st *nh, Mit_Symbole *sy, unsigned niv)
+{
+  if (!nh)
+    {
+      nh = mi_hamt_allouer (1u << mi_hamt_branche (sy->mi_ident, niv), 0);
+      nh->nh_ent[0] = sy;
+      return nh;
+    }
+  uint32_t bit = 1u << mi_hamt_branche (sy->mi_ident, niv);
+  unsigned nbsy = __builtin_popcount (nh->nh_symboles);
+  unsigned nbent = mi_hamt_nbent (nh);
+  struct Mi_NoeudHamt_st *nouv = NULL;
+  if (nh->nh_symboles & bit)
+    {
+      unsigned r = mi_hamt_rang (nh->nh_symboles, bit);
+      Mit_Symbole *ancsy = nh->nh_ent[r];
+      if (ancsy == sy)
+        return nh;
+      // le symbole descend dans un sous-noeud avec le nouveau
+      unsigned rf = mi_hamt_rang (nh->nh_fils, bit);
+      nouv = mi_hamt_allouer (nh->nh_symboles & ~bit, nh->nh_fils | bit);
+      memcpy (nouv->nh_ent, nh->nh_ent, r * sizeof (void *));
+      memcpy (nouv->nh_ent + r, nh->nh_ent + r + 1,
+              (nbsy - 1 - r + rf) * sizeof (void *));
+      nouv->nh_ent[nbsy - 1 + rf] = mi_hamt_paire (ancsy, sy, niv + 1);
+      memcpy (nouv->nh_ent + nbsy + rf, nh->nh_ent + nbsy + rf,
+              (nbent - nbsy - rf) * sizeof (void *));
+      return nouv;
+    }
+  if (nh->nh_fils & bit)
+    {
+      unsigned ix = nbsy + mi_hamt_rang (nh->nh_fils, bit);
+      struct Mi_NoeudHamt_st *fils = nh->nh_ent[ix];
+      struct Mi_NoeudHamt_st *nouvfils = mi_hamt_ajouter (fils, sy, niv + 1);
+      if (nouvfils == fils)
+        return nh;
+      nouv = mi_hamt_allouer (nh->nh_symboles, nh->nh_fils);
+      memcpy (nouv->nh_ent, nh->nh_ent, nbent * sizeof (void *));
+      nouv->nh_ent[ix] = nouvfils;
+      return nouv;
+    }
+  unsigned r = mi_hamt_rang (nh->nh_symboles, bit);
+  nouv = mi_hamt_allouer (nh->nh_symboles | bit, nh->nh_fils);
+  memcpy (nouv->nh_ent, nh->nh_ent, r * sizeof (void *));
+  nouv->nh_ent[r] = sy;
+  memcpy (nouv->nh_ent + r + 1, nh->nh_ent + r,
+          (nbent - r) * sizeof (void *));
+  return nouv;
+}				// fin mi_hamt_ajouter
+
+// le noeud sans sy, ou nh lui-même s'il ne le contient pas, ou NULL
+// s'il n'en reste rien
+static struct Mi_NoeudHamt_st *
+mi_hamt_oter (struct Mi_NoeudHamt_st *nh, const Mit_Symbole *sy,
+              unsigned niv)
+{
+  if (!nh)
+    return NULL;
+  uint32_t bit = 1u << mi_hamt_branche (sy->mi_ident, niv);
+  unsigned nbsy = __builtin_popcount (nh->nh_symboles);
+  unsigned nbent = mi_hamt_nbent (nh);
+  struct Mi_NoeudHamt_st *nouv = NULL;
+  if (nh->nh_symboles & bit)
+    {
+      unsigned r = mi_hamt_rang (nh->nh_symboles, bit);
+      if (nh->nh_ent[r] != sy)
+        return nh;
+      if (nbent == 1)
+        return NULL;
+      nouv = mi_hamt_allouer (nh->nh_symboles & ~bit, nh->nh_fils);
+      memcpy (nouv->nh_ent, nh->nh_ent, r * sizeof (void *));
+      memcpy (nouv->nh_ent + r, nh->nh_ent + r + 1,
+              (nbent - r - 1) * sizeof (void *));
+      return nouv;
+    }
+  if (nh->nh_fils & bit)
+    {
+      unsigned rf = mi_hamt_rang (nh->nh_fils, bit);
+      struct Mi_NoeudHamt_st *fils = nh->nh_ent[nbsy + rf];
+      struct Mi_NoeudHamt_st *nouvfils = mi_hamt_oter (fils, sy, niv + 1);
+      if (nouvfils == fils)
+        return nh;
+      assert (nouvfils != NULL);
+      if (nouvfils->nh_fils == 0
+          && __builtin_popcount (nouvfils->nh_symboles) == 1)
+        {
+          // le symbole restant remonte à la place du sous-noeud
+          unsigned r = mi_hamt_rang (nh->nh_symboles, bit);
+          nouv = mi_hamt_allouer (nh->nh_symboles | bit, nh->nh_fils & ~bit);
+          memcpy (nouv->nh_ent, nh->nh_ent, r * sizeof (void *));
+          nouv->nh_ent[r] = nouvfils->nh_ent[0];
+          memcpy (nouv->nh_ent + r + 1, nh->nh_ent + r,
+                  (nbsy - r + rf) * sizeof (void *));
+          memcpy (nouv->nh_ent + nbsy + 1 + rf, nh->nh_ent + nbsy + rf + 1,
+                  (nbent - nbsy - rf - 1) * sizeof (void *));
+          free (nouvfils);
+          return nouv;
+        }
+      nouv = mi_hamt_allouer (nh->nh_symboles, nh->nh_fils);
+      memcpy (nouv->nh_ent, nh->nh_ent, nbent * sizeof (void *));
+      nouv->nh_ent[nbsy + rf] = nouvfils;
+      return nouv;
+    }
+  return nh;
+}				// fin mi_hamt_oter
+
+static unsigned
+mi_hamt_collecter (const struct Mi_NoeudHamt_st *nh, Mit_Symbole **tab,
+                   unsigned n)
+{
+  if (!nh)
+    return n;
+  unsigned nbsy = __builtin_popcount (nh->nh_symboles);
+  unsigned nbent = mi_hamt_nbent (nh);
+  for (unsigned ix = 0; ix < nbsy; ix++)
+    tab[n++] = nh->nh_ent[ix];
+  for (unsigned ix = nbsy; ix < nbent; ix++)
+    n = mi_hamt_collecter (nh->nh_ent[ix], tab, n);
+  return n;
+}				// fin mi_hamt_collecter
+
+static bool
+mi_hamt_iterer (const struct Mi_NoeudHamt_st *nh, mi_itersymb_sigt * f,
+                void *client)
+{
+  if (!nh)
+    return false;
+  unsigned nbsy = __builtin_popcount (nh->nh_symboles);
+  unsigned nbent = mi_hamt_nbent (nh);
+  for (unsigned ix = 0; ix < nbsy; ix++)
+    if ((*f) (nh->nh_ent[ix], client))
+      return true;
+  for (unsigned ix = nbsy; ix < nbent; ix++)
+    if (mi_hamt_iterer (nh->nh_ent[ix], f, client))
+      return true;
+  return false;
+}				// fin mi_hamt_iterer
+
+static const Mit_EnsPersistant *
+mi_enspersistant_creer (struct Mi_NoeudHamt_st *racine, unsigned taille)
+{
+  if (!racine)
+    return &mi_enspvide;
+  Mit_EnsPersistant *ep =
+    mi_allouer_valeur (MiTy_EnsPersistant, sizeof (Mit_EnsPersistant));
+  ep->mi_racine = racine;
+  ep->mi_taille = taille;
+  return ep;
+}				// fin mi_enspersistant_creer
+
+const Mit_EnsPersistant *
+mi_enspersistant_vide (void)
+{
+  return &mi_enspvide;
+}				// fin mi_enspersistant_vide
+
+const Mit_EnsPersistant *
+mi_enspersistant_ajouter (const Mit_EnsPersistant *ep, const Mit_Symbole *sy)
+{
+  if (!ep || ep->mi_type != MiTy_EnsPersistant)
+    ep = &mi_enspvide;
+  if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole)
+    return ep;
+  struct Mi_NoeudHamt_st *racine =
+    mi_hamt_ajouter (ep->mi_racine, (Mit_Symbole *) sy, 0);
+  if (racine == ep->mi_racine)
+    return ep;
+  return mi_enspersistant_creer (racine, ep->mi_taille + 1);
+}				// fin mi_enspersistant_ajouter
+
+const Mit_EnsPersistant *
+mi_enspersistant_oter (const Mit_EnsPersistant *ep, const Mit_Symbole *sy)
+{
+  if (!ep || ep->mi_type != MiTy_EnsPersistant)
+    return &mi_enspvide;
+  if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole)
+    return ep;
+  struct Mi_NoeudHamt_st *racine = mi_hamt_oter (ep->mi_racine, sy, 0);
+  if (racine == ep->mi_racine)
+    return ep;
+  return mi_enspersistant_creer (racine, ep->mi_taille - 1);
+}				// fin mi_enspersistant_oter
+
+bool
+mi_enspersistant_contient (const Mit_EnsPersistant *ep, const Mit_Symbole *sy)
+{
+  if (!ep || ep->mi_type != MiTy_EnsPersistant)
+    return false;
+  if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole)
+    return false;
+  const struct Mi_NoeudHamt_st *nh = ep->mi_racine;
+  for (unsigned niv = 0; nh != NULL; niv++)
+    {
+      uint32_t bit = 1u << mi_hamt_branche (sy->mi_ident, niv);
+      if (nh->nh_symboles & bit)
+        return nh->nh_ent[mi_hamt_rang (nh->nh_symboles, bit)] == sy;
+      if (!(nh->nh_fils & bit))
+        return false;
+      nh = nh->nh_ent[__builtin_popcount (nh->nh_symboles)
+                      + mi_hamt_rang (nh->nh_fils, bit)];
+    }
+  return false;
+}				// fin mi_enspersistant_contient
+
+unsigned
+mi_enspersistant_cardinal (const Mit_EnsPersistant *ep)
+{
+  if (!ep || ep->mi_type != MiTy_EnsPersistant)
+    return 0;
+  return ep->mi_taille;
+}				// fin mi_enspersistant_cardinal
+
+const Mit_Ensemble *
+mi_enspersistant_ensemble (const Mit_EnsPersistant *ep)
+{
+  if (!ep || ep->mi_type != MiTy_EnsPersistant || ep->mi_taille == 0)
+    return mi_ensemble_vide ();
+  if (ep->mi_plat)
+    return ep->mi_plat;
+  unsigned ta = ep->mi_taille;
+  Mit_Symbole **tab = malloc (ta * sizeof (Mit_Symbole *));
+  if (!tab)
+    MI_FATALPRINTF ("impossible d'allouer %u symboles (%s)", ta,
+                    strerror (errno));
+  unsigned n = mi_hamt_collecter (ep->mi_racine, tab, 0);
+  assert (n == ta);
+  mi_trier_symboles (n, tab);
+  const Mit_Ensemble *en =
+    mi_creer_ensemble_symboles (n, (const Mit_Symbole **) tab);
+  free (tab);
+  ((Mit_EnsPersistant *) ep)->mi_plat = en;
+  return en;
+}				// fin mi_enspersistant_ensemble
+
+const Mit_EnsPersistant *
+mi_enspersistant_depuis_ensemble (const Mit_Ensemble *en)
+{
+  unsigned ta = mi_cardinal_ensemble (en);
+  if (ta == 0)
+    return &mi_enspvide;
+  Mit_Symbole *const *el = mi_ensemble_prendre_elements (en);
+  struct Mi_NoeudHamt_st *racine = NULL;
+  for (unsigned ix = 0; ix < ta; ix++)
+    racine = mi_hamt_ajouter (racine, el[ix], 0);
+  mi_ensemble_rendre_elements (en, el);
+  Mit_EnsPersistant *ep =
+    (Mit_EnsPersistant *) mi_enspersistant_creer (racine, ta);
+  ep->mi_plat = en;
+  return ep;
+}				// fin mi_enspersistant_depuis_ensemble
+
+unsigned
+mi_enspersistant_hash (const Mit_EnsPersistant *ep)
+{
+  if (!ep || ep->mi_type != MiTy_EnsPersistant)
+    return 0;
+  if (!ep->mi_hash)
+    ((Mit_EnsPersistant *) ep)->mi_hash =
+      mi_ensemble_hash (mi_enspersistant_ensemble (ep));
+  return ep->mi_hash;
+}				// fin mi_enspersistant_hash
+
+void
+mi_enspersistant_iterer (const Mit_EnsPersistant *ep, mi_itersymb_sigt * f,
+                         void *client)
+{
+  if (!ep || ep->mi_type != MiTy_EnsPersistant || !f)
+    return;
+  mi_hamt_iterer (ep->mi_racine, f, client);
+}				// fin mi_enspersistant_iterer
@@ -0,0 +1,567 @@
+// fichier miexprens.c - expressions paresseuses sur les ensembles
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file miexprens.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// Une expression d'ensembles est un arbre d'unions, d'intersections
+/// et de différences dont les feuilles sont des ensembles. Elle n'est
+/// calculée qu'à son évaluation: l'arbre est d'abord simplifié (les
+/// opérations de même sorte sont aplaties, les intersections rangées
+/// du plus petit au plus grand opérande et distribuées sur une union
+/// plus grande qu'elles), puis parcouru une seule fois. Chaque noeud
+/// est un curseur sur ses symboles dans l'ordre des clefs, qui sait
+/// avancer et sauter jusqu'à une clef; ainsi aucun ensemble
+/// intermédiaire n'est construit. Une feuille compacte (une carte de
+/// bits) qui n'est qu'un opérande de droite d'une intersection ou
+/// d'une différence n'est pas parcourue: elle sert de sonde, dont on
+/// teste l'appartenance du symbole courant des autres opérandes.
+#define MI_EXPRENS_NMAGIQ 0x1f4c8a27	/*524585511 */
+// nombre maximal d'opérandes d'une union sur laquelle distribuer
+#define MI_EXPRENS_MAXDISTRIB 8
+
+enum mi_opexpr_en
+{
+  MiExp_Feuille,
+  MiExp_Union,
+  MiExp_Inter,
+  MiExp_Diff			// le premier fils moins le second
+};
+
+struct Mi_ExprEns_st
+{
+  unsigned ex_nmagiq;		// toujours MI_EXPRENS_NMAGIQ
+  enum mi_opexpr_en ex_op;
+  unsigned ex_nbfils;
+  unsigned ex_taillefils;	// taille allouée de ex_fils
+  unsigned long ex_estim;	// borne supérieure du cardinal
+  struct Mi_ExprEns_st **ex_fils;
+  // pour une feuille
+  const Mit_Ensemble *ex_ens;
+  Mit_Symbole *const *ex_elem;	// pris à ex_ens, rendus à la fin
+  unsigned ex_pos;
+  bool ex_sonde;		// carte de bits seulement testée
+  // le symbole courant du parcours, ou NULL à la fin
+  Mit_Symbole *ex_courant;
+};
+
+static struct Mi_ExprEns_st *
+mi_exprens_allouer (enum mi_opexpr_en op)
+{
+  struct Mi_ExprEns_st *ex = calloc (1, sizeof (struct Mi_ExprEns_st));
+  if (!ex)
+    MI_FATALPRINTF ("impossible d'allouer une expression d'ensemble (%s)",
+                    strerror (errno));
+  ex->ex_nmagiq = MI_EXPRENS_NMAGIQ;
+  ex->ex_op = op;
+  return ex;
+}				// fin mi_exprens_allouer
+
+static void
+mi_exprens_ajouter_fils (struct Mi_ExprEns_st *ex, struct Mi_ExprEns_st *fi)
+{
+  if (ex->ex_nbfils >= ex->ex_taillefils)
+    {
+      unsigned nouvtail = 2 * ex->ex_taillefils + 3;
+      struct Mi_ExprEns_st **nouvfils =
+        realloc (ex->ex_fils, nouvtail * sizeof (struct Mi_ExprEns_st *));
+      if (!nouvfils)
+        MI_FATALPRINTF ("impossible d'agrandir une expression à %u fils (%s)",
+                        nouvtail, strerror (errno));
+      ex->ex_fils = nouvfils;
+      ex->ex_taillefils = nouvtail;
+    }
+  ex->ex_fils[ex->ex_nbfils++] = fi;
+}				// fin mi_exprens_ajouter_fils
+
+struct Mi_ExprEns_st *
+mi_exprens_ensemble (const Mit_Ensemble * en)
+{
+  struct Mi_ExprEns_st *ex = mi_exprens_allouer (MiExp_Feuille);
+  if (!en || en->mi_type != MiTy_Ensemble)
+    en = mi_ensemble_vide ();
+  ex->ex_ens = en;
+  ex->ex_estim = en->mi_taille;
+  return ex;
+}				// fin mi_exprens_ensemble
+
+void
+mi_exprens_detruire (struct Mi_ExprEns_st *ex)
+{
+  if (!ex || ex->ex_nmagiq != MI_EXPRENS_NMAGIQ)
+    return;
+  for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+    mi_exprens_detruire (ex->ex_fils[ix]);
+  free (ex->ex_fils);
+  mi_ensemble_rendre_elements (ex->ex_ens, ex->ex_elem);
+  memset (ex, 0, sizeof (*ex));
+  free (ex);
+}				// fin mi_exprens_detruire
+
+static struct Mi_ExprEns_st *
+mi_exprens_copier (const struct Mi_ExprEns_st *ex)
+{
+  struct Mi_ExprEns_st *cp = mi_exprens_allouer (ex->ex_op);
+  cp->ex_ens = ex->ex_ens;
+  cp->ex_estim = ex->ex_estim;
+  for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+    mi_exprens_ajouter_fils (cp, mi_exprens_copier (ex->ex_fils[ix]));
+  return cp;
+}				// fin mi_exprens_copier
+
+// une opération associative, dont les opérandes de même opération
+// sont aplatis; les opérandes appartiennent ensuite au résultat
+static struct Mi_ExprEns_st *
+mi_exprens_associative (enum mi_opexpr_en op, struct Mi_ExprEns_st *e1,
+                        struct Mi_ExprEns_st *e2)
+{
+  struct Mi_ExprEns_st *ex = mi_exprens_allouer (op);
+  struct Mi_ExprEns_st *tab[2] = { e1, e2 };
+  for (unsigned i = 0; i < 2; i++)
+    {
+      struct Mi_ExprEns_st *e = tab[i];
+      if (!e || e->ex_nmagiq != MI_EXPRENS_NMAGIQ)
+        e = mi_exprens_ensemble (NULL);
+      if (e->ex_op == op)
+        {
+          for (unsigned ix = 0; ix < e->ex_nbfils; ix++)
+            mi_exprens_ajouter_fils (ex, e->ex_fils[ix]);
+          e->ex_nbfils = 0;
+          mi_exprens_detruire (e);
+        }
+      else
+        mi_exprens_ajouter_fils (ex, e);
+    }
+  return ex;
+}				// fin mi_exprens_associative
+
+struct Mi_ExprEns_st *
+mi_exprens_union (struct Mi_ExprEns_st *e1, struct Mi_ExprEns_st *e2)
+{
+  return mi_exprens_associative (MiExp_Union, e1, e2);
+}				// fin mi_exprens_union
+
+struct Mi_ExprEns_st *
+mi_exprens_intersection (struct Mi_ExprEns_st *e1, struct Mi_ExprEns_st *e2)
+{
+  return mi_exprens_associative (MiExp_Inter, e1, e2);
+}				// fin mi_exprens_intersection
+
+struct Mi_ExprEns_st *
+mi_exprens_difference (struct Mi_ExprEns_st *e1, struct Mi_ExprEns_st *e2)
+{
+  if (!e1 || e1->ex_nmagiq != MI_EXPRENS_NMAGIQ)
+    e1 = mi_exprens_ensemble (NULL);
+  if (!e2 || e2->ex_nmagiq != MI_EXPRENS_NMAGIQ)
+    e2 = mi_exprens_ensemble (NULL);
+  // (a - b) - c est a - (b u c)
+  if (e1->ex_op == MiExp_Diff)
+    {
+      e1->ex_fils[1] = mi_exprens_union (e1->ex_fils[1], e2);
+      return e1;
+    }
+  struct Mi_ExprEns_st *ex = mi_exprens_allouer (MiExp_Diff);
+  mi_exprens_ajouter_fils (ex, e1);
+  mi_exprens_ajouter_fils (ex, e2);
+  return ex;
+}				// fin mi_exprens_difference
+
+static int
+mi_cmp_estim_exprens (const void *p1, const void *p2)
+{
+  const struct Mi_ExprEns_st *e1 = *(const struct Mi_ExprEns_st **) p1;
+  const struct Mi_ExprEns_st *e2 = *(const struct Mi_ExprEns_st **) p2;
+  return (e1->ex_estim > e2->ex_estim) - (e1->ex_estim < e2->ex_estim);
+}				// fin mi_cmp_estim_exprens
+
+// remplace une expression vide par une feuille vide
+static struct Mi_ExprEns_st *
+mi_exprens_vide (struct Mi_ExprEns_st *ex)
+{
+  mi_exprens_detruire (ex);
+  return mi_exprens_ensemble (NULL);
+}				// fin mi_exprens_vide
+
+// une feuille compacte, sans tableau d'éléments ordonnés
+static inline bool
+mi_exprens_feuille_compacte (const struct Mi_ExprEns_st *ex)
+{
+  return ex->ex_op == MiExp_Feuille && ex->ex_ens->mi_compact;
+}				// fin mi_exprens_feuille_compacte
+
+// simplifie l'expression, qui peut être remplacée, et calcule les
+// estimations de cardinal
+static struct Mi_ExprEns_st *
+mi_exprens_optimiser (struct Mi_ExprEns_st *ex)
+{
+  assert (ex && ex->ex_nmagiq == MI_EXPRENS_NMAGIQ);
+  if (ex->ex_op == MiExp_Feuille)
+    return ex;
+  for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+    ex->ex_fils[ix] = mi_exprens_optimiser (ex->ex_fils[ix]);
+  switch (ex->ex_op)
+    {
+    case MiExp_Union:
+    {
+      // ôter les opérandes vides, aplatir les unions apparues
+      unsigned long estim = 0;
+      struct Mi_ExprEns_st **fils = ex->ex_fils;
+      unsigned nbfils = ex->ex_nbfils;
+      ex->ex_fils = NULL;
+      ex->ex_nbfils = ex->ex_taillefils = 0;
+      for (unsigned ix = 0; ix < nbfils; ix++)
+        {
+          struct Mi_ExprEns_st *fi = fils[ix];
+          if (fi->ex_estim == 0)
+            mi_exprens_detruire (fi);
+          else if (fi->ex_op == MiExp_Union)
+            {
+              for (unsigned j = 0; j < fi->ex_nbfils; j++)
+                mi_exprens_ajouter_fils (ex, fi->ex_fils[j]);
+              estim += fi->ex_estim;
+              fi->ex_nbfils = 0;
+              mi_exprens_detruire (fi);
+            }
+          else
+            {
+              fi->ex_sonde = false;
+              mi_exprens_ajouter_fils (ex, fi);
+              estim += fi->ex_estim;
+            }
+        }
+      free (fils);
+      if (ex->ex_nbfils == 0)
+        return mi_exprens_vide (ex);
+      if (ex->ex_nbfils == 1)
+        {
+          struct Mi_ExprEns_st *fi = ex->ex_fils[0];
+          ex->ex_nbfils = 0;
+          mi_exprens_detruire (ex);
+          return fi;
+        }
+      ex->ex_estim = estim;
+      return ex;
+    }
+    case MiExp_Inter:
+    {
+      for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+        if (ex->ex_fils[ix]->ex_estim == 0)
+          return mi_exprens_vide (ex);
+      qsort (ex->ex_fils, ex->ex_nbfils, sizeof (struct Mi_ExprEns_st *),
+             mi_cmp_estim_exprens);
+      ex->ex_estim = ex->ex_fils[0]->ex_estim;
+      if (ex->ex_nbfils == 1)
+        {
+          struct Mi_ExprEns_st *fi = ex->ex_fils[0];
+          ex->ex_nbfils = 0;
+          mi_exprens_detruire (ex);
+          return fi;
+        }
+      for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+        ex->ex_fils[ix]->ex_sonde =
+          ix > 0 && mi_exprens_feuille_compacte (ex->ex_fils[ix]);
+      // (u1 u u2 ...) n r devient (u1 n r) u (u2 n r) ... quand r
+      // est plus petit que l'union, qui est alors la seule
+      int rgun = -1;
+      for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+        if (ex->ex_fils[ix]->ex_op == MiExp_Union)
+          {
+            if (rgun >= 0)
+              return ex;
+            rgun = ix;
+          }
+      if (rgun <= 0
+          || ex->ex_fils[rgun]->ex_nbfils > MI_EXPRENS_MAXDISTRIB)
+        return ex;
+      struct Mi_ExprEns_st *un = ex->ex_fils[rgun];
+      struct Mi_ExprEns_st *res = mi_exprens_allouer (MiExp_Union);
+      for (unsigned iu = 0; iu < un->ex_nbfils; iu++)
+        {
+          struct Mi_ExprEns_st *in = mi_exprens_allouer (MiExp_Inter);
+          mi_exprens_ajouter_fils (in, un->ex_fils[iu]);
+          for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+            if ((int) ix != rgun)
+              mi_exprens_ajouter_fils (in, mi_exprens_copier (ex->ex_fils[ix]));
+          mi_exprens_ajouter_fils (res, in);
+        }
+      un->ex_nbfils = 0;
+      mi_exprens_detruire (ex);
+      return mi_exprens_optimiser (res);
+    }
+    case MiExp_Diff:
+    {
+      struct Mi_ExprEns_st *a = ex->ex_fils[0], *b = ex->ex_fils[1];
+      if (a->ex_estim == 0)
+        return mi_exprens_vide (ex);
+      ex->ex_estim = a->ex_estim;
+      if (b->ex_estim == 0)
+        {
+          ex->ex_nbfils = 0;
+          mi_exprens_detruire (b);
+          mi_exprens_detruire (ex);
+          return a;
+        }
+      a->ex_sonde = false;
+      b->ex_sonde = mi_exprens_feuille_compacte (b);
+      return ex;
+    }
+    case MiExp_Feuille:
+      break;
+    }
+  return ex;
+}				// fin mi_exprens_optimiser
+
+/// le parcours, dans l'ordre des clefs
+static void mi_exprens_chercher (struct Mi_ExprEns_st *ex, uint64_t cle);
+static void mi_exprens_avancer (struct Mi_ExprEns_st *ex);
+
+static inline uint64_t
+mi_exprens_cle (const struct Mi_ExprEns_st *ex)
+{
+  return mi_cle_symbole (ex->ex_courant);
+}				// fin mi_exprens_cle
+
+// le plus petit symbole courant des opérandes d'une union
+static void
+mi_exprens_union_minimum (struct Mi_ExprEns_st *ex)
+{
+  Mit_Symbole *min = NULL;
+  uint64_t clemin = 0;
+  for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+    {
+      Mit_Symbole *sy = ex->ex_fils[ix]->ex_courant;
+      if (sy && (!min || mi_cle_symbole (sy) < clemin))
+        min = sy, clemin = mi_cle_symbole (sy);
+    }
+  ex->ex_courant = min;
+}				// fin mi_exprens_union_minimum
+
+// aligner les opérandes d'une intersection sur un symbole commun, en
+// sautant de l'un à l'autre à la plus grande clef courante
+static void
+mi_exprens_inter_aligner (struct Mi_ExprEns_st *ex)
+{
+  unsigned nb = ex->ex_nbfils;
+  for (;;)
+    {
+      struct Mi_ExprEns_st *pr = ex->ex_fils[0];
+      if (!pr->ex_courant)
+        break;
+      uint64_t clemax = mi_exprens_cle (pr);
+      bool egaux = true;
+      for (unsigned ix = 1; ix < nb; ix++)
+        {
+          struct Mi_ExprEns_st *fi = ex->ex_fils[ix];
+          if (fi->ex_sonde)
+            continue;
+          mi_exprens_chercher (fi, clemax);
+          if (!fi->ex_courant)
+            {
+              ex->ex_courant = NULL;
+              return;
+            }
+          uint64_t c = mi_exprens_cle (fi);
+          if (c != clemax)
+            {
+              egaux = false;
+              clemax = c;
+            }
+        }
+      if (egaux)
+        {
+          // le symbole commun doit encore être dans chaque sonde
+          Mit_Symbole *sy = pr->ex_courant;
+          unsigned ix = 1;
+          while (ix < nb && (!ex->ex_fils[ix]->ex_sonde
+                             || mi_cartebits_contient
+                             (ex->ex_fils[ix]->ex_ens->mi_compact,
+                              sy->mi_ident)))
+            ix++;
+          if (ix == nb)
+            {
+              ex->ex_courant = sy;
+              return;
+            }
+          mi_exprens_avancer (pr);
+          continue;
+        }
+      mi_exprens_chercher (pr, clemax);
+    }
+  ex->ex_courant = NULL;
+}				// fin mi_exprens_inter_aligner
+
+// le premier symbole du premier opérande d'une différence absent du second
+static void
+mi_exprens_diff_aligner (struct Mi_ExprEns_st *ex)
+{
+  struct Mi_ExprEns_st *a = ex->ex_fils[0], *b = ex->ex_fils[1];
+  while (a->ex_courant)
+    {
+      if (b->ex_sonde)
+        {
+          if (!mi_cartebits_contient (b->ex_ens->mi_compact,
+                                      a->ex_courant->mi_ident))
+            break;
+          mi_exprens_avancer (a);
+          continue;
+        }
+      mi_exprens_chercher (b, mi_exprens_cle (a));
+      if (b->ex_courant != a->ex_courant)
+        break;
+      mi_exprens_avancer (a);
+    }
+  ex->ex_courant = a->ex_courant;
+}				// fin mi_exprens_diff_aligner
+
+static void
+mi_exprens_demarrer (struct Mi_ExprEns_st *ex)
+{
+  for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+    mi_exprens_demarrer (ex->ex_fils[ix]);
+  switch (ex->ex_op)
+    {
+    case MiExp_Feuille:
+      ex->ex_pos = 0;
+      ex->ex_courant = NULL;
+      if (ex->ex_sonde)
+        break;
+      // les éléments d'une feuille compacte sont ordonnés pour ce
+      // seul parcours
+      if (!ex->ex_elem)
+        ex->ex_elem = mi_ensemble_prendre_elements (ex->ex_ens);
+      if (ex->ex_ens->mi_taille > 0)
+        ex->ex_courant = ex->ex_elem[0];
+      break;
+    case MiExp_Union:
+      mi_exprens_union_minimum (ex);
+      break;
+    case MiExp_Inter:
+      mi_exprens_inter_aligner (ex);
+      break;
+    case MiExp_Diff:
+      mi_exprens_diff_aligner (ex);
+      break;
+    }
+}				// fin mi_exprens_demarrer
+
+static void
+mi_exprens_avancer (struct Mi_ExprEns_st *ex)
+{
+  if (!ex->ex_courant)
+    return;
+  switch (ex->ex_op)
+    {
+    case MiExp_Feuille:
+    {
+      unsigned p = ++ex->ex_pos;
+      ex->ex_courant = p < ex->ex_ens->mi_taille ? ex->ex_elem[p] : NULL;
+    }
+    break;
+    case MiExp_Union:
+    {
+      Mit_Symbole *sy = ex->ex_courant;
+      for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+        if (ex->ex_fils[ix]->ex_courant == sy)
+          mi_exprens_avancer (ex->ex_fils[ix]);
+      mi_exprens_union_minimum (ex);
+    }
+    break;
+    case MiExp_Inter:
+      mi_exprens_avancer (ex->ex_fils[0]);
+      mi_exprens_inter_aligner (ex);
+      break;
+    case MiExp_Diff:
+      mi_exprens_avancer (ex->ex_fils[0]);
+      mi_exprens_diff_aligner (ex);
+      break;
+    }
+}				// fin mi_exprens_avancer
+
+// aller au premier symbole de clef au moins cle
+static void
+mi_exprens_chercher (struct Mi_ExprEns_st *ex, uint64_t cle)
+{
+  if (!ex->ex_courant || mi_exprens_cle (ex) >= cle)
+    return;
+  switch (ex->ex_op)
+    {
+    case MiExp_Feuille:
+    {
+      // recherche exponentielle puis dichotomique
+      Mit_Symbole *const *el = ex->ex_elem;
+      unsigned fin = ex->ex_ens->mi_taille;
+      unsigned bas = ex->ex_pos, pas = 1;
+      while (bas + pas < fin && mi_cle_symbole (el[bas + pas]) < cle)
+        bas += pas, pas *= 2;
+      unsigned haut = (bas + pas < fin) ? bas + pas : fin;
+      // el[bas] < cle <= el[haut] s'il existe
+      while (haut - bas > 1)
+        {
+          unsigned mil = bas + (haut - bas) / 2;
+          if (mi_cle_symbole (el[mil]) < cle)
+            bas = mil;
+          else
+            haut = mil;
+        }
+      ex->ex_pos = haut;
+      ex->ex_courant = haut < fin ? el[haut] : NULL;
+    }
+    break;
+    case MiExp_Union:
+      for (unsigned ix = 0; ix < ex->ex_nbfils; ix++)
+        mi_exprens_chercher (ex->ex_fils[ix], cle);
+      mi_exprens_union_minimum (ex);
+      break;
+    case MiExp_Inter:
+      mi_exprens_chercher (ex->ex_fils[0], cle);
+      mi_exprens_inter_aligner (ex);
+      break;
+    case MiExp_Diff:
+      mi_exprens_chercher (ex->ex_fils[0], cle);
+      mi_exprens_diff_aligner (ex);
+      break;
+    }
+}				// fin mi_exprens_chercher
+
+const Mit_Ensemble *
+mi_exprens_evaluer (struct Mi_ExprEns_st *ex)
+{
+  if (!ex || ex->ex_nmagiq != MI_EXPRENS_NMAGIQ)
+    return NULL;
+  ex = mi_exprens_optimiser (ex);
+  if (ex->ex_op == MiExp_Feuille)
+    {
+      const Mit_Ensemble *en = ex->ex_ens;
+      mi_exprens_detruire (ex);
+      return en;
+    }
+  if (ex->ex_estim > INT_MAX / 2)
+    MI_FATALPRINTF ("trop d'elements %lu dans une expression d'ensembles",
+                    ex->ex_estim);
+  // les symboles parcourus sont ordonnés, donc mis directement dans
+  // l'ensemble résultat, rétréci ensuite
+  unsigned ta = ex->ex_estim;
+  Mit_Ensemble *enr = mi_allouer_ensemble (ta);
+  unsigned nb = 0;
+  for (mi_exprens_demarrer (ex); ex->ex_courant; mi_exprens_avancer (ex))
+    {
+      assert (nb < ta);
+      enr->mi_tabelem[nb++] = ex->ex_courant;
+    }
+  mi_exprens_detruire (ex);
+  return mi_finir_ensemble (enr, ta, nb);
+}				// fin mi_exprens_evaluer
@@ -0,0 +1,433 @@
+// fichier miimpr.c - impression des valeurs dans un tampon mémoire
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file miimpr.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// la longueur maximale des affichages, 0 si illimitée
+size_t mi_affichage_max;
+
+/// l'imprimeur partagé par les fonctions d'affichage, réutilisé d'un
+/// affichage à l'autre pour ne pas réallouer son tampon
+static struct Mi_Imprimeur_st mi_imprimeur_affichage;
+
+static const char mi_deux_chiffres[201] =
+  "00010203040506070809" "10111213141516171819"
+  "20212223242526272829" "30313233343536373839"
+  "40414243444546474849" "50515253545556575859"
+  "60616263646566676869" "70717273747576777879"
+  "80818283848586878889" "90919293949596979899";
+
+int
+mi_naturel_en_chaine (char *tamp, unsigned long n)
+{
+  char chif[MI_TAILLE_TAMPON_ENTIER];
+  char *pc = chif + sizeof (chif);
+  // deux chiffres à la fois, du poids faible au poids fort
+  while (n >= 100)
+    {
+      unsigned r = (unsigned) (n % 100);
+      n /= 100;
+      pc -= 2;
+      memcpy (pc, mi_deux_chiffres + 2 * r, 2);
+    }
+  if (n >= 10)
+    {
+      pc -= 2;
+      memcpy (pc, mi_deux_chiffres + 2 * n, 2);
+    }
+  else
+    *(--pc) = (char) ('0' + n);
+  int lg = (int) (chif + sizeof (chif) - pc);
+  memcpy (tamp, pc, lg);
+  tamp[lg] = (char) 0;
+  return lg;
+}				// fin mi_naturel_en_chaine
+
+int
+mi_entier_en_chaine (char *tamp, long l)
+{
+  if (l >= 0)
+    return mi_naturel_en_chaine (tamp, (unsigned long) l);
+  tamp[0] = '-';
+  // sans débordement pour LONG_MIN
+  return 1 + mi_naturel_en_chaine (tamp + 1, -(unsigned long) l);
+}				// fin mi_entier_en_chaine
+
+void
+mi_imprimeur_initialiser (struct Mi_Imprimeur_st *im, size_t max)
+{
+  assert (im != NULL);
+  memset (im, 0, sizeof (*im));
+  im->imp_nmagiq = MI_IMPRIMEUR_NMAGIQ;
+  im->imp_max = max;
+  mi_imprimeur_agrandir (im, 200);
+}				// fin mi_imprimeur_initialiser
+
+void
+mi_imprimeur_detruire (struct Mi_Imprimeur_st *im)
+{
+  if (!im)
+    return;
+  assert (im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  free (im->imp_octets);
+  memset (im, 0, sizeof (*im));
+}				// fin mi_imprimeur_detruire
+
+void
+mi_imprimeur_agrandir (struct Mi_Imprimeur_st *im, size_t nb)
+{
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  if (im->imp_long + nb + 1 <= im->imp_taille)
+    return;
+  size_t nouvtail = 4 * (im->imp_long + nb) / 3 + 64;
+  // arrondi à 256 octets, car malloc aime les tailles rondes
+  nouvtail = (nouvtail | 0xff) + 1;
+  char *nouvoct = realloc (im->imp_octets, nouvtail);
+  if (!nouvoct)
+    MI_FATALPRINTF ("impossible d'agrandir l'imprimeur à %zd octets (%s)",
+                    nouvtail, strerror (errno));
+  im->imp_octets = nouvoct;
+  im->imp_taille = nouvtail;
+  im->imp_octets[im->imp_long] = (char) 0;
+}				// fin mi_imprimeur_agrandir
+
+void
+mi_imprimeur_octets (struct Mi_Imprimeur_st *im, const char *oct, size_t nb)
+{
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  if (im->imp_max > 0 && im->imp_long + nb > im->imp_max)
+    {
+      nb = (im->imp_max > im->imp_long) ? im->imp_max - im->imp_long : 0;
+      // ne pas couper un caractère UTF-8 en son milieu
+      while (nb > 0 && (oct[nb] & 0xc0) == 0x80)
+        nb--;
+      im->imp_tronque = true;
+      if (nb == 0)
+        return;
+    }
+  if (im->imp_long + nb + 1 > im->imp_taille)
+    mi_imprimeur_agrandir (im, nb);
+  memcpy (im->imp_octets + im->imp_long, oct, nb);
+  im->imp_long += nb;
+  im->imp_octets[im->imp_long] = (char) 0;
+}				// fin mi_imprimeur_octets
+
+void
+mi_imprimeur_printf (struct Mi_Imprimeur_st *im, const char *fmt, ...)
+{
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  va_list args;
+  size_t place = im->imp_taille - im->imp_long;
+  va_start (args, fmt);
+  int ln = vsnprintf (im->imp_octets + im->imp_long, place, fmt, args);
+  va_end (args);
+  if (ln < 0)
+    MI_FATALPRINTF ("format %s incorrect", fmt);
+  if ((size_t) ln >= place)
+    {
+      mi_imprimeur_agrandir (im, ln);
+      va_start (args, fmt);
+      vsnprintf (im->imp_octets + im->imp_long, ln + 1, fmt, args);
+      va_end (args);
+    }
+  // la troncature éventuelle se fait comme pour les octets
+  size_t deb = im->imp_long;
+  if (im->imp_max > 0 && deb + ln > im->imp_max)
+    {
+      size_t nb = (im->imp_max > deb) ? im->imp_max - deb : 0;
+      while (nb > 0 && (im->imp_octets[deb + nb] & 0xc0) == 0x80)
+        nb--;
+      im->imp_tronque = true;
+      ln = (int) nb;
+    }
+  im->imp_long = deb + ln;
+  im->imp_octets[im->imp_long] = (char) 0;
+}				// fin mi_imprimeur_printf
+
+void
+mi_imprimeur_entier (struct Mi_Imprimeur_st *im, long l)
+{
+  char tamp[MI_TAILLE_TAMPON_ENTIER];
+  int lg = mi_entier_en_chaine (tamp, l);
+  mi_imprimeur_octets (im, tamp, lg);
+}				// fin mi_imprimeur_entier
+
+void
+mi_imprimeur_symbole (struct Mi_Imprimeur_st *im, const Mit_Symbole *sy)
+{
+  assert (sy && sy != MI_TROU_SYMBOLE && sy->mi_type == MiTy_Symbole);
+  const Mit_Chaine *nom = mi_symbole_nom (sy);
+  assert (nom != NULL);
+  mi_imprimeur_octets (im, nom->mi_car, nom->mi_taille);
+  if (sy->mi_indice)
+    {
+      char tamp[MI_TAILLE_TAMPON_ENTIER + 1];
+      tamp[0] = '_';
+      int lg = mi_naturel_en_chaine (tamp + 1, sy->mi_indice);
+      mi_imprimeur_octets (im, tamp, lg + 1);
+    }
+}				// fin mi_imprimeur_symbole
+
+void
+mi_imprimeur_chaine_encodee (struct Mi_Imprimeur_st *im, const char *ch)
+{
+  if (!ch)
+    return;
+  size_t ln = strlen (ch);
+  if (u8_check ((const uint8_t *) ch, ln))
+    MI_FATALPRINTF ("chaine %.50s... incorrecte", ch);
+  size_t off = 0;
+  while (off < ln)
+    {
+      // recopier d'un coup les octets qui n'ont pas besoin d'encodage
+      size_t deb = off;
+      while (off < ln)
+        {
+          unsigned char c = (unsigned char) ch[off];
+          if (c >= 128 || c == '\'' || c == '\"' || c == '\\' || !isprint (c))
+            break;
+          off++;
+        }
+      if (off > deb)
+        mi_imprimeur_octets (im, ch + deb, off - deb);
+      if (off >= ln)
+        break;
+      ucs4_t uc = 0;
+      int lc = u8_mbtouc_unsafe (&uc, (const uint8_t *) (ch + off), ln - off);
+      if (lc <= 0)
+        break;
+      if (uc < 128)
+        {
+          switch ((char) uc)
+            {
+            case '\'':
+            case '\"':
+            case '\\':
+              mi_imprimeur_car (im, '\\');
+              mi_imprimeur_car (im, (char) uc);
+              break;
+            case '\a':
+              mi_imprimeur_chaine (im, "\\a");
+              break;
+            case '\b':
+              mi_imprimeur_chaine (im, "\\b");
+              break;
+            case '\f':
+              mi_imprimeur_chaine (im, "\\f");
+              break;
+            case '\n':
+              mi_imprimeur_chaine (im, "\\n");
+              break;
+            case '\r':
+              mi_imprimeur_chaine (im, "\\r");
+              break;
+            case '\t':
+              mi_imprimeur_chaine (im, "\\t");
+              break;
+            case '\v':
+              mi_imprimeur_chaine (im, "\\v");
+              break;
+            case '\033' /* ESCAPE */ :
+              mi_imprimeur_chaine (im, "\\e");
+              break;
+            default:
+              mi_imprimeur_printf (im, "\\x%02x", uc);
+              break;
+            }
+        }
+      else if (uc < 0xffff)
+        mi_imprimeur_printf (im, "\\u%04x", (unsigned) uc);
+      else
+        mi_imprimeur_printf (im, "\\U%08x", (unsigned) uc);
+      off += lc;
+    }
+}				/* fin mi_imprimeur_chaine_encodee */
+
+// imprimer une suite de symboles, avec une espace toutes les cinq virgules
+static void
+mi_imprimeur_suite_symboles (struct Mi_Imprimeur_st *im, unsigned prem,
+                             unsigned nb, Mit_Symbole *const *tab)
+{
+  // prem est le rang du premier, pour continuer une suite découpée
+  for (unsigned ix = 0; ix < nb; ix++)
+    {
+      if (ix + prem > 0)
+        {
+          if ((ix + prem) % 5 == 0)
+            mi_imprimeur_octets (im, ", ", 2);
+          else
+            mi_imprimeur_car (im, ',');
+        }
+      mi_imprimeur_symbole (im, tab[ix]);
+      // inutile de continuer une fois la longueur maximale atteinte
+      if (im->imp_tronque)
+        break;
+    };
+}				// fin mi_imprimeur_suite_symboles
+
+void
+mi_imprimeur_valeur (struct Mi_Imprimeur_st *im, const Mit_Val v)
+{
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  enum mi_typeval_en ty = mi_vtype (v);
+  switch (ty)
+    {
+    case MiTy_Nil:
+      mi_imprimeur_car (im, '~');
+      break;
+    case MiTy_Entier:
+      mi_imprimeur_entier (im, mi_vald_entier (v, 0));
+      break;
+    case MiTy_Double:
+    {
+      char tamp[MI_TAILLE_TAMPON_DOUBLE];
+      int lg = mi_double_en_chaine (tamp, mi_vald_double (v, NAN));
+      mi_imprimeur_octets (im, tamp, lg);
+    }
+    break;
+    case MiTy_Chaine:
+    {
+      mi_imprimeur_car (im, '"');
+      mi_imprimeur_chaine_encodee (im, mi_vald_chaine (v, NULL));
+      mi_imprimeur_car (im, '"');
+    }
+    break;
+    case MiTy_Symbole:
+      mi_imprimeur_symbole (im, mi_en_symbole (v));
+      break;
+    case MiTy_Tuple:
+    {
+      const Mit_Tuple *tup = mi_en_tuple (v);
+      mi_imprimeur_car (im, '[');
+      mi_imprimeur_suite_symboles (im, 0, tup->mi_taille,
+                                   tup->mi_composants);
+      mi_imprimeur_car (im, ']');
+    }
+    break;
+    case MiTy_VueTuple:
+    {
+      const Mit_VueTuple *vt = mi_en_vuetuple (v);
+      unsigned prem = 0;
+      mi_imprimeur_car (im, '[');
+      for (unsigned is = 0; is < vt->mi_nbseg && !im->imp_tronque; is++)
+        {
+          const struct Mi_SegmentTuple_st *sg = vt->mi_seg + is;
+          mi_imprimeur_suite_symboles (im, prem, sg->seg_long,
+                                       sg->seg_tuple->mi_composants +
+                                       sg->seg_debut);
+          prem += sg->seg_long;
+        }
+      mi_imprimeur_car (im, ']');
+    }
+    break;
+    case MiTy_Ensemble:
+    case MiTy_EnsPersistant:	// imprimé comme sa forme ordinaire
+    {
+      const Mit_Ensemble *ens = mi_en_ensemble_plat (v);
+      Mit_Symbole *const *el = mi_ensemble_prendre_elements (ens);
+      mi_imprimeur_car (im, '{');
+      mi_imprimeur_suite_symboles (im, 0, ens->mi_taille, el);
+      mi_imprimeur_car (im, '}');
+      mi_ensemble_rendre_elements (ens, el);
+    }
+    break;
+    case MiTy_TabEntiers:
+    {
+      const Mit_TabEntiers *te = v.miva_tabent;
+      mi_imprimeur_octets (im, "#[", 2);
+      for (unsigned ix = 0; ix < te->mi_taille && !im->imp_tronque; ix++)
+        {
+          if (ix > 0)
+            mi_imprimeur_car (im, ',');
+          mi_imprimeur_entier (im, te->mi_tabent[ix]);
+        }
+      mi_imprimeur_car (im, ']');
+    }
+    break;
+    case MiTy_TabDoubles:
+    {
+      const Mit_TabDoubles *td = v.miva_tabdbl;
+      char tamp[MI_TAILLE_TAMPON_DOUBLE];
+      mi_imprimeur_octets (im, "#.[", 3);
+      for (unsigned ix = 0; ix < td->mi_taille && !im->imp_tronque; ix++)
+        {
+          if (ix > 0)
+            mi_imprimeur_car (im, ',');
+          int lg = mi_double_en_chaine (tamp, td->mi_tabdbl[ix]);
+          mi_imprimeur_octets (im, tamp, lg);
+        }
+      mi_imprimeur_car (im, ']');
+    }
+    break;
+    case MiTy__Dernier:
+      MI_FATALPRINTF ("valeur impossible @%p", v.miva_ptr);
+    }
+}				// fin mi_imprimeur_valeur
+
+void
+mi_imprimeur_ecrire (struct Mi_Imprimeur_st *im, FILE * fi)
+{
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  if (fi && im->imp_long > 0)
+    fwrite (im->imp_octets, 1, im->imp_long, fi);
+  if (fi && im->imp_tronque)
+    fputs ("...\n", fi);
+  mi_imprimeur_vider (im);
+}				// fin mi_imprimeur_ecrire
+
+const Mit_Chaine *
+mi_imprimeur_en_chaine (struct Mi_Imprimeur_st *im)
+{
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  const Mit_Chaine *ch = mi_creer_chaine (im->imp_octets);
+  mi_imprimeur_vider (im);
+  return ch;
+}				// fin mi_imprimeur_en_chaine
+
+struct Mi_Imprimeur_st *
+mi_imprimeur_commun (void)
+{
+  struct Mi_Imprimeur_st *im = &mi_imprimeur_affichage;
+  if (im->imp_nmagiq != MI_IMPRIMEUR_NMAGIQ)
+    mi_imprimeur_initialiser (im, mi_affichage_max);
+  else
+    mi_imprimeur_vider (im);
+  im->imp_max = mi_affichage_max;
+  return im;
+}				// fin mi_imprimeur_commun
+
+void
+mi_afficher_chaine_encodee (FILE * fi, const char *ch)
+{
+  if (!fi || !ch)
+    return;
+  struct Mi_Imprimeur_st *im = mi_imprimeur_commun ();
+  mi_imprimeur_chaine_encodee (im, ch);
+  mi_imprimeur_ecrire (im, fi);
+}				/* fin mi_afficher_chaine_encodee */
+
+void
+mi_afficher_valeur (FILE * fi, const Mit_Val v)
+{
+  if (!fi)
+    return;
+  struct Mi_Imprimeur_st *im = mi_imprimeur_commun ();
+  mi_imprimeur_valeur (im, v);
+  mi_imprimeur_car (im, '\n');
+  mi_imprimeur_ecrire (im, fi);
+}				// fin mi_afficher_valeur
@@ -43,6 +43,33 @@ mi_sauvegarde_symbole_connu (struct Mi_Sauvegarde_st * sv,
   return mi_enshash_contient (&sv->sv_syconnu, sy);
 }
 
+// JSON n'a ni NaN ni infinis, et json_real les refuse; dans un
+// tableau de doubles, ils sont écrits comme par mi_double_en_chaine
+static json_t *
+mi_json_element_double (double d)
+{
+  if (isnan (d))
+    return json_string ("+NAN");
+  if (isinf (d))
+    return json_string ((d > 0.0) ? "+INF" : "-INF");
+  return json_real (d);
+}				// fin mi_json_element_double
+
+static double
+mi_element_double_json (const json_t *j, unsigned ix)
+{
+  if (json_is_number (j))
+    return json_number_value (j);
+  const char *ch = json_is_string (j) ? json_string_value (j) : NULL;
+  if (ch && !strcmp (ch, "+NAN"))
+    return NAN;
+  if (ch && !strcmp (ch, "+INF"))
+    return INFINITY;
+  if (ch && !strcmp (ch, "-INF"))
+    return -INFINITY;
+  MI_FATALPRINTF ("élément #%u d'un tableau de doubles incorrect", ix);
+}				// fin mi_element_double_json
+
 //// sérialisation d'une valeur en JSON
 json_t *
 mi_json_val (struct Mi_Sauvegarde_st *sv, const Mit_Val v)
@@ -56,7 +83,15 @@ mi_json_val (struct Mi_Sauvegarde_st *sv, const Mit_Val v)
     case MiTy_Entier:
       return json_integer (mi_vald_entier (v, 0));
     case MiTy_Double:
-      return json_real (mi_vald_double (v, 0.0));
+    {
+      // on retient le nombre de chiffres nécessaires, pour écrire le
+      // JSON avec la même précision que mi_double_en_chaine
+      double d = mi_vald_double (v, 0.0);
+      int nc = mi_double_chiffres (d);
+      if (nc > sv->sv_chiffdbl)
+        sv->sv_chiffdbl = nc;
+      return json_real (d);
+    }
     case MiTy_Chaine:
       return json_string (mi_vald_chaine (v, ""));
     case MiTy_Symbole:
@@ -75,30 +110,33 @@ mi_json_val (struct Mi_Sauvegarde_st *sv, const Mit_Val v)
     }
     break;
     case MiTy_Ensemble:
+    case MiTy_EnsPersistant:	// sauvegardé comme un ensemble ordinaire
     {
-      const Mit_Ensemble *en = mi_en_ensemble (v);
+      const Mit_Ensemble *en = mi_en_ensemble_plat (v);
       unsigned t = en->mi_taille;
+      Mit_Symbole *const *el = mi_ensemble_prendre_elements (en);
       json_t *jel = json_array ();
       for (unsigned ix = 0; ix < t; ix++)
         {
-          const Mit_Symbole *sy = en->mi_elements[ix];
+          const Mit_Symbole *sy = el[ix];
           if (mi_sauvegarde_symbole_connu (sv, sy))
             json_array_append_new (jel,
                                    mi_json_val (sv,
                                                 MI_SYMBOLEV ((Mit_Symbole *)
                                                     sy)));
         }
+      mi_ensemble_rendre_elements (en, el);
       return json_pack ("{so}", "elem", jel);
     }
     break;
     case MiTy_Tuple:
+    case MiTy_VueTuple:	// une vue est sauvegardée comme un tuple
     {
-      const Mit_Tuple *tu = mi_en_tuple (v);
-      unsigned t = tu->mi_taille;
+      unsigned t = mi_sequence_taille (v);
       json_t *jcp = json_array ();
       for (unsigned ix = 0; ix < t; ix++)
         {
-          const Mit_Symbole *sy = tu->mi_composants[ix];
+          const Mit_Symbole *sy = mi_sequence_nieme (v, ix);
           assert (sy && sy != MI_TROU_SYMBOLE
                   && sy->mi_type == MiTy_Symbole);
           if (mi_sauvegarde_symbole_connu (sv, sy))
@@ -109,6 +147,28 @@ mi_json_val (struct Mi_Sauvegarde_st *sv, const Mit_Val v)
         }
       return json_pack ("{so}", "comp", jcp);
     }
+    case MiTy_TabEntiers:
+    {
+      const Mit_TabEntiers *te = v.miva_tabent;
+      json_t *jent = json_array ();
+      for (unsigned ix = 0; ix < te->mi_taille; ix++)
+        json_array_append_new (jent, json_integer (te->mi_tabent[ix]));
+      return json_pack ("{so}", "entiers", jent);
+    }
+    case MiTy_TabDoubles:
+    {
+      const Mit_TabDoubles *td = v.miva_tabdbl;
+      json_t *jdbl = json_array ();
+      for (unsigned ix = 0; ix < td->mi_taille; ix++)
+        {
+          double d = td->mi_tabdbl[ix];
+          int nc = mi_double_chiffres (d);
+          if (nc > sv->sv_chiffdbl)
+            sv->sv_chiffdbl = nc;
+          json_array_append_new (jdbl, mi_json_element_double (d));
+        }
+      return json_pack ("{so}", "doubles", jdbl);
+    }
     case MiTy__Dernier:	// ne devrait jamais arriver
       MI_FATALPRINTF ("valeur impossible@%p", v.miva_ptr);
     }
@@ -160,25 +220,48 @@ mi_val_json (const json_t *j)
       if (jc && json_is_array (jc))
         {
           unsigned ln = json_array_size (jc);
-          const Mit_Symbole *petitab[16] = { NULL };
-          const Mit_Symbole **tab =
-            (ln <
-             sizeof (petitab) / sizeof (petitab[0])) ? petitab : calloc (ln +
-                 1,
-                 sizeof
-                 (Mit_Symbole
-                  *));
-          if (!tab)
-            MI_FATALPRINTF
-            ("impossible de créer tableau de %d symboles (%s)", ln + 1,
-             strerror (errno));
+          struct Mi_ConstrTuple_st ct;
+          mi_constrtuple_initialiser (&ct, ln);
           for (unsigned ix = 0; ix < ln; ix++)
-            tab[ix] = mi_en_symbole (mi_val_json (json_array_get (jc, ix)));
-          const Mit_Tuple *tup = mi_creer_tuple_symboles (ln, tab);
-          if (tab != petitab)
-            free (tab);
+            mi_constrtuple_ajouter_symbole
+            (&ct, mi_en_symbole (mi_val_json (json_array_get (jc, ix))));
+          const Mit_Tuple *tup = mi_constrtuple_finir (&ct);
           return MI_TUPLEV (tup);
         }
+      json_t *jn = json_object_get (j, "entiers");
+      if (jn && json_is_array (jn))
+        {
+          unsigned ln = json_array_size (jn);
+          long *tab = calloc (ln + 1, sizeof (long));
+          if (!tab)
+            MI_FATALPRINTF ("impossible d'allouer %u entiers (%s)", ln,
+                            strerror (errno));
+          for (unsigned ix = 0; ix < ln; ix++)
+            {
+              json_t *je = json_array_get (jn, ix);
+              if (!json_is_integer (je))
+                MI_FATALPRINTF ("élément #%u d'un tableau d'entiers"
+                                " incorrect", ix);
+              tab[ix] = json_integer_value (je);
+            }
+          const Mit_TabEntiers *te = mi_creer_tabentiers (ln, tab);
+          free (tab);
+          return MI_TABENTIERSV (te);
+        }
+      json_t *jd = json_object_get (j, "doubles");
+      if (jd && json_is_array (jd))
+        {
+          unsigned ln = json_array_size (jd);
+          double *tab = calloc (ln + 1, sizeof (double));
+          if (!tab)
+            MI_FATALPRINTF ("impossible d'allouer %u doubles (%s)", ln,
+                            strerror (errno));
+          for (unsigned ix = 0; ix < ln; ix++)
+            tab[ix] = mi_element_double_json (json_array_get (jd, ix), ix);
+          const Mit_TabDoubles *td = mi_creer_tabdoubles (ln, tab);
+          free (tab);
+          return MI_TABDOUBLESV (td);
+        }
     }
   fprintf (stderr, "JSON incorrect:\n");
   json_dumpf (j, stderr, JSON_INDENT (1) | JSON_SORT_KEYS);
@@ -429,6 +512,8 @@ mi_sauvegarde_balayer (struct Mi_Sauvegarde_st *sv, const Mit_Val v)
     case MiTy_Chaine:
     case MiTy_Entier:
     case MiTy_Double:
+    case MiTy_TabEntiers:
+    case MiTy_TabDoubles:
       return;
     case MiTy_Symbole:
     {
@@ -439,25 +524,28 @@ mi_sauvegarde_balayer (struct Mi_Sauvegarde_st *sv, const Mit_Val v)
     }
     return;
     case MiTy_Ensemble:
+    case MiTy_EnsPersistant:
     {
-      const Mit_Ensemble *en = v.miva_ens;
+      const Mit_Ensemble *en = mi_en_ensemble_plat (v);
       unsigned t = en->mi_taille;
+      Mit_Symbole *const *el = mi_ensemble_prendre_elements (en);
       for (unsigned ix = 0; ix < t; ix++)
         {
-          const Mit_Symbole *sy = en->mi_elements[ix];
+          const Mit_Symbole *sy = el[ix];
           if (mi_sauvegarde_symbole_oublie (sv, sy))
             continue;
           mi_sauvegarde_balayer (sv, MI_SYMBOLEV ((Mit_Symbole *) sy));
         }
+      mi_ensemble_rendre_elements (en, el);
     }
     return;
     case MiTy_Tuple:
+    case MiTy_VueTuple:
     {
-      const Mit_Tuple *tu = v.miva_tup;
-      unsigned t = tu->mi_taille;
+      unsigned t = mi_sequence_taille (v);
       for (unsigned ix = 0; ix < t; ix++)
         {
-          const Mit_Symbole *sy = tu->mi_composants[ix];
+          const Mit_Symbole *sy = mi_sequence_nieme (v, ix);
           if (mi_sauvegarde_symbole_oublie (sv, sy))
             continue;
           mi_sauvegarde_balayer (sv, MI_SYMBOLEV ((Mit_Symbole *) sy));
@@ -556,10 +644,12 @@ mi_ecrirecontenusymbole (Mit_Symbole *sy, void *client)
   if (!fich)
     MI_FATALPRINTF ("impossible d'écrire le fichier %s (%s)",
                     nf, strerror (errno));
+  sv->sv_chiffdbl = 0;
   json_t *j = mi_json_contenu_symbole (sv, sy);
   assert (json_is_object (j));
   if (json_dumpf
-      (j, fich, JSON_INDENT (1) | JSON_ENSURE_ASCII | JSON_SORT_KEYS))
+      (j, fich, JSON_INDENT (1) | JSON_ENSURE_ASCII | JSON_SORT_KEYS
+       | JSON_REAL_PRECISION (sv->sv_chiffdbl ? sv->sv_chiffdbl : 17)))
     MI_FATALPRINTF ("échec d'écriture de JSON dans %s", nomfich);
   fputc ('\n', fich);
   fclose (fich);
@@ -596,6 +686,7 @@ mi_sauvegarde_finir (struct Mi_Sauvegarde_st *sv)
   // ecrire la liste des symboles connus
   const Mit_Ensemble *ensy = mi_creer_ensemble_enshash (&sv->sv_syconnu);
   assert (ensy && ensy->mi_type == MiTy_Ensemble);
+  Mit_Symbole *const *elsy = mi_ensemble_prendre_elements (ensy);
   char nomfic[MI_NOMFICHMAX];
   FILE *fs = NULL;
   snprintf (nomfic, sizeof (nomfic), "%s/symbolist", sv->sv_rep);
@@ -613,7 +704,7 @@ mi_sauvegarde_finir (struct Mi_Sauvegarde_st *sv)
   for (unsigned ix = 0; ix < nbsymb; ix++)
     {
       char tampsuf[16];
-      const Mit_Symbole *syel = ensy->mi_elements[ix];
+      const Mit_Symbole *syel = elsy[ix];
       assert (syel && syel->mi_type == MiTy_Symbole);
       fprintf (fs, "%s%s\n",
                mi_symbole_chaine (syel),
@@ -637,7 +728,7 @@ mi_sauvegarde_finir (struct Mi_Sauvegarde_st *sv)
   for (unsigned ix = 0; ix < ensy->mi_taille; ix++)
     {
       char tampsuf[16];
-      const Mit_Symbole *syel = ensy->mi_elements[ix];
+      const Mit_Symbole *syel = elsy[ix];
       assert (syel && syel->mi_type == MiTy_Symbole);
       if (!syel->mi_predef)
         continue;
@@ -650,6 +741,7 @@ mi_sauvegarde_finir (struct Mi_Sauvegarde_st *sv)
            "#define MI_NB_PREDEFINIS %d\n", nbpredef);
   fprintf (fs, "// fin fichier _mi_predef.h\n");
   fclose (fs), fs = NULL;
+  mi_ensemble_rendre_elements (ensy, elsy);
   mi_enshash_detruire (&sv->sv_syoubli);
   mi_enshash_detruire (&sv->sv_syconnu);
   printf ("sauvegarde de %d symboles dont %d prédéfinis dans %s/\n",
@@ -660,6 +752,10 @@ mi_sauvegarde_finir (struct Mi_Sauvegarde_st *sv)
 }				/* fin mi_sauvegarde_finir */
 
 
+/// le fichier symbolist est lu d'un coup; les radicaux sont d'abord
+/// créés ensemble par mi_creer_radicaux_tries, puisque le fichier est
+/// écrit dans l'ordre des noms, puis chaque symbole est créé sur son
+/// radical sans autre recherche
 static void
 mi_creer_symboles_charges (const char *rep)
 {
@@ -671,45 +767,75 @@ mi_creer_symboles_charges (const char *rep)
   if (!fs)
     MI_FATALPRINTF ("impossible d'ouvrir la liste de symboles %s (%s)",
                     nomfic, strerror (errno));
+  struct stat st;
+  memset (&st, 0, sizeof (st));
+  if (fstat (fileno (fs), &st))
+    MI_FATALPRINTF ("impossible d'examiner %s (%s)", nomfic,
+                    strerror (errno));
+  size_t taille = st.st_size;
+  char *tampon = malloc (taille + 1);
+  if (!tampon)
+    MI_FATALPRINTF ("impossible d'allouer %ld octets pour %s (%s)",
+                    (long) taille, nomfic, strerror (errno));
+  if (fread (tampon, 1, taille, fs) != taille)
+    MI_FATALPRINTF ("impossible de lire %s (%s)", nomfic, strerror (errno));
+  tampon[taille] = '\0';
+  fclose (fs), fs = NULL;
+  // au plus une ligne par saut de ligne, plus la dernière
+  unsigned maxlignes = 1;
+  for (const char *pc = tampon; (pc = strchr (pc, '\n')) != NULL; pc++)
+    maxlignes++;
+  const char **tabnom = calloc (maxlignes, sizeof (const char *));
+  unsigned *tablg = calloc (maxlignes, sizeof (unsigned));
+  unsigned *tabind = calloc (maxlignes, sizeof (unsigned));
+  struct MiSt_Radical_st **tabrad =
+    calloc (maxlignes, sizeof (struct MiSt_Radical_st *));
+  if (!tabnom || !tablg || !tabind || !tabrad)
+    MI_FATALPRINTF ("impossible d'allouer %u lignes pour %s (%s)",
+                    maxlignes, nomfic, strerror (errno));
   int numlin = 0;
-  int nbsymb = 0;
-  char *tampligne = NULL;
-  size_t tailleligne = 0;
-  ssize_t longligne = 0;
-  do
+  unsigned nbsymb = 0;
+  char *finligne = NULL;
+  for (char *ligne = tampon; *ligne; ligne = finligne)
     {
-      longligne = getline (&tampligne, &tailleligne, fs);
-      if (longligne < 0)
-        break;
+      finligne = strchr (ligne, '\n');
+      finligne = finligne ? finligne + 1 : ligne + strlen (ligne);
       numlin++;
-      if (tampligne[0] == '#')
+      if (ligne[0] == '#' || ligne[0] == '\n')
         continue;
-      if (!isalpha (tampligne[0]))
-        MI_FATALPRINTF ("ligne#%d de %s incorrecte: %s",
-                        numlin, nomfic, tampligne);
+      if (!isalpha (ligne[0]))
+        MI_FATALPRINTF ("ligne#%d de %s incorrecte: %.*s",
+                        numlin, nomfic, (int) (finligne - ligne), ligne);
       int finom = 0;
       unsigned ind = 0;
-      for (finom = 0; finom < (int) tailleligne && isalnum (tampligne[finom]);
-           finom++);
-      if (isspace (tampligne[finom]))
-        tampligne[finom] = '\0';
-      else if (tampligne[finom] == '_')
-        {
-          ind = atoi (tampligne + finom + 1);
-          tampligne[finom] = '\0';
-        };
-      if (!mi_nom_licite_chaine (tampligne))
-        MI_FATALPRINTF ("ligne#%d de %s illicite: %s", numlin, nomfic,
-                        tampligne);
-      Mit_Symbole *sy = mi_creer_symbole_chaine (tampligne, ind);
-      if (!sy)
-        MI_FATALPRINTF ("ligne#%d de %s avec mauvais symbole: %s",
-                        numlin, nomfic, tampligne);
+      while (isalnum (ligne[finom]))
+        finom++;
+      if (ligne[finom] == '_')
+        ind = atoi (ligne + finom + 1);
+      if (!mi_nom_licite_octets (ligne, finom)
+          || (ligne[finom] != '_' && ligne[finom] != '\0'
+              && !isspace (ligne[finom])))
+        MI_FATALPRINTF ("ligne#%d de %s illicite: %.*s", numlin, nomfic,
+                        (int) (finligne - ligne), ligne);
+      tabnom[nbsymb] = ligne;
+      tablg[nbsymb] = finom;
+      tabind[nbsymb] = ind;
       nbsymb++;
     }
-  while (!feof (fs));
-  free (tampligne);
-  fclose (fs);
+  mi_creer_radicaux_tries (nbsymb, tabnom, tablg, tabrad);
+  for (unsigned ix = 0; ix < nbsymb; ix++)
+    {
+      Mit_Symbole *sy = tabrad[ix]
+        ? mi_creer_symbole_radical (tabrad[ix], tabind[ix]) : NULL;
+      if (!sy)
+        MI_FATALPRINTF ("symbole %.*s_%u de %s incorrect",
+                        (int) tablg[ix], tabnom[ix], tabind[ix], nomfic);
+    }
+  free (tabnom);
+  free (tablg);
+  free (tabind);
+  free (tabrad);
+  free (tampon);
   printf ("%d symboles créés depuis %s\n", nbsymb, nomfic);
 }				// fin mi_creer_symboles_charges
 
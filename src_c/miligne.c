@@ -133,7 +133,6 @@ mi_generer_completion_alpha (const char *tige, int etat)
                  tige, tige, etat, vecrad, nbcompl, taillevec);
   if (etat == 0)
     {
-      int lgtige = strlen (tige);
       nbcompl = 0;
       // etat initial, il faut allouer et remplir vecrad
       // & nbcompl & taillevec;
@@ -142,16 +141,12 @@ mi_generer_completion_alpha (const char *tige, int etat)
       if (!vecrad)
         MI_FATALPRINTF ("impossible d'allouer %d completions (%s)",
                         taillevec, strerror (errno));
-      const char *nomrad = NULL;
-      for (struct MiSt_Radical_st * rad =
-             mi_trouver_radical_apres_ou_egal (tige);
-           rad != NULL
-           && (nomrad =
-                 mi_val_chaine (MI_CHAINEV (mi_radical_nom (rad)))) != NULL;
-           rad = mi_trouver_radical_apres (nomrad))
+      struct Mi_CurseurRadical_st cur;
+      for (mi_curseur_radical_prefixe (&cur, tige);
+           mi_curseur_radical (&cur) != NULL;
+           mi_curseur_radical_suivant (&cur))
         {
-          MI_DEBOPRINTF ("nbcompl=%d taillevec=%d nomrad:%s",
-                         nbcompl, taillevec, nomrad);
+          MI_DEBOPRINTF ("nbcompl=%d taillevec=%d", nbcompl, taillevec);
           if (nbcompl + 2 >= taillevec)
             {
               unsigned nouvtaille =
@@ -168,16 +163,10 @@ mi_generer_completion_alpha (const char *tige, int etat)
               vecrad = nouvecrad;
               taillevec = nouvtaille;
             }
-          if (!strncmp (nomrad, tige, lgtige))
-            {
-              assert (nbcompl >= 0 && nbcompl < taillevec);
-              vecrad[nbcompl] = rad;
-              MI_DEBOPRINTF ("vecrad[%d]@%p nomrad='%s'", nbcompl,
-                             vecrad[nbcompl], nomrad);
-              nbcompl++;
-            }
-          else
-            break;
+          assert (nbcompl >= 0 && nbcompl < taillevec);
+          vecrad[nbcompl] = mi_curseur_radical (&cur);
+          MI_DEBOPRINTF ("vecrad[%d]@%p", nbcompl, vecrad[nbcompl]);
+          nbcompl++;
         };
     }				// fin etat == 0
   if (etat < nbcompl)
@@ -166,76 +166,11 @@ mi_lire_chaine (struct Mi_Lecteur_st *lec, char *ps, const char **pfin)
 }				/* fin mi_lire_chaine */
 
 
-void
-mi_afficher_chaine_encodee (FILE * fi, const char *ch)
-{
-  if (!fi || !ch)
-    return;
-  size_t ln = strlen (ch);
-  if (u8_check ((const uint8_t *) ch, ln))
-    MI_FATALPRINTF ("chaine %.50s... incorrecte", ch);
-  size_t off = 0;
-  while (off < ln)
-    {
-      ucs4_t uc = 0;
-      int lc = u8_mbtouc_unsafe (&uc, (const uint8_t *) (ch + off), ln - off);
-      if (lc <= 0)
-        break;
-      if (uc < 128)
-        {
-          switch ((char) uc)
-            {
-            case '\'':
-            case '\"':
-            case '\\':
-              fprintf (fi, "\\%c", (char) uc);
-              break;
-            case '\a':
-              fputs ("\\a", fi);
-              break;
-            case '\b':
-              fputs ("\\b", fi);
-              break;
-            case '\f':
-              fputs ("\\f", fi);
-              break;
-            case '\n':
-              fputs ("\\n", fi);
-              break;
-            case '\r':
-              fputs ("\\r", fi);
-              break;
-            case '\t':
-              fputs ("\\t", fi);
-              break;
-            case '\v':
-              fputs ("\\v", fi);
-              break;
-            case '\033' /* ESCAPE */ :
-              fputs ("\\e", fi);
-              break;
-            default:
-              if (isprint ((char) uc))
-                fputc ((char) uc, fi);
-              else
-                fprintf (fi, "\\x%02x", uc);
-              break;
-            }
-        }
-      else if (uc < 0xffff)
-        fprintf (fi, "\\u%04x", (unsigned) uc);
-      else
-        fprintf (fi, "\\U%08x", (unsigned) uc);
-      off += lc;
-    }
-}				/* fin mi_afficher_chaine_encodee */
-
-
 // lit un symbole, ou un mot qui pourrait devenir un symbole.
 // positionne pfin pour en donner la position après le dernier caractère.
 // renvoie un symbole, s'il est trouvé.
 static Mit_Symbole *
-mi_lire_symbole (char *ps, char **pfin)
+mi_lire_symbole (const char *ps, const char **pfin)
 {
   assert (ps != NULL);
   assert (pfin != NULL);
@@ -246,37 +181,20 @@ mi_lire_symbole (char *ps, char **pfin)
       *pfin = NULL;
       return NULL;
     };
-  char *pdebsymb = ps;
-  char *pfinrad = NULL;		/* la fin du radical */
-  char *pblanc = NULL;		/* le blanc souligné avant indice */
-  char *pfind = NULL;		/* la fin de l'indice */
+  const char *pdebsymb = ps;
   unsigned ind = 0;
-  char finrad = 0;
   while (isalnum (*ps))
     ps++;
-  pfinrad = ps;
+  // le tampon n'est jamais modifié, il peut être en lecture seule
+  unsigned lgrad = ps - pdebsymb;
+  *pfin = ps;
   if (*ps == '_' && isdigit (ps[1]))
     {
-      pblanc = ps;
-      ind = (unsigned) strtol (ps + 1, &pfind, 10);
-      *pblanc = (char) 0;
-    }
-  else
-    {
-      finrad = (*pfinrad);
-      *pfinrad = (char)0;
-    };
-  Mit_Symbole *sy = mi_trouver_symbole_chaine (pdebsymb, ind);
-  if (pblanc)
-    {
-      *pblanc = '_';
-      *pfin = pfind;
-    }
-  else
-    {
-      *pfinrad = finrad;
-      *pfin = pfinrad;
+      char *finind = NULL;
+      ind = (unsigned) strtol (ps + 1, &finind, 10);
+      *pfin = finind;
     }
+  Mit_Symbole *sy = mi_trouver_symbole_octets (pdebsymb, lgrad, ind);
   return sy;
 }				/* fin mi_lire_symbole */
 
@@ -501,12 +419,12 @@ mi_lire_primaire (struct Mi_Lecteur_st *lec, char *ps, const char **pfin)
     {
       // un symbole existant
       char *pdebsymb = ps;
-      char *pfinsymb = NULL;
+      const char *pfinsymb = NULL;
       Mit_Symbole *sy = mi_lire_symbole (pdebsymb, &pfinsymb);
       if (sy)
         {
           assert (pfinsymb != NULL && pfinsymb > pdebsymb);
-          char *pc = pfinsymb;
+          char *pc = pdebsymb + (pfinsymb - pdebsymb);
           Mit_Val vc = mi_lire_complement (lec, MI_SYMBOLEV (sy), pc, &pc);
           if (pfin)
             *pfin = pc;
@@ -540,7 +458,7 @@ mi_lire_primaire (struct Mi_Lecteur_st *lec, char *ps, const char **pfin)
   else if (ps[0] == '$' && isalpha (ps[1]))
     {
       char *pdebtrou = ps;
-      char *pfintrou = NULL;
+      const char *pfintrou = NULL;
       ps++;
       Mit_Symbole *sy = mi_lire_symbole (ps, &pfintrou);
       if (sy)
@@ -550,7 +468,7 @@ mi_lire_primaire (struct Mi_Lecteur_st *lec, char *ps, const char **pfin)
           Mit_Val vtrou = tr.t_pres ? (tr.t_val) : MI_SYMBOLEV (sy);
           char *pfincomp = NULL;
           Mit_Val vcomp =
-            mi_lire_complement (lec, vtrou, pfintrou, &pfincomp);
+            mi_lire_complement (lec, vtrou, ps + (pfintrou - ps), &pfincomp);
           if (pfin)
             *pfin = pfincomp;
           if (lec->lec_pascreer)
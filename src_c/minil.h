@@ -29,10 +29,14 @@
 #include <string.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <limits.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <fcntl.h>
 #include <setjmp.h>
 #include <time.h>
 #include <math.h>
@@ -79,6 +83,10 @@ enum mi_typeval_en
   MiTy_Ensemble,
   MiTy_Tuple,
   MiTy_Symbole,
+  MiTy_TabEntiers,
+  MiTy_TabDoubles,
+  MiTy_VueTuple,
+  MiTy_EnsPersistant,
   MiTy__Dernier			// doit toujours être en dernier
 };
 
@@ -89,6 +97,10 @@ typedef struct MiSt_Chaine_st Mit_Chaine;
 typedef struct MiSt_Ensemble_st Mit_Ensemble;
 typedef struct MiSt_Tuple_st Mit_Tuple;
 typedef struct MiSt_Symbole_st Mit_Symbole;
+typedef struct MiSt_TabEntiers_st Mit_TabEntiers;
+typedef struct MiSt_TabDoubles_st Mit_TabDoubles;
+typedef struct MiSt_VueTuple_st Mit_VueTuple;
+typedef struct MiSt_EnsPersistant_st Mit_EnsPersistant;
 
 // Une valeur est un pointeur, mais de plusieurs types possibles, donc une union.
 // Toute valeur non-nulle commence par son type et sa marque de ramasse-miettes.
@@ -110,6 +122,10 @@ union MiSt_Val_un
   const Mit_Ensemble *miva_ens;
   const Mit_Tuple *miva_tup;
   Mit_Symbole *miva_sym;
+  const Mit_TabEntiers *miva_tabent;
+  const Mit_TabDoubles *miva_tabdbl;
+  const Mit_VueTuple *miva_vuetup;
+  const Mit_EnsPersistant *miva_ensp;
 };
 typedef union MiSt_Val_un Mit_Val;
 
@@ -120,6 +136,10 @@ typedef union MiSt_Val_un Mit_Val;
 #define MI_ENSEMBLEV(E) ((Mit_Val){.miva_ens=(E)})
 #define MI_TUPLEV(T) ((Mit_Val){.miva_tup=(T)})
 #define MI_SYMBOLEV(S) ((Mit_Val){.miva_sym=(S)})
+#define MI_TABENTIERSV(T) ((Mit_Val){.miva_tabent=(T)})
+#define MI_TABDOUBLESV(T) ((Mit_Val){.miva_tabdbl=(T)})
+#define MI_VUETUPLEV(V) ((Mit_Val){.miva_vuetup=(V)})
+#define MI_ENSPERSISTANTV(E) ((Mit_Val){.miva_ensp=(E)})
 
 /// une structure pour retourner (rapidement) une valeur et un drapeau
 /// de présence.
@@ -153,14 +173,20 @@ struct MiSt_Double_st
   double mi_dbl;
 };
 
-// Une valeur chaîne a un type, une marque, et les octets de la chaîne
-// (terminés par l'octet nul).
+// Une valeur chaine a un type, une marque, un hash, une taille en
+// octets et une longueur en caractères. Une longue chaine non-ASCII
+// réserve après ses octets la place d'un index, calculé à la demande,
+// du décalage de chaque MI_CHAINE_PAS_INDEX-ième caractère.
 // C'est une structure de taille "variable" se terminant par un membre flexible
 // https://en.wikipedia.org/wiki/Flexible_array_member
+#define MI_CHAINE_PAS_INDEX 32
+#define MI_CHAINE_SEUIL_INDEX 128
 struct MiSt_Chaine_st
 {
   enum mi_typeval_en mi_type;
   bool mi_marq;
+  bool mi_ascii;		// vrai si tous les octets sont ASCII
+  bool mi_indexee;		// vrai si l'index est calculé
   unsigned mi_hash;
   unsigned mi_taille;
   unsigned mi_long;
@@ -168,14 +194,27 @@ struct MiSt_Chaine_st
 };
 
 // Une valeur ensemble a un type, une marque, une taille, et les symboles en ordre croissant
-
+// Au delà de MI_ENSEMBLE_SEUIL_COMPACT éléments, un ensemble est
+// compact: une carte de bits de leurs identifiants, sans tableau
+// d'éléments; son n-ième élément est dans l'ordre des identifiants.
+#define MI_ENSEMBLE_SEUIL_COMPACT 16384
+// Les tests d'appartenance à un ensemble d'au moins
+// MI_ENSEMBLE_SEUIL_EYTZ éléments passent par un tableau de leurs
+// clefs, construit à la demande, rangé en ordre d'Eytzinger.
+#define MI_ENSEMBLE_SEUIL_EYTZ 64
+struct Mi_CarteBits_st;
+struct Mi_ClefsEytz_st;
 struct MiSt_Ensemble_st
 {
   enum mi_typeval_en mi_type;
   bool mi_marq;
-  unsigned mi_hash;
+  bool mi_partage;		// vrai s'il est dans la table de partage
+  unsigned mi_hash;		// nul s'il n'est pas encore calculé
   unsigned mi_taille;
-  Mit_Symbole *mi_elements[];
+  Mit_Symbole **mi_elements;	// mi_tabelem, ou NULL pour un compact
+  struct Mi_CarteBits_st *mi_compact;	// la carte de bits, ou NULL
+  struct Mi_ClefsEytz_st *mi_eytz;	// les clefs, ou NULL
+  Mit_Symbole *mi_tabelem[];
 };
 // Une valeur ensemble a un type, une marque, une taille, et les symboles
 
@@ -183,10 +222,69 @@ struct MiSt_Tuple_st
 {
   enum mi_typeval_en mi_type;
   bool mi_marq;
+  bool mi_partage;		// vrai s'il est dans la table de partage
   unsigned mi_hash;
   unsigned mi_taille;
   Mit_Symbole *mi_composants[];
 };
+// Une vue de tuple est une suite de composants, comme un tuple, mais
+// faite sans copie de quelques tranches de tuples existants, qu'elle
+// garde en vie. Son hash, calculé à la demande, est celui du tuple
+// de mêmes composants. Les tranches et concaténations d'au plus
+// MI_VUE_SEUIL composants sont des tuples ordinaires.
+#define MI_VUE_MAXSEG 4
+#define MI_VUE_SEUIL 16
+struct Mi_SegmentTuple_st
+{
+  const Mit_Tuple *seg_tuple;
+  unsigned seg_debut;
+  unsigned seg_long;
+};
+struct MiSt_VueTuple_st
+{
+  enum mi_typeval_en mi_type;
+  bool mi_marq;
+  unsigned mi_hash;		// nul tant qu'il n'est pas calculé
+  unsigned mi_taille;
+  unsigned mi_nbseg;
+  struct Mi_SegmentTuple_st mi_seg[MI_VUE_MAXSEG];
+};
+
+// Un ensemble persistant partage sa structure avec ceux dont il est
+// issu par ajout ou retrait d'un symbole, qui coûtent un temps
+// logarithmique. Sa forme ordinaire et son hash, égal à celui de
+// l'ensemble ordinaire de mêmes éléments, sont calculés à la demande.
+struct Mi_NoeudHamt_st;
+struct MiSt_EnsPersistant_st
+{
+  enum mi_typeval_en mi_type;
+  bool mi_marq;
+  unsigned mi_hash;		// nul tant qu'il n'est pas calculé
+  unsigned mi_taille;
+  struct Mi_NoeudHamt_st *mi_racine;
+  const Mit_Ensemble *mi_plat;	// la forme ordinaire, ou NULL
+};
+
+// Un tableau numérique a un type, une marque, un hash, une taille, et
+// les nombres contigus
+struct MiSt_TabEntiers_st
+{
+  enum mi_typeval_en mi_type;
+  bool mi_marq;
+  unsigned mi_hash;
+  unsigned mi_taille;
+  long mi_tabent[];
+};
+
+struct MiSt_TabDoubles_st
+{
+  enum mi_typeval_en mi_type;
+  bool mi_marq;
+  unsigned mi_hash;
+  unsigned mi_taille;
+  double mi_tabdbl[];
+};
+
 // Une association par table de hashage entre symboles et valeurs.
 // Ce n'est pas une valeur, mais une donnée interne.
 struct Mi_Assoc_st;
@@ -212,15 +310,22 @@ struct MiSt_Radical_st;
 // Une valeur symbole a un type, une marque, un radical, un
 // indice, une association pour les attributs et un vecteur de
 // composants; elle a aussi un chargement qui n'est pas proprement une
-// valeur, et qui est discriminée par mi_chatype
+// valeur, et qui est discriminée par mi_chatype. Le rang, copie de
+// celui du radical, ordonne les symboles sans comparer leurs noms.
+// L'identifiant, dense et non nul, est donné à la création.
 struct MiSt_Symbole_st
 {
   enum mi_typeval_en mi_type;
   bool mi_marq;
+  bool mi_predef;
   unsigned mi_hash;
   unsigned mi_indice;
-  bool mi_predef;
+  uint32_t mi_rang;
+  uint32_t mi_ident;
   struct MiSt_Radical_st *mi_radical;
+  // les symboles secondaires du même radical, en liste doublement chaînée
+  Mit_Symbole *mi_secprec;
+  Mit_Symbole *mi_secsuiv;
   struct Mi_Assoc_st *mi_attrs;
   struct Mi_Vecteur_st *mi_comps;
   enum mi_type_charge_en mi_chatype;
@@ -237,6 +342,16 @@ struct MiSt_Symbole_st
 
 
 int mi_cmp_symbole (const Mit_Symbole *sy1, const Mit_Symbole *sy2);
+/// la clef d'ordre d'un symbole, comparable comme un entier: le rang
+/// de son radical, qui suit l'ordre des noms, puis son indice
+static inline uint64_t
+mi_cle_symbole (const Mit_Symbole *sy)
+{
+  return ((uint64_t) sy->mi_rang << 32) | sy->mi_indice;
+}				// fin mi_cle_symbole
+/// incrémenté à chaque renumérotation des rangs des radicaux, pour
+/// invalider ce qui dépend des clefs
+extern unsigned long mi_generation_rangs;
 int mi_cmp_symboleptr (const void *, const void *);	// pour qsort
 
 // aussi bien dans la table des symboles que dans les associations
@@ -297,15 +412,77 @@ mi_en_ensemble (const Mit_Val v)
   return v.miva_ens;
 }				// fin mi_en_noeud
 
+static inline const Mit_VueTuple *
+mi_en_vuetuple (const Mit_Val v)
+{
+  if (!v.miva_ptr || *v.miva_type != MiTy_VueTuple)
+    return NULL;
+  return v.miva_vuetup;
+}				// fin mi_en_vuetuple
+
+static inline const Mit_EnsPersistant *
+mi_en_enspersistant (const Mit_Val v)
+{
+  if (!v.miva_ptr || *v.miva_type != MiTy_EnsPersistant)
+    return NULL;
+  return v.miva_ensp;
+}				// fin mi_en_enspersistant
+
+static inline const Mit_TabEntiers *
+mi_en_tabentiers (const Mit_Val v)
+{
+  if (!v.miva_ptr || *v.miva_type != MiTy_TabEntiers)
+    return NULL;
+  return v.miva_tabent;
+}				// fin mi_en_tabentiers
+
+static inline const Mit_TabDoubles *
+mi_en_tabdoubles (const Mit_Val v)
+{
+  if (!v.miva_ptr || *v.miva_type != MiTy_TabDoubles)
+    return NULL;
+  return v.miva_tabdbl;
+}				// fin mi_en_tabdoubles
+
 
 /// mis à vrai quand faut lancer un ramasse miettes, ne doit pas être
 /// modifié ailleurs...
 extern bool mi_faut_ramiet;
 /// allocation de bas niveau d'une valeur, utilisée par les routines de création
 void *mi_allouer_valeur (enum mi_typeval_en typv, size_t tail);
+/// libération d'une valeur tout juste allouée, encore référencée nulle part
+void mi_liberer_valeur_fraiche (void *ptr);
+/// réduction à tail octets d'une valeur tout juste allouée, encore
+/// référencée nulle part; renvoie sa nouvelle adresse
+void *mi_retrecir_valeur_fraiche (void *ptr, size_t tail);
+
+/// le partage (ou hash-consing) des tuples et ensembles égaux, actif
+/// si mi_partage_actif; les fonctions de partage prennent une valeur
+/// fraîche, qu'elles libèrent si une valeur égale est déjà partagée
+extern bool mi_partage_actif;
+const Mit_Tuple *mi_partager_tuple (Mit_Tuple * tu);
+const Mit_Ensemble *mi_partager_ensemble (Mit_Ensemble * en);
+/// à appeler par le ramasse-miettes sur chaque tuple ou ensemble libéré
+void mi_partage_oublier (const Mit_Val v);
+/// oublie les valeurs partagées contenant un des symboles de eh, qui
+/// vont être détruits
+struct Mi_EnsHash_st;
+void mi_partage_oublier_symboles (const struct Mi_EnsHash_st *eh);
+unsigned mi_partage_compte (void);
 
 /// création de chaine
 const Mit_Chaine *mi_creer_chaine (const char *ch);
+/// création depuis nb octets, pas forcément terminés par un nul; NULL
+/// s'ils ne sont pas de l'UTF-8 valide ou contiennent un nul
+const Mit_Chaine *mi_creer_chaine_octets (const char *oct, size_t nb);
+/// le caractère de rang donné (négatif depuis la fin), ou 0
+ucs4_t mi_chaine_car (const Mit_Chaine *ch, int rang);
+/// le décalage en octets du caractère de rang donné, ou la taille
+unsigned mi_chaine_decalage (const Mit_Chaine *ch, unsigned rang);
+/// la sous-chaine de lg caractères à partir du rang deb (négatif
+/// depuis la fin), tronquée à la fin de la chaine
+const Mit_Chaine *mi_sous_chaine (const Mit_Chaine *ch, int deb,
+                                  unsigned lg);
 /// création à la printf
 const Mit_Chaine *mi_creer_chaine_printf (const char *fmt, ...)
 __attribute__ ((format (printf, 1, 2)));
@@ -330,6 +507,12 @@ mi_vald_chaine (const Mit_Val v, const char *def)
 // afficher de manière encodée à la C (avec \t pour tabulation, etc...) une chaîne UTF8
 void mi_afficher_chaine_encodee (FILE * fi, const char *ch);
 
+/// écriture rapide d'entiers en décimal dans un tampon d'au moins
+/// MI_TAILLE_TAMPON_ENTIER octets, renvoie la longueur écrite
+#define MI_TAILLE_TAMPON_ENTIER 24
+int mi_naturel_en_chaine (char *tamp, unsigned long n);
+int mi_entier_en_chaine (char *tamp, long l);
+
 /// création d'entier
 const Mit_Entier *mi_creer_entier (long l);
 /// accès à l'entier ou une valeur par défaut
@@ -352,8 +535,117 @@ mi_vald_double (const Mit_Val v, double def)
   return def;
 }
 
+/// écriture décimale d'un double: la plus courte relue exactement par
+/// strtod, toujours avec un point décimal, ou bien +NAN +INF -INF;
+/// renvoie la longueur écrite
+#define MI_TAILLE_TAMPON_DOUBLE 32
+int mi_double_en_chaine (char tamp[MI_TAILLE_TAMPON_DOUBLE], double d);
+/// le nombre de chiffres significatifs suffisant pour que le format
+/// %.*g relise exactement le double
+int mi_double_chiffres (double d);
+
+/// tableaux numériques, créés à zéro si tab est nul
+const Mit_TabEntiers *mi_creer_tabentiers (unsigned nb, const long *tab);
+const Mit_TabDoubles *mi_creer_tabdoubles (unsigned nb, const double *tab);
+/// calculs en masse; les opérations à deux tableaux s'arrêtent au
+/// plus court, et les minmax renvoient faux sur un tableau vide; les
+/// somme et produit scalaire d'entiers renvoient faux s'ils ne
+/// tiennent pas dans un long
+bool mi_tabentiers_somme (const Mit_TabEntiers * te, long *psomme);
+double mi_tabdoubles_somme (const Mit_TabDoubles * td);
+bool mi_tabentiers_minmax (const Mit_TabEntiers * te, long *pmin,
+                           long *pmax);
+bool mi_tabdoubles_minmax (const Mit_TabDoubles * td, double *pmin,
+                           double *pmax);
+bool mi_tabentiers_produit_scalaire (const Mit_TabEntiers * te1,
+                                     const Mit_TabEntiers * te2,
+                                     long *pprod);
+double mi_tabdoubles_produit_scalaire (const Mit_TabDoubles * td1,
+                                       const Mit_TabDoubles * td2);
+enum mi_opnum_en
+{
+  MiOp_Ajout,
+  MiOp_Soustr,
+  MiOp_Mult,
+  MiOp_Div
+};
+const Mit_TabEntiers *mi_tabentiers_operation (enum mi_opnum_en op,
+    const Mit_TabEntiers * te1,
+    const Mit_TabEntiers * te2);
+const Mit_TabDoubles *mi_tabdoubles_operation (enum mi_opnum_en op,
+    const Mit_TabDoubles * td1,
+    const Mit_TabDoubles * td2);
+
 void mi_afficher_valeur (FILE * fi, const Mit_Val v);
 
+/// un imprimeur accumule du texte dans un tampon mémoire extensible et
+/// réutilisable, qu'on écrit d'un coup dans un FILE* ou dont on fait
+/// une chaîne; si imp_max est non nul, le texte au delà est omis
+#define MI_IMPRIMEUR_NMAGIQ 0x2c9e5b13	/*748575507 */
+struct Mi_Imprimeur_st
+{
+  unsigned imp_nmagiq;		/* toujours MI_IMPRIMEUR_NMAGIQ */
+  bool imp_tronque;		/* vrai si du texte a été omis */
+  size_t imp_taille;		/* taille allouée de imp_octets */
+  size_t imp_long;		/* nombre d'octets écrits */
+  size_t imp_max;		/* longueur maximale, ou 0 si illimitée */
+  char *imp_octets;		/* toujours terminé par un octet nul */
+};
+/// la longueur maximale des affichages, ou 0
+extern size_t mi_affichage_max;
+void mi_imprimeur_initialiser (struct Mi_Imprimeur_st *im, size_t max);
+void mi_imprimeur_detruire (struct Mi_Imprimeur_st *im);
+void mi_imprimeur_agrandir (struct Mi_Imprimeur_st *im, size_t nb);
+void mi_imprimeur_octets (struct Mi_Imprimeur_st *im, const char *oct,
+                          size_t nb);
+void mi_imprimeur_printf (struct Mi_Imprimeur_st *im, const char *fmt, ...)
+__attribute__ ((format (printf, 2, 3)));
+void mi_imprimeur_entier (struct Mi_Imprimeur_st *im, long l);
+void mi_imprimeur_symbole (struct Mi_Imprimeur_st *im,
+                           const Mit_Symbole *sy);
+void mi_imprimeur_chaine_encodee (struct Mi_Imprimeur_st *im,
+                                  const char *ch);
+void mi_imprimeur_valeur (struct Mi_Imprimeur_st *im, const Mit_Val v);
+// le contenu d'un symbole, avec les échappements ANSI si terminal est vrai
+void mi_imprimeur_contenu_symbole (struct Mi_Imprimeur_st *im,
+                                   const Mit_Symbole *sy, bool terminal);
+// écrire le texte accumulé puis vider l'imprimeur
+void mi_imprimeur_ecrire (struct Mi_Imprimeur_st *im, FILE * fi);
+// faire une chaîne du texte accumulé puis vider l'imprimeur
+const Mit_Chaine *mi_imprimeur_en_chaine (struct Mi_Imprimeur_st *im);
+// l'imprimeur commun des affichages, vidé et limité à mi_affichage_max
+struct Mi_Imprimeur_st *mi_imprimeur_commun (void);
+
+static inline void
+mi_imprimeur_vider (struct Mi_Imprimeur_st *im)
+{
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
+  im->imp_long = 0;
+  im->imp_tronque = false;
+  if (im->imp_octets)
+    im->imp_octets[0] = (char) 0;
+}
+
+static inline void
+mi_imprimeur_car (struct Mi_Imprimeur_st *im, char c)
+{
+  if (im->imp_long + 1 < im->imp_taille
+      && (!im->imp_max || im->imp_long < im->imp_max))
+    {
+      im->imp_octets[im->imp_long++] = c;
+      im->imp_octets[im->imp_long] = (char) 0;
+    }
+  else
+    mi_imprimeur_octets (im, &c, 1);
+}
+
+static inline void
+mi_imprimeur_chaine (struct Mi_Imprimeur_st *im, const char *ch)
+{
+  if (ch)
+    mi_imprimeur_octets (im, ch, strlen (ch));
+}
+
 /// arité d'un tuple
 static inline unsigned
 mi_arite_tuple (const Mit_Tuple * tu)
@@ -372,16 +664,29 @@ mi_cardinal_ensemble (const Mit_Ensemble * en)
   return en->mi_taille;
 }
 
+// les éléments ordonnés d'un ensemble; pour un ensemble compact,
+// c'est un tableau temporaire, qu'il faut rendre
+Mit_Symbole *const *mi_ensemble_prendre_elements (const Mit_Ensemble * en);
+void mi_ensemble_rendre_elements (const Mit_Ensemble * en,
+                                  Mit_Symbole * const *el);
+// le hash, calculé à la demande pour un ensemble compact
+unsigned mi_ensemble_hash (const Mit_Ensemble * en);
+Mit_Symbole *mi_cartebits_nieme (const struct Mi_CarteBits_st *cb,
+                                 unsigned n);
+
+// le n-ième élément, dans l'ordre des clefs, ou des identifiants pour
+// un ensemble compact
 static inline Mit_Symbole *
 mi_ensemble_nieme (const Mit_Ensemble * en, int n)
 {
   if (!en || en->mi_type != MiTy_Ensemble)
     return NULL;
   unsigned ca = en->mi_taille;
-  if (n < (int) ca)
+  if (n < 0)
     n += (int) ca;
   if (n >= 0 && n < (int) ca)
-    return en->mi_elements[n];
+    return en->mi_compact ? mi_cartebits_nieme (en->mi_compact, n)
+           : en->mi_elements[n];
   return NULL;
 }
 
@@ -391,7 +696,7 @@ mi_tuple_nieme (const Mit_Tuple * tu, int n)
   if (!tu || tu->mi_type != MiTy_Tuple)
     return NULL;
   unsigned ta = tu->mi_taille;
-  if (n < (int) ta)
+  if (n < 0)
     n += (int) ta;
   if (n >= 0 && n < (int) ta)
     return tu->mi_composants[n];
@@ -431,9 +736,17 @@ void mi_enshash_iterer (struct Mi_EnsHash_st *eh, mi_itersymb_sigt * f,
                         void *client);
 
 const Mit_Ensemble *mi_ensemble_vide (void);
+/// trier des symboles valides par leur clef, donc dans l'ordre des ensembles
+void mi_trier_symboles (unsigned nb, Mit_Symbole **tab);
 const Mit_Ensemble *mi_creer_ensemble_enshash (struct Mi_EnsHash_st *eh);
 const Mit_Ensemble *mi_creer_ensemble_symboles (unsigned nb,
     const Mit_Symbole **tab);
+/// un ensemble frais pour ta éléments, à remplir dans mi_tabelem
+/// de symboles ordonnés par clef croissante, puis à finir par
+/// mi_finir_ensemble avec leur nombre nb <= ta
+Mit_Ensemble *mi_allouer_ensemble (unsigned ta);
+const Mit_Ensemble *mi_finir_ensemble (Mit_Ensemble * enr, unsigned ta,
+                                       unsigned nb);
 const Mit_Ensemble *mi_creer_ensemble_valeurs (unsigned nb,
     const Mit_Val *tabval);
 const Mit_Ensemble *mi_creer_ensemble_varsym (unsigned nb, ...);
@@ -448,21 +761,171 @@ const Mit_Ensemble *mi_ensemble_union (const Mit_Ensemble * en1,
                                        const Mit_Ensemble * en2);
 const Mit_Ensemble *mi_ensemble_intersection (const Mit_Ensemble * en1,
     const Mit_Ensemble * en2);
+/// les unions et intersections d'assez grands ensembles sont
+/// mémorisées dans un cache, dans la limite d'un budget en octets
+struct Mi_StatMemo_st
+{
+  unsigned long sm_succes;
+  unsigned long sm_echecs;
+  unsigned long sm_evictions;
+  unsigned sm_nombre;		// nombre d'entrées
+  size_t sm_octets;		// place retenue
+  size_t sm_budget;
+};
+// changer le budget, nul pour ne plus rien mémoriser; renvoie l'ancien
+size_t mi_memo_ensembles_budget (size_t budget);
+void mi_memo_ensembles_vider (void);
+void mi_memo_ensembles_stat (struct Mi_StatMemo_st *st);
+/// union et intersection de nb ensembles, sans ensembles intermédiaires
+const Mit_Ensemble *mi_ensemble_union_multiple (unsigned nb,
+    const Mit_Ensemble **tabens);
+const Mit_Ensemble *mi_ensemble_intersection_multiple (unsigned nb,
+    const Mit_Ensemble **tabens);
+const Mit_Ensemble *mi_ensemble_difference (const Mit_Ensemble * en1,
+    const Mit_Ensemble * en2);
+const Mit_Ensemble *mi_ensemble_difference_symetrique (const Mit_Ensemble *
+    en1,
+    const Mit_Ensemble *
+    en2);
+// égalité d'ensembles, immédiate quand ils sont partagés
+bool mi_ensemble_egal (const Mit_Ensemble * en1, const Mit_Ensemble * en2);
+// inclusion de en1 dans en2
+bool mi_ensemble_inclus (const Mit_Ensemble * en1, const Mit_Ensemble * en2);
+
+/// les ensembles persistants; ajouter et ôter renvoient un nouvel
+/// ensemble, ou le même s'il est inchangé
+const Mit_EnsPersistant *mi_enspersistant_vide (void);
+const Mit_EnsPersistant *mi_enspersistant_ajouter (const Mit_EnsPersistant *ep,
+    const Mit_Symbole *sy);
+const Mit_EnsPersistant *mi_enspersistant_oter (const Mit_EnsPersistant *ep,
+    const Mit_Symbole *sy);
+bool mi_enspersistant_contient (const Mit_EnsPersistant *ep,
+                                const Mit_Symbole *sy);
+unsigned mi_enspersistant_cardinal (const Mit_EnsPersistant *ep);
+unsigned mi_enspersistant_hash (const Mit_EnsPersistant *ep);
+// la forme ordinaire, ordonnée, et la conversion inverse
+const Mit_Ensemble *mi_enspersistant_ensemble (const Mit_EnsPersistant *ep);
+const Mit_EnsPersistant *mi_enspersistant_depuis_ensemble (const Mit_Ensemble
+    * en);
+// itération sans ordre particulier
+void mi_enspersistant_iterer (const Mit_EnsPersistant *ep,
+                              mi_itersymb_sigt * f, void *client);
+
+/// l'ensemble ordinaire d'une valeur ensemble ou ensemble persistant
+static inline const Mit_Ensemble *
+mi_en_ensemble_plat (const Mit_Val v)
+{
+  switch (mi_vtype (v))
+    {
+    case MiTy_Ensemble:
+      return v.miva_ens;
+    case MiTy_EnsPersistant:
+      return mi_enspersistant_ensemble (v.miva_ensp);
+    default:
+      return NULL;
+    }
+}				// fin mi_en_ensemble_plat
+
+/// les expressions paresseuses d'ensembles; les opérations prennent
+/// possession de leurs opérandes, et l'évaluation détruit l'expression
+struct Mi_ExprEns_st;
+struct Mi_ExprEns_st *mi_exprens_ensemble (const Mit_Ensemble * en);
+struct Mi_ExprEns_st *mi_exprens_union (struct Mi_ExprEns_st *e1,
+                                        struct Mi_ExprEns_st *e2);
+struct Mi_ExprEns_st *mi_exprens_intersection (struct Mi_ExprEns_st *e1,
+    struct Mi_ExprEns_st *e2);
+struct Mi_ExprEns_st *mi_exprens_difference (struct Mi_ExprEns_st *e1,
+    struct Mi_ExprEns_st *e2);
+const Mit_Ensemble *mi_exprens_evaluer (struct Mi_ExprEns_st *ex);
+void mi_exprens_detruire (struct Mi_ExprEns_st *ex);
+
+/// les cartes de bits d'identifiants de symboles, pour les grands
+/// ensembles
+enum mi_opens_en
+{
+  MiOpEns_Union,
+  MiOpEns_Inter,
+  MiOpEns_Diff,
+  MiOpEns_DiffSym
+};
+struct Mi_CarteBits_st *mi_cartebits_creer (unsigned nb,
+    Mit_Symbole *const *tab);
+void mi_cartebits_detruire (struct Mi_CarteBits_st *cb);
+unsigned mi_cartebits_cardinal (const struct Mi_CarteBits_st *cb);
+bool mi_cartebits_contient (const struct Mi_CarteBits_st *cb, uint32_t id);
+struct Mi_CarteBits_st *mi_cartebits_operation (enum mi_opens_en op,
+    const struct Mi_CarteBits_st *cb1,
+    const struct Mi_CarteBits_st *cb2);
+bool mi_cartebits_egales (const struct Mi_CarteBits_st *cb1,
+                          const struct Mi_CarteBits_st *cb2);
+// remplit tab, dans l'ordre des identifiants, et renvoie le cardinal
+unsigned mi_cartebits_symboles (const struct Mi_CarteBits_st *cb,
+                                Mit_Symbole **tab);
+void mi_cartebits_iterer (const struct Mi_CarteBits_st *cb,
+                          mi_itersymb_sigt * f, void *client);
+// construction d'une carte en un seul passage, pour des identifiants
+// inférieurs à la borne donnée, ajoutés dans n'importe quel ordre
+struct Mi_ConstrCarte_st;
+struct Mi_ConstrCarte_st *mi_constrcarte_creer (uint32_t borne);
+void mi_constrcarte_ajouter (struct Mi_ConstrCarte_st *cc, uint32_t id);
+struct Mi_CarteBits_st *mi_constrcarte_finir (struct Mi_ConstrCarte_st *cc);
 
 // un tuple contient des symboles non nuls
 const Mit_Tuple *mi_tuple_vide (void);
+// égalité de tuples, immédiate quand ils sont partagés
+bool mi_tuple_egal (const Mit_Tuple * tu1, const Mit_Tuple * tu2);
 const Mit_Tuple *mi_creer_tuple_symboles (unsigned nb,
     const Mit_Symbole **tabsym);
 const Mit_Tuple *mi_creer_tuple_valeurs (unsigned nb, const Mit_Val *tabval);
+
+/// les séquences sont les tuples et les vues de tuple
+unsigned mi_sequence_taille (const Mit_Val v);
+Mit_Symbole *mi_sequence_nieme (const Mit_Val v, int n);
+/// la tranche de lg composants depuis le rang deb (négatif depuis la
+/// fin), et la concaténation de deux séquences, sont des vues ou des
+/// tuples
+Mit_Val mi_sequence_tranche (const Mit_Val v, int deb, unsigned lg);
+Mit_Val mi_sequence_concatener (const Mit_Val v1, const Mit_Val v2);
+unsigned mi_vuetuple_hash (const Mit_VueTuple *vt);
+const Mit_Tuple *mi_vuetuple_materialiser (const Mit_VueTuple *vt);
+
+/// un constructeur de tuple, alloué sur la pile, écrit les composants
+/// directement dans le tuple final dimensionné d'avance, en calculant
+/// le hash au fur et à mesure; les symboles nuls sont ignorés
+#define MI_CONSTRTUPLE_NMAGIQ 0x1d6f3a85	/*493828741 */
+struct Mi_ConstrTuple_st
+{
+  unsigned ct_nmagiq;		/* toujours MI_CONSTRTUPLE_NMAGIQ */
+  unsigned ct_taille;		/* nombre maximal de composants */
+  unsigned ct_compte;		/* nombre de composants déjà écrits */
+  unsigned ct_h1, ct_h2;	/* hash partiel */
+  Mit_Tuple *ct_tuple;		/* le tuple en construction */
+};
+void mi_constrtuple_initialiser (struct Mi_ConstrTuple_st *ct, unsigned nb);
+void mi_constrtuple_ajouter_symbole (struct Mi_ConstrTuple_st *ct,
+                                     const Mit_Symbole *sy);
+// ajouter un symbole, ou les composants d'une séquence ou d'un ensemble
+void mi_constrtuple_ajouter_valeur (struct Mi_ConstrTuple_st *ct,
+                                    const Mit_Val v);
+const Mit_Tuple *mi_constrtuple_finir (struct Mi_ConstrTuple_st *ct);
+// le nombre de composants qu'ajouterait mi_constrtuple_ajouter_valeur
+unsigned mi_nombre_composants_valeur (const Mit_Val v);
 // hash code d'une chaine
 unsigned mi_hashage_chaine (const char *ch);
+// le même, pour nb octets pas forcément terminés par un nul
+unsigned mi_hashage_octets (const char *oct, unsigned nb);
 // tester si une valeur chaine est licite pour un nom
 bool mi_nom_licite (const Mit_Chaine *nom);
 // tester si une chaine C est licite
 bool mi_nom_licite_chaine (const char *ch);
+bool mi_nom_licite_octets (const char *oct, unsigned nb);
 // Trouver un symbole de nom et indice donnés
 Mit_Symbole *mi_trouver_symbole_nom (const Mit_Chaine *nom, unsigned ind);
 Mit_Symbole *mi_trouver_symbole_chaine (const char *ch, unsigned ind);
+// ... le nom étant donné par nb octets en oct, pas forcément terminés
+// par un nul, qui ne sont jamais modifiés; aucune allocation
+Mit_Symbole *mi_trouver_symbole_octets (const char *oct, unsigned nb,
+                                        unsigned ind);
 // trouver un symbole à partir de la chaine le nommant, avec un
 // éventuel indice commençant par un blanc souligné
 // si pfin est non nul il est mis au caractère suivant le nom
@@ -472,12 +935,39 @@ Mit_Symbole* mi_creer_symbole_radical(struct MiSt_Radical_st*rad, unsigned ind);
 // Créer (ou trouver, s'il existe déjà) un symbole de nom et indice donnés
 Mit_Symbole *mi_creer_symbole_nom (const Mit_Chaine *nom, unsigned ind);
 Mit_Symbole *mi_creer_symbole_chaine (const char *ch, unsigned ind);
+// ... le nom étant donné par nb octets; la chaine du nom n'est allouée
+// que pour un nouveau radical
+Mit_Symbole *mi_creer_symbole_octets (const char *oct, unsigned nb,
+                                      unsigned ind);
+// le clone reçoit un indice secondaire frais, déterministe: un indice
+// rendu par mi_radical_oublier_symbole, sinon le suivant du radical
 Mit_Symbole *mi_cloner_symbole (const Mit_Symbole *sy);
+/// à appeler par le ramasse-miettes sur chaque symbole secondaire
+/// libéré, pour l'ôter de son radical et recycler son indice
+void mi_radical_oublier_symbole (Mit_Symbole *sy);
+/// détruit des symboles nus que plus rien ne référence, en recyclant
+/// leurs indices et identifiants; la table tab est remise à NULL
+void mi_detruire_symboles (unsigned nb, Mit_Symbole **tab);
+
+/// les identifiants denses des symboles, donnés à leur création et
+/// recyclés après leur libération
+// le symbole d'identifiant donné, ou NULL
+Mit_Symbole *mi_symbole_par_ident (uint32_t id);
+// majorant strict des identifiants, pour dimensionner les tables
+// indexées par identifiant
+uint32_t mi_symbole_borne_ident (void);
+/// à appeler par le ramasse-miettes sur chaque symbole libéré, pour
+/// recycler son identifiant
+void mi_symbole_oublier_ident (Mit_Symbole *sy);
+
 void mi_afficher_contenu_symbole (FILE * fil, const Mit_Symbole *sy);
 
 #define mi_afficher_radicaux(Msg) \
   mi_afficher_radicaux_en(__FILE__, __LINE__, (Msg))
 void mi_afficher_radicaux_en (const char *fich, int lin, const char *msg);
+/// vérifier la table des symboles secondaires avec nb symboles d'un
+/// radical jetable, détruits ensuite
+void mi_verifier_secondaires (unsigned nb);
 
 /// itérer sur chaque symbole primaire
 void mi_iterer_symbole_primaire (mi_itersymb_sigt * f, void *client);
@@ -490,11 +980,45 @@ const Mit_Chaine*mi_radical_nom(const struct MiSt_Radical_st*rad);
 void mi_iterer_symbole_radical (const struct MiSt_Radical_st*, mi_itersymb_sigt * f,
                                 void *client);
 
+struct MiSt_Radical_st *mi_trouver_radical_octets (const char *oct,
+    unsigned nb);
+/// créer d'un coup les radicaux des nb noms (chacun de tablg[i]
+/// octets en tabnom[i]), qui devraient être triés, éventuellement avec
+/// des doublons; l'arbre des radicaux est alors reconstruit en bloc,
+/// sinon les noms sont insérés un par un. Si tabres est non nul, il
+/// reçoit le radical de chaque nom, ou NULL pour un nom illicite.
+void mi_creer_radicaux_tries (unsigned nb, const char *const *tabnom,
+                              const unsigned *tablg,
+                              struct MiSt_Radical_st **tabres);
 struct MiSt_Radical_st *mi_trouver_radical_apres_ou_egal(const char*ch);
 struct MiSt_Radical_st *mi_trouver_radical_apres(const char*ch);
 struct MiSt_Radical_st *mi_trouver_radical_avant_ou_egal(const char*ch);
 struct MiSt_Radical_st *mi_trouver_radical_avant(const char*ch);
 
+/// curseur sur les radicaux rangés par nom, qui avance ou recule le
+/// long des feuilles sans redescendre depuis la racine
+struct Mi_NoeudRadicaux_st;
+struct Mi_CurseurRadical_st
+{
+  struct Mi_NoeudRadicaux_st *cur_feuille;	// NULL quand fini
+  unsigned cur_pos;
+  const char *cur_prefixe;	// s'il est non nul, le parcours s'y limite
+  unsigned cur_lgprefixe;
+};
+// premier radical de nom au moins ch (ou le premier si ch est nul)
+bool mi_curseur_radical_debut (struct Mi_CurseurRadical_st *cur,
+                               const char *ch);
+// dernier radical de nom au plus ch (ou le dernier si ch est nul)
+bool mi_curseur_radical_fin (struct Mi_CurseurRadical_st *cur,
+                             const char *ch);
+// radicaux dont le nom commence par prefixe
+bool mi_curseur_radical_prefixe (struct Mi_CurseurRadical_st *cur,
+                                 const char *prefixe);
+struct MiSt_Radical_st *mi_curseur_radical (const struct Mi_CurseurRadical_st
+    *cur);
+bool mi_curseur_radical_suivant (struct Mi_CurseurRadical_st *cur);
+bool mi_curseur_radical_precedent (struct Mi_CurseurRadical_st *cur);
+
 const char *mi_symbole_chaine (const Mit_Symbole *sy);
 
 const Mit_Chaine *mi_symbole_nom (const Mit_Symbole *sy);
@@ -512,7 +1036,10 @@ mi_symbole_indice_ch (char tamp[16], const Mit_Symbole *sy)
 {
   unsigned i = mi_symbole_indice (sy);
   if (i)
-    snprintf (tamp, 16, "_%d", i);
+    {
+      tamp[0] = '_';
+      mi_naturel_en_chaine (tamp + 1, i);
+    }
   else
     tamp[0] = (char) 0;
   return tamp;
@@ -575,6 +1102,28 @@ typedef bool mi_vect_sigt (const Mit_Val va, unsigned ix, void *client);
 void mi_vecteur_iterer (const struct Mi_Vecteur_st *v, mi_vect_sigt * f,
                         void *client);
 
+/// le type abstrait des tampons d'octets
+struct MiCh_Tampon_st *mi_tampon_creer (size_t taille);
+/// projection d'un fichier par mmap, NULL avec errno en cas d'échec
+struct MiCh_Tampon_st *mi_tampon_projeter (const char *chemin);
+void mi_tampon_detruire (struct MiCh_Tampon_st *t);
+size_t mi_tampon_long (const struct MiCh_Tampon_st *t);
+const char *mi_tampon_octets (const struct MiCh_Tampon_st *t);
+void mi_tampon_reserver (struct MiCh_Tampon_st *t, size_t nb);
+void mi_tampon_ajouter (struct MiCh_Tampon_st *t, const void *oct, size_t nb);
+void mi_tampon_tronquer (struct MiCh_Tampon_st *t, size_t ln);
+/// vue sans copie d'au plus *plong octets (tout si plong est nul)
+const char *mi_tampon_tranche (const struct MiCh_Tampon_st *t, size_t deb,
+                               size_t *plong);
+const Mit_Chaine *mi_tampon_chaine (const struct MiCh_Tampon_st *t,
+                                    size_t deb, size_t ln);
+ssize_t mi_tampon_lire_fd (struct MiCh_Tampon_st *t, int fd, size_t nb);
+ssize_t mi_tampons_ecrire_fd (int fd, struct MiCh_Tampon_st *const *tabt,
+                              unsigned nb);
+ssize_t mi_tampon_ecrire_fd (const struct MiCh_Tampon_st *t, int fd);
+void mi_symbole_attacher_tampon (Mit_Symbole *sy, struct MiCh_Tampon_st *t);
+struct MiCh_Tampon_st *mi_symbole_tampon (const Mit_Symbole *sy);
+
 
 struct mi_cadre_appel_st
 {
@@ -606,6 +1155,7 @@ struct Mi_Sauvegarde_st		/* à allouer sur la pile */
   const char *sv_rep;		// repertoire de sauvegarde
   struct Mi_Queuesauve_st *sv_tet;	// tête des symboles à parcourir
   struct Mi_Queuesauve_st *sv_que;	// queue des symboles à parcourir
+  int sv_chiffdbl;		// chiffres nécessaires aux doubles du symbole écrit
 };
 void mi_sauvegarde_init (struct Mi_Sauvegarde_st *sv, const char *dir);
 
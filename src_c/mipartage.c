@@ -0,0 +1,233 @@
+// fichier mipartage.c - partage des tuples et ensembles égaux
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file mipartage.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// Les tuples et ensembles sont immuables; quand le partage est
+/// actif, deux tuples (ou deux ensembles) égaux sont la même valeur,
+/// trouvée dans une table de hashage par son hash et son contenu. La
+/// table est faible: elle ne garde pas ses valeurs en vie, et le
+/// ramasse-miettes doit appeler mi_partage_oublier sur celles qu'il
+/// libère. Les valeurs contenant un symbole détruit par
+/// mi_detruire_symboles sont oubliées avec lui.
+
+bool mi_partage_actif;
+
+#define MI_PARTAGE_TROU ((void*)MI_TROU_SYMBOLE)
+static struct
+{
+  unsigned pa_taille;		// taille de la table, un nombre premier
+  unsigned pa_compte;		// nombre de valeurs partagées
+  unsigned pa_trous;		// nombre de trous
+  Mit_Val *pa_table;
+} mi_partage;
+
+// le hash, la taille et les symboles d'un tuple ou d'un ensemble
+static inline void
+mi_partage_contenu (const Mit_Val v, unsigned *phash, unsigned *ptaille,
+                    Mit_Symbole * const **ptab)
+{
+  switch (mi_vtype (v))
+    {
+    case MiTy_Tuple:
+      *phash = v.miva_tup->mi_hash;
+      *ptaille = v.miva_tup->mi_taille;
+      *ptab = v.miva_tup->mi_composants;
+      return;
+    case MiTy_Ensemble:
+      *phash = v.miva_ens->mi_hash;
+      *ptaille = v.miva_ens->mi_taille;
+      *ptab = v.miva_ens->mi_elements;
+      return;
+    default:
+      MI_FATALPRINTF ("valeur non partageable @%p", v.miva_ptr);
+    }
+}				// fin mi_partage_contenu
+
+// la position de la valeur égale à v, ou de la place où la mettre
+static int
+mi_partage_pos (const Mit_Val v)
+{
+  unsigned h = 0, t = 0;
+  Mit_Symbole *const *tab = NULL;
+  mi_partage_contenu (v, &h, &t, &tab);
+  enum mi_typeval_en ty = mi_vtype (v);
+  unsigned ta = mi_partage.pa_taille;
+  assert (ta > 2 && mi_partage.pa_compte + mi_partage.pa_trous < ta);
+  int pos = -1;
+  unsigned ideb = h % ta;
+  for (unsigned n = 0; n < ta; n++)
+    {
+      unsigned ix = (ideb + n < ta) ? ideb + n : ideb + n - ta;
+      Mit_Val vc = mi_partage.pa_table[ix];
+      if (!vc.miva_ptr)
+        return (pos < 0) ? (int) ix : pos;
+      if (vc.miva_ptr == MI_PARTAGE_TROU)
+        {
+          if (pos < 0)
+            pos = (int) ix;
+          continue;
+        }
+      if (vc.miva_ptr == v.miva_ptr)
+        return (int) ix;
+      if (mi_vtype (vc) != ty)
+        continue;
+      unsigned hc = 0, tc = 0;
+      Mit_Symbole *const *tabc = NULL;
+      mi_partage_contenu (vc, &hc, &tc, &tabc);
+      if (hc == h && tc == t && !memcmp (tab, tabc, t * sizeof (Mit_Symbole *)))
+        return (int) ix;
+    }
+  return pos;
+}				// fin mi_partage_pos
+
+static void
+mi_partage_reorganiser (unsigned nb)
+{
+  unsigned anctaille = mi_partage.pa_taille;
+  Mit_Val *anctable = mi_partage.pa_table;
+  unsigned nouvtaille =
+    mi_nombre_premier_apres (2 * (mi_partage.pa_compte + nb) + 50);
+  if (!nouvtaille)
+    MI_FATALPRINTF ("trop de valeurs partagées (%u)", mi_partage.pa_compte);
+  Mit_Val *nouvtable = calloc (nouvtaille, sizeof (Mit_Val));
+  if (!nouvtable)
+    MI_FATALPRINTF ("impossible d'allouer la table de partage de %u (%s)",
+                    nouvtaille, strerror (errno));
+  mi_partage.pa_table = nouvtable;
+  mi_partage.pa_taille = nouvtaille;
+  mi_partage.pa_trous = 0;
+  for (unsigned ix = 0; ix < anctaille; ix++)
+    {
+      Mit_Val v = anctable[ix];
+      if (!v.miva_ptr || v.miva_ptr == MI_PARTAGE_TROU)
+        continue;
+      int pos = mi_partage_pos (v);
+      assert (pos >= 0 && !nouvtable[pos].miva_ptr);
+      nouvtable[pos] = v;
+    }
+  free (anctable);
+}				// fin mi_partage_reorganiser
+
+// renvoie la valeur partagée égale à la valeur fraîche, en libérant
+// celle-ci, ou bien enregistre la valeur fraîche
+static Mit_Val
+mi_partager (Mit_Val v)
+{
+  if (4 * (mi_partage.pa_compte + mi_partage.pa_trous + 1)
+      >= 3 * mi_partage.pa_taille)
+    mi_partage_reorganiser (1);
+  int pos = mi_partage_pos (v);
+  assert (pos >= 0);
+  Mit_Val vc = mi_partage.pa_table[pos];
+  if (vc.miva_ptr && vc.miva_ptr != MI_PARTAGE_TROU)
+    {
+      if (vc.miva_ptr != v.miva_ptr)
+        mi_liberer_valeur_fraiche (v.miva_ptr);
+      return vc;
+    }
+  if (vc.miva_ptr == MI_PARTAGE_TROU)
+    mi_partage.pa_trous--;
+  mi_partage.pa_table[pos] = v;
+  mi_partage.pa_compte++;
+  return v;
+}				// fin mi_partager
+
+const Mit_Tuple *
+mi_partager_tuple (Mit_Tuple * tu)
+{
+  assert (tu && tu->mi_type == MiTy_Tuple && tu->mi_hash != 0);
+  if (!mi_partage_actif || tu->mi_partage || tu->mi_taille == 0)
+    return tu;
+  const Mit_Tuple *tr = mi_partager (MI_TUPLEV (tu)).miva_tup;
+  if (tr == tu)
+    tu->mi_partage = true;
+  return tr;
+}				// fin mi_partager_tuple
+
+const Mit_Ensemble *
+mi_partager_ensemble (Mit_Ensemble * en)
+{
+  assert (en && en->mi_type == MiTy_Ensemble && en->mi_hash != 0);
+  // les ensembles compacts ne sont pas partagés
+  if (!mi_partage_actif || en->mi_partage || en->mi_taille == 0
+      || en->mi_compact)
+    return en;
+  const Mit_Ensemble *er = mi_partager (MI_ENSEMBLEV (en)).miva_ens;
+  if (er == en)
+    en->mi_partage = true;
+  return er;
+}				// fin mi_partager_ensemble
+
+void
+mi_partage_oublier (const Mit_Val v)
+{
+  bool partage = false;
+  switch (mi_vtype (v))
+    {
+    case MiTy_Tuple:
+      partage = v.miva_tup->mi_partage;
+      break;
+    case MiTy_Ensemble:
+      partage = v.miva_ens->mi_partage;
+      break;
+    default:
+      return;
+    }
+  if (!partage || !mi_partage.pa_table)
+    return;
+  int pos = mi_partage_pos (v);
+  if (pos >= 0 && mi_partage.pa_table[pos].miva_ptr == v.miva_ptr)
+    {
+      mi_partage.pa_table[pos].miva_ptr = MI_PARTAGE_TROU;
+      mi_partage.pa_compte--;
+      mi_partage.pa_trous++;
+    }
+  if (mi_vtype (v) == MiTy_Tuple)
+    ((Mit_Tuple *) v.miva_tup)->mi_partage = false;
+  else
+    ((Mit_Ensemble *) v.miva_ens)->mi_partage = false;
+}				// fin mi_partage_oublier
+
+void
+mi_partage_oublier_symboles (const struct Mi_EnsHash_st *eh)
+{
+  if (!eh || !mi_partage.pa_table || mi_partage.pa_compte == 0)
+    return;
+  for (unsigned ix = 0; ix < mi_partage.pa_taille; ix++)
+    {
+      Mit_Val v = mi_partage.pa_table[ix];
+      if (!v.miva_ptr || v.miva_ptr == MI_PARTAGE_TROU)
+        continue;
+      unsigned h = 0, t = 0;
+      Mit_Symbole *const *tab = NULL;
+      mi_partage_contenu (v, &h, &t, &tab);
+      for (unsigned iy = 0; iy < t; iy++)
+        if (mi_enshash_contient (eh, tab[iy]))
+          {
+            mi_partage_oublier (v);
+            break;
+          }
+    }
+}				// fin mi_partage_oublier_symboles
+
+unsigned
+mi_partage_compte (void)
+{
+  return mi_partage.pa_compte;
+}				// fin mi_partage_compte
@@ -35,6 +35,9 @@ enum
   xtraopt_apres,
   xtraopt_avantegal,
   xtraopt_avant,
+  xtraopt_affichagemax,
+  xtraopt_partager,
+  xtraopt_verifsecondaires,
   xtraopt__fin
 };
 
@@ -58,6 +61,10 @@ const struct option minil_options[] =
   {"apres", required_argument, NULL, xtraopt_apres},
   {"avant-egal", required_argument, NULL, xtraopt_avantegal},
   {"avant", required_argument, NULL, xtraopt_avant},
+  {"affichage-max", required_argument, NULL, xtraopt_affichagemax},
+  {"partager", no_argument, NULL, xtraopt_partager},
+  {"verifier-secondaires", required_argument, NULL,
+   xtraopt_verifsecondaires},
   {"version", no_argument, NULL, 'V'},
   {NULL, 0, NULL, 0}
 };
@@ -89,6 +96,11 @@ mi_usage (const char *nomprog)
   printf (" --apres <nom> #trouver le symbole après <nom>\n");
   printf (" --avant-egal <nom> #trouver le symbole avant ou égal au <nom>\n");
   printf (" --avant <nom> #trouver le symbole avant <nom>\n");
+  printf (" --affichage-max <octets> #limiter la longueur des affichages\n");
+  printf (" --partager #partager les tuples et ensembles égaux,"
+          " avant --charge\n");
+  printf (" --verifier-secondaires <nombre> #vérifier la table"
+          " des symboles secondaires\n");
   printf (" --version | -V #donne la version\n");
 }
 
@@ -303,6 +315,24 @@ mi_arguments_programme (int argc, char **argv)
         case xtraopt_lireboucle:
           mi_faut_lire_en_boucle = true;
           break;
+        case xtraopt_affichagemax:	// --affichage-max <octets>
+          if (optarg)
+            {
+              char *fin = NULL;
+              errno = 0;
+              long l = strtol (optarg, &fin, 10);
+              if (fin == optarg || *fin || errno || l < 0)
+                MI_FATALPRINTF ("mauvaise longueur d'affichage '%s'", optarg);
+              mi_affichage_max = (size_t) l;
+            }
+          break;
+        case xtraopt_partager:	// --partager
+          mi_partage_actif = true;
+          break;
+        case xtraopt_verifsecondaires:	// --verifier-secondaires <nombre>
+          if (optarg)
+            mi_verifier_secondaires ((unsigned) atol (optarg));
+          break;
         }
     }
 }				// fin de mi_arguments_programme
@@ -63,6 +63,42 @@ mi_allouer_valeur (enum mi_typeval_en typv, size_t tail)
   return ptr;
 }
 
+void
+mi_liberer_valeur_fraiche (void *ptr)
+{
+  if (!ptr)
+    return;
+  // la valeur fraîche est presque toujours la dernière allouée
+  for (unsigned ix = mi_mem.mm_nbval; ix > 0; ix--)
+    if (mi_mem.mm_vtab[ix - 1].miva_ptr == ptr)
+      {
+        mi_mem.mm_vtab[ix - 1] = mi_mem.mm_vtab[--mi_mem.mm_nbval];
+        mi_mem.mm_vtab[mi_mem.mm_nbval].miva_ptr = NULL;
+        free (ptr);
+        return;
+      }
+  MI_FATALPRINTF ("valeur @%p inconnue, impossible à libérer", ptr);
+}				// fin mi_liberer_valeur_fraiche
+
+void *
+mi_retrecir_valeur_fraiche (void *ptr, size_t tail)
+{
+  if (!ptr)
+    return NULL;
+  assert (tail >= sizeof (enum mi_typeval_en));
+  for (unsigned ix = mi_mem.mm_nbval; ix > 0; ix--)
+    if (mi_mem.mm_vtab[ix - 1].miva_ptr == ptr)
+      {
+        void *nouvptr = realloc (ptr, tail);
+        // un realloc qui réduit ne devrait pas échouer
+        if (!nouvptr)
+          return ptr;
+        mi_mem.mm_vtab[ix - 1].miva_ptr = nouvptr;
+        return nouvptr;
+      }
+  MI_FATALPRINTF ("valeur @%p inconnue, impossible à rétrécir", ptr);
+}				// fin mi_retrecir_valeur_fraiche
+
 struct Mi_RamMiett_st
 {
   unsigned rm_nmagic;
@@ -73,6 +109,12 @@ mi_marquer_valeur (struct Mi_RamMiett_st *rm, Mit_Val v)
 {
 }
 
+/// les tuples et ensembles libérés doivent être oubliés par
+/// mi_partage_oublier, car la table de partage est faible, et le
+/// cache des opérations d'ensembles vidé par mi_memo_ensembles_vider;
+/// les symboles libérés passent par mi_detruire_symboles, qui rend
+/// leur identifiant par mi_symbole_oublier_ident et ôte les
+/// secondaires de leur radical par mi_radical_oublier_symbole
 void
 mi_ramasse_miettes (struct mi_cadre_appel_st *cap)
 {
@@ -18,36 +18,34 @@
 
 #include "minil.h"
 
-// voir aussi https://www.cs.auckland.ac.nz/software/AlgAnim/red_black.html
-enum Mi_CouleurRadical_en
-{
-  crad__rien,
-  crad_noir,
-  crad_rouge
-};
-
 #define MI_RAD_NMAGIQ ((uint16_t)0x5fe7)	/*24551 */
 struct MiSt_ValeurRadical_st
 {
   Mit_Symbole *vrad_symbprim;
-  unsigned vrad_tailsec;
   unsigned vrad_nbsec;
-  Mit_Symbole **vrad_tabsecsym;
+  // les symboles secondaires, chaînés par mi_secprec & mi_secsuiv
+  Mit_Symbole *vrad_premsec;
+  Mit_Symbole *vrad_dersec;
+  // indices pour les clones: le prochain jamais utilisé, au moins
+  // MI_INDICE_CLONE_MIN, et une pile des indices rendus
+  unsigned vrad_prochind;
+  unsigned vrad_nblibres;
+  unsigned vrad_taillibres;
+  unsigned *vrad_indlibres;
 };
 
+#define MI_INDICE_CLONE_MIN 10
+
 struct MiSt_Radical_st
 {
   uint16_t urad_nmagiq;		/* toujours MI_RAD_NMAGIQ */
-  enum Mi_CouleurRadical_en urad_couleur;
-  struct MiSt_Radical_st *urad_parent;
-  struct MiSt_Radical_st *urad_gauche;
-  struct MiSt_Radical_st *urad_droit;
+  uint32_t urad_rang;		// croît avec le nom
+  struct Mi_NoeudRadicaux_st *urad_feuille;	// feuille le contenant
   const Mit_Chaine *urad_nom;	// la clef
+  unsigned urad_hash;		// mi_hashage_chaine du nom
   struct MiSt_ValeurRadical_st urad_val;
 };
 
-static struct MiSt_Radical_st *mi_racine_radical;
-
 // tester si une valeur chaine est licite pour un nom
 bool
 mi_nom_licite (const Mit_Chaine *nom)
@@ -63,24 +61,42 @@ mi_nom_licite_chaine (const char *ch)
 {
   if (!ch)
     return false;
-  if (!isalpha (ch[0]))
+  return mi_nom_licite_octets (ch, strlen (ch));
+}				// fin mi_nom_licite_chaine
+
+// tester si les nb octets en oct, sans nul final, forment un nom licite
+bool
+mi_nom_licite_octets (const char *oct, unsigned nb)
+{
+  if (!oct || nb == 0)
+    return false;
+  if (!isalpha (oct[0]))
     return false;
-  for (const char *pc = ch + 1; *pc; pc++)
-    if (!isalnum (*pc))
+  for (unsigned ix = 1; ix < nb; ix++)
+    if (!isalnum (oct[ix]))
       return false;
   return true;
-}				// fin mi_nom_licite_chaine
+}				// fin mi_nom_licite_octets
 
 // calcul du hash d'une chaine, généralement non nul
 unsigned
 mi_hashage_chaine (const char *ch)
+{
+  if (!ch)
+    return 0;
+  return mi_hashage_octets (ch, strlen (ch));
+}				// fin mi_hashage_chaine
+
+// le même hash, pour nb octets sans nul final
+unsigned
+mi_hashage_octets (const char *oct, unsigned nb)
 {
   unsigned h1 = 0, h2 = 0;
   unsigned rk = 0;
-  if (!ch || !ch[0])
+  if (!oct || nb == 0)
     return 0;
   /// lest constantes multiplicatives sont des nombres premiers
-  for (const char *pc = ch; *pc; pc++, rk++)
+  for (const char *pc = oct; rk < nb; pc++, rk++)
     {
       if (rk % 2)
         h1 = (h1 * 463) ^ (((unsigned char *) pc)[0] * 2027 + 5 * rk);
@@ -91,7 +107,7 @@ mi_hashage_chaine (const char *ch)
   if (!h)
     h = (h1 % 10039) + (h2 % 20047) + (rk % 30059) + 7;
   return h;
-}				// fin mi_hashage_chaine
+}				// fin mi_hashage_octets
 
 
 const char *
@@ -106,6 +122,16 @@ mi_symbole_chaine (const Mit_Symbole *sy)
   return nm->mi_car;
 }				/* fin mi_symbole_chaine */
 
+const Mit_Chaine *
+mi_symbole_nom (const Mit_Symbole *sy)
+{
+  if (!sy || sy->mi_type != MiTy_Symbole)
+    return NULL;
+  const struct MiSt_Radical_st *rad = sy->mi_radical;
+  assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
+  return rad->urad_nom;
+}				/* fin mi_symbole_nom */
+
 
 static const char *
 mi_radical_chaine (const struct MiSt_Radical_st *rad)
@@ -120,631 +146,1192 @@ mi_radical_chaine (const struct MiSt_Radical_st *rad)
   return nm->mi_car;
 }				// fin mi_radical_chaine */
 
-/// arbre rouge-noir pour les radicaux
-/// voir https://en.wikipedia.org/wiki/Red%E2%80%93black_tree
-/// et https://fr.wikipedia.org/wiki/Arbre_bicolore
+/// table de hachage des radicaux par nom, tenue à jour avec l'arbre
+/// B+ ci-dessous; elle sert aux recherches exactes, l'arbre
+/// restant utilisé pour les recherches ordonnées. Adressage ouvert à
+/// sondage linéaire, taille puissance de deux, remplie au plus à
+/// moitié; les radicaux ne sont jamais détruits.
+static struct
+{
+  unsigned hrad_nb;		// nombre de radicaux
+  unsigned hrad_taille;		// taille de hrad_tab, puissance de 2
+  struct MiSt_Radical_st **hrad_tab;
+} mi_hash_radicaux;
+
+// les hash des noms voisins ne diffèrent que par quelques bits, qu'il
+// faut mélanger avant de garder les bits de poids faible
+static inline unsigned
+mi_hash_radicaux_debut (unsigned h, unsigned masq)
+{
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+  return h & masq;
+}				/* fin mi_hash_radicaux_debut */
 
-struct MiSt_Radical_st *
-mi_trouver_radical (const Mit_Chaine *chn)
+static void
+mi_hash_radicaux_placer (struct MiSt_Radical_st **tab, unsigned taille,
+                         struct MiSt_Radical_st *rad)
 {
-  if (!chn || chn->mi_type != MiTy_Chaine)
-    return NULL;
-  if (!mi_nom_licite (chn))
+  unsigned masq = taille - 1;
+  for (unsigned ix = mi_hash_radicaux_debut (rad->urad_hash, masq);;
+       ix = (ix + 1) & masq)
+    if (!tab[ix])
+      {
+        tab[ix] = rad;
+        return;
+      }
+}				/* fin mi_hash_radicaux_placer */
+
+static void
+mi_hash_radicaux_reserver (unsigned nb)
+{
+  if (2 * (mi_hash_radicaux.hrad_nb + nb) > mi_hash_radicaux.hrad_taille)
+    {
+      unsigned nouvtail =
+        mi_hash_radicaux.hrad_taille ? 2 * mi_hash_radicaux.hrad_taille : 512;
+      while (2 * (mi_hash_radicaux.hrad_nb + nb) > nouvtail)
+        nouvtail *= 2;
+      struct MiSt_Radical_st **nouvtab =
+        calloc (nouvtail, sizeof (struct MiSt_Radical_st *));
+      if (!nouvtab)
+        MI_FATALPRINTF ("impossible d'agrandir la table des radicaux"
+                        " à %u (%s)", nouvtail, strerror (errno));
+      for (unsigned ix = 0; ix < mi_hash_radicaux.hrad_taille; ix++)
+        if (mi_hash_radicaux.hrad_tab[ix])
+          mi_hash_radicaux_placer (nouvtab, nouvtail,
+                                   mi_hash_radicaux.hrad_tab[ix]);
+      free (mi_hash_radicaux.hrad_tab);
+      mi_hash_radicaux.hrad_tab = nouvtab;
+      mi_hash_radicaux.hrad_taille = nouvtail;
+    }
+}				/* fin mi_hash_radicaux_reserver */
+
+static void
+mi_hash_radicaux_ajouter (struct MiSt_Radical_st *rad)
+{
+  assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ && rad->urad_hash != 0);
+  mi_hash_radicaux_reserver (1);
+  mi_hash_radicaux_placer (mi_hash_radicaux.hrad_tab,
+                           mi_hash_radicaux.hrad_taille, rad);
+  mi_hash_radicaux.hrad_nb++;
+}				/* fin mi_hash_radicaux_ajouter */
+
+// le nom de lg octets en ch, pas forcément terminé par un nul, de
+// hash h, doit être licite
+static struct MiSt_Radical_st *
+mi_hash_radicaux_chercher (const char *ch, unsigned lg, unsigned h)
+{
+  if (!mi_hash_radicaux.hrad_tab)
     return NULL;
-  struct MiSt_Radical_st *rad = mi_racine_radical;
-  while (rad)
+  unsigned masq = mi_hash_radicaux.hrad_taille - 1;
+  struct MiSt_Radical_st *rad = NULL;
+  for (unsigned ix = mi_hash_radicaux_debut (h, masq);
+       (rad = mi_hash_radicaux.hrad_tab[ix]) != NULL;
+       ix = (ix + 1) & masq)
     {
       assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (rad->urad_nom && rad->urad_nom->mi_type == MiTy_Chaine);
-      int cmp = (rad->urad_nom == chn) ? 0
-                : strcmp (chn->mi_car, rad->urad_nom->mi_car);
-      if (!cmp)
+      if (rad->urad_hash == h && rad->urad_nom->mi_taille == lg
+          && !memcmp (rad->urad_nom->mi_car, ch, lg))
         return rad;
-      if (cmp < 0)
-        rad = rad->urad_gauche;
-      else
-        rad = rad->urad_droit;
     }
   return NULL;
+}				/* fin mi_hash_radicaux_chercher */
+
+struct MiSt_Radical_st *
+mi_trouver_radical (const Mit_Chaine *chn)
+{
+  if (!chn || chn->mi_type != MiTy_Chaine)
+    return NULL;
+  if (!mi_nom_licite (chn))
+    return NULL;
+  return mi_hash_radicaux_chercher (chn->mi_car, chn->mi_taille,
+                                    chn->mi_hash);
 }				/* fin mi_trouver_radical */
 
 struct MiSt_Radical_st *
 mi_trouver_radical_chaine (const char *ch)
 {
-  if (!ch || !mi_nom_licite_chaine (ch))
+  if (!ch)
     return NULL;
+  return mi_trouver_radical_octets (ch, strlen (ch));
+}				/* fin mi_trouver_radical_chaine */
+
+struct MiSt_Radical_st *
+mi_trouver_radical_octets (const char *oct, unsigned nb)
+{
+  if (!mi_nom_licite_octets (oct, nb))
+    return NULL;
+  return mi_hash_radicaux_chercher (oct, nb, mi_hashage_octets (oct, nb));
+}				/* fin mi_trouver_radical_octets */
+
+/// Les radicaux sont rangés par nom dans un arbre B+: les noeuds
+/// internes ne contiennent que des séparateurs, tous les radicaux
+/// sont dans les feuilles, chaînées dans les deux sens. Chaque clef
+/// est accompagnée des huit premiers octets de son nom, en gros
+/// boutiste, pour que la plupart des comparaisons soient entre
+/// entiers. Chaque radical connaît sa feuille.
+#define MI_RADICAUX_ORDRE 32	// nombre maximal de clefs par noeud
+#define MI_NOEUDRAD_NMAGIQ ((uint16_t)0x2c6b)	/*11371 */
+struct Mi_NoeudRadicaux_st
+{
+  uint16_t nrad_nmagiq;		/* toujours MI_NOEUDRAD_NMAGIQ */
+  bool nrad_feuille;
+  bool nrad_tranche;		// alloué dans une tranche
+  uint16_t nrad_nb;		// nombre de clefs
+  struct Mi_NoeudRadicaux_st *nrad_parent;
+  struct Mi_NoeudRadicaux_st *nrad_prec;	// feuilles seulement
+  struct Mi_NoeudRadicaux_st *nrad_suiv;	// feuilles seulement
+  uint64_t nrad_pref[MI_RADICAUX_ORDRE];
+  // dans une feuille, les radicaux; dans un noeud interne, nrad_cle[i]
+  // est le plus petit radical sous nrad_fils[i+1]
+  struct MiSt_Radical_st *nrad_cle[MI_RADICAUX_ORDRE];
+  struct Mi_NoeudRadicaux_st *nrad_fils[];	// noeuds internes seulement
+};
 
-  struct MiSt_Radical_st *rad = mi_racine_radical;
-  while (rad)
+static struct Mi_NoeudRadicaux_st *mi_racine_radicaux;
+static struct Mi_NoeudRadicaux_st *mi_premiere_feuille_radicaux;
+static struct Mi_NoeudRadicaux_st *mi_derniere_feuille_radicaux;
+
+static inline uint64_t
+mi_prefixe_nom (const char *ch)
+{
+  uint64_t p = 0;
+  int ix = 0;
+  for (; ix < 8 && ch[ix]; ix++)
+    p = (p << 8) | ((const unsigned char *) ch)[ix];
+  for (; ix < 8; ix++)
+    p <<= 8;
+  return p;
+}				/* fin mi_prefixe_nom */
+
+// compare le nom ch, de préfixe pch, au radical rad de préfixe pr
+static inline int
+mi_comparer_nom_radical (const char *ch, uint64_t pch,
+                         const struct MiSt_Radical_st *rad, uint64_t pr)
+{
+  if (pch != pr)
+    return (pch < pr) ? -1 : 1;
+  if ((pch & 0xff) == 0)	// les deux noms tiennent dans le préfixe
+    return 0;
+  return strcmp (ch + 8, rad->urad_nom->mi_car + 8);
+}				/* fin mi_comparer_nom_radical */
+
+static struct Mi_NoeudRadicaux_st *
+mi_creer_noeud_radicaux (bool feuille)
+{
+  size_t tail = sizeof (struct Mi_NoeudRadicaux_st)
+                + (feuille ? 0 : (MI_RADICAUX_ORDRE + 1)
+                   * sizeof (struct Mi_NoeudRadicaux_st *));
+  struct Mi_NoeudRadicaux_st *nd = calloc (1, tail);
+  if (!nd)
+    MI_FATALPRINTF ("impossible d'allouer un noeud de radicaux (%s)",
+                    strerror (errno));
+  nd->nrad_nmagiq = MI_NOEUDRAD_NMAGIQ;
+  nd->nrad_feuille = feuille;
+  return nd;
+}				/* fin mi_creer_noeud_radicaux */
+
+// descendre jusqu'à la feuille qui contiendrait le nom ch
+static struct Mi_NoeudRadicaux_st *
+mi_feuille_radicaux (const char *ch, uint64_t pch)
+{
+  struct Mi_NoeudRadicaux_st *nd = mi_racine_radicaux;
+  while (nd && !nd->nrad_feuille)
     {
-      assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (rad->urad_nom && rad->urad_nom->mi_type == MiTy_Chaine);
-      int cmp = strcmp (ch, rad->urad_nom->mi_car);
-      if (!cmp)
-        return rad;
-      if (cmp < 0)
-        rad = rad->urad_gauche;
-      else
-        rad = rad->urad_droit;
+      assert (nd->nrad_nmagiq == MI_NOEUDRAD_NMAGIQ);
+      unsigned ix = 0;
+      while (ix < nd->nrad_nb
+             && mi_comparer_nom_radical (ch, pch, nd->nrad_cle[ix],
+                                         nd->nrad_pref[ix]) >= 0)
+        ix++;
+      nd = nd->nrad_fils[ix];
     }
-  return NULL;
-}				/* fin mi_trouver_radical_chaine */
+  return nd;
+}				/* fin mi_feuille_radicaux */
 
+// positionne le curseur sur le premier radical de nom supérieur (ou
+// égal si egal est vrai) au nom ch
+static void
+mi_curseur_radical_borne (struct Mi_CurseurRadical_st *cur, const char *ch,
+                          bool egal)
+{
+  uint64_t pch = mi_prefixe_nom (ch);
+  struct Mi_NoeudRadicaux_st *fe = mi_feuille_radicaux (ch, pch);
+  unsigned ix = 0;
+  if (fe)
+    for (; ix < fe->nrad_nb; ix++)
+      {
+        int cmp = mi_comparer_nom_radical (ch, pch, fe->nrad_cle[ix],
+                                           fe->nrad_pref[ix]);
+        if (cmp < 0 || (egal && cmp == 0))
+          break;
+      }
+  if (fe && ix >= fe->nrad_nb)
+    {
+      fe = fe->nrad_suiv;
+      ix = 0;
+    }
+  cur->cur_feuille = fe;
+  cur->cur_pos = ix;
+}				/* fin mi_curseur_radical_borne */
+
+static inline bool
+mi_curseur_radical_dans_prefixe (const struct Mi_CurseurRadical_st *cur)
+{
+  if (!cur->cur_feuille)
+    return false;
+  if (!cur->cur_prefixe)
+    return true;
+  const struct MiSt_Radical_st *rad = cur->cur_feuille->nrad_cle[cur->cur_pos];
+  return !strncmp (rad->urad_nom->mi_car, cur->cur_prefixe,
+                   cur->cur_lgprefixe);
+}				/* fin mi_curseur_radical_dans_prefixe */
+
+/// positionner le curseur sur le premier radical de nom au moins ch,
+/// ou sur le premier radical si ch est nul
+bool
+mi_curseur_radical_debut (struct Mi_CurseurRadical_st *cur, const char *ch)
+{
+  if (!cur)
+    return false;
+  memset (cur, 0, sizeof (*cur));
+  if (ch)
+    mi_curseur_radical_borne (cur, ch, true);
+  else
+    cur->cur_feuille = mi_premiere_feuille_radicaux;
+  return cur->cur_feuille != NULL;
+}				/* fin mi_curseur_radical_debut */
 
+/// positionner le curseur sur le dernier radical de nom au plus ch,
+/// ou sur le dernier radical si ch est nul
+bool
+mi_curseur_radical_fin (struct Mi_CurseurRadical_st *cur, const char *ch)
+{
+  if (!cur)
+    return false;
+  memset (cur, 0, sizeof (*cur));
+  if (ch)
+    mi_curseur_radical_borne (cur, ch, false);
+  if (cur->cur_feuille)
+    return mi_curseur_radical_precedent (cur);
+  cur->cur_feuille = mi_derniere_feuille_radicaux;
+  if (cur->cur_feuille)
+    cur->cur_pos = cur->cur_feuille->nrad_nb - 1;
+  return cur->cur_feuille != NULL;
+}				/* fin mi_curseur_radical_fin */
+
+/// positionner le curseur sur le premier radical dont le nom commence
+/// par prefixe; le curseur s'arrête après le dernier tel radical.
+/// La chaîne prefixe doit rester valide pendant le parcours.
+bool
+mi_curseur_radical_prefixe (struct Mi_CurseurRadical_st *cur,
+                            const char *prefixe)
+{
+  if (!cur || !prefixe)
+    return false;
+  mi_curseur_radical_debut (cur, prefixe);
+  cur->cur_prefixe = prefixe;
+  cur->cur_lgprefixe = strlen (prefixe);
+  if (!mi_curseur_radical_dans_prefixe (cur))
+    cur->cur_feuille = NULL;
+  return cur->cur_feuille != NULL;
+}				/* fin mi_curseur_radical_prefixe */
+
+/// le radical sous le curseur, ou NULL si le parcours est fini
 struct MiSt_Radical_st *
-mi_trouver_radical_apres_ou_egal (const char *ch)
+mi_curseur_radical (const struct Mi_CurseurRadical_st *cur)
 {
-  if (!ch)
+  if (!cur || !cur->cur_feuille)
     return NULL;
-  MI_DEBOPRINTF ("ch=%s", ch);
-  struct MiSt_Radical_st *rad = mi_racine_radical;
-  while (rad)
+  assert (cur->cur_feuille->nrad_nmagiq == MI_NOEUDRAD_NMAGIQ);
+  assert (cur->cur_pos < cur->cur_feuille->nrad_nb);
+  return cur->cur_feuille->nrad_cle[cur->cur_pos];
+}				/* fin mi_curseur_radical */
+
+/// avancer le curseur; faux quand le parcours est fini
+bool
+mi_curseur_radical_suivant (struct Mi_CurseurRadical_st *cur)
+{
+  if (!cur || !cur->cur_feuille)
+    return false;
+  if (++cur->cur_pos >= cur->cur_feuille->nrad_nb)
     {
-      assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (rad->urad_nom && rad->urad_nom->mi_type == MiTy_Chaine);
-      int cmp = strcmp (ch, rad->urad_nom->mi_car);
-      MI_DEBOPRINTF ("ch=%s rad@%p:%s cmp=%d", ch,
-                     rad, rad->urad_nom->mi_car, cmp);
-      if (cmp == 0)
-        return rad;
-      if (cmp < 0)
-        {
-          if (rad->urad_gauche != NULL)
-            {
-              rad = rad->urad_gauche;
-              continue;
-            }
-          else
-            {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s fini", ch, rad,
-                             rad->urad_nom->mi_car);
-              return rad;
-            }
-        }
-      else			// cmp > 0
-        {
-          if (rad->urad_droit != NULL)
-            {
-              rad = rad->urad_droit;
-              continue;
-            }
-          else
-            {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s feuille", ch, rad,
-                             rad->urad_nom->mi_car);
-              while (rad->urad_parent != NULL)
-                {
-                  struct MiSt_Radical_st *parad = rad->urad_parent;
-                  int pacmp = strcmp (ch, parad->urad_nom->mi_car);
-                  MI_DEBOPRINTF ("ch=%s rad@%p:%s parad@%p:%s pacmp=%d",
-                                 ch,
-                                 rad, rad->urad_nom->mi_car,
-                                 parad, parad->urad_nom->mi_car, pacmp);
-                  if (pacmp < 0)
-                    {
-                      MI_DEBOPRINTF ("ch=%s donne parad@%p:%s", ch,
-                                     parad, parad->urad_nom->mi_car);
-                      return parad;
-                    }
-                  rad = parad;
-                }
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s finfeuille", ch, rad,
-                             rad->urad_nom->mi_car);
+      cur->cur_feuille = cur->cur_feuille->nrad_suiv;
+      cur->cur_pos = 0;
+    }
+  if (!mi_curseur_radical_dans_prefixe (cur))
+    cur->cur_feuille = NULL;
+  return cur->cur_feuille != NULL;
+}				/* fin mi_curseur_radical_suivant */
 
-              return rad;
-            }
-        }
+/// reculer le curseur; faux quand le parcours est fini
+bool
+mi_curseur_radical_precedent (struct Mi_CurseurRadical_st *cur)
+{
+  if (!cur || !cur->cur_feuille)
+    return false;
+  if (cur->cur_pos == 0)
+    {
+      cur->cur_feuille = cur->cur_feuille->nrad_prec;
+      if (cur->cur_feuille)
+        cur->cur_pos = cur->cur_feuille->nrad_nb;
     }
-  MI_DEBOPRINTF ("ch=%s échec", ch);
-  return NULL;
-}				/* fin mi_trouver_radical_apres_ou_egal */
+  if (cur->cur_feuille)
+    cur->cur_pos--;
+  if (!mi_curseur_radical_dans_prefixe (cur))
+    cur->cur_feuille = NULL;
+  return cur->cur_feuille != NULL;
+}				/* fin mi_curseur_radical_precedent */
 
 struct MiSt_Radical_st *
-mi_trouver_radical_apres (const char *ch)
+mi_trouver_radical_apres_ou_egal (const char *ch)
 {
   if (!ch)
     return NULL;
-  MI_DEBOPRINTF ("ch=%s", ch);
-  struct MiSt_Radical_st *rad = mi_racine_radical;
-  while (rad)
-    {
-      assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (rad->urad_nom && rad->urad_nom->mi_type == MiTy_Chaine);
-      int cmp = strcmp (ch, rad->urad_nom->mi_car);
-      MI_DEBOPRINTF ("ch=%s rad@%p:%s cmp=%d", ch,
-                     rad, rad->urad_nom->mi_car, cmp);
-      if (cmp < 0)
-        {
-          if (rad->urad_gauche != NULL)
-            {
-              rad = rad->urad_gauche;
-              continue;
-            }
-          else
-            {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s fini", ch, rad,
-                             rad->urad_nom->mi_car);
-              return rad;
-            }
-        }
-      else			// cmp >= 0
-        {
-          if (rad->urad_droit != NULL)
-            {
-              rad = rad->urad_droit;
-              continue;
-            }
-          else
-            {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s feuille", ch, rad,
-                             rad->urad_nom->mi_car);
-              while (rad->urad_parent != NULL)
-                {
-                  struct MiSt_Radical_st *parad = rad->urad_parent;
-                  int pacmp = strcmp (ch, parad->urad_nom->mi_car);
-                  MI_DEBOPRINTF ("ch=%s rad@%p:%s parad@%p:%s pacmp=%d",
-                                 ch,
-                                 rad, rad->urad_nom->mi_car,
-                                 parad, parad->urad_nom->mi_car, pacmp);
-                  if (pacmp < 0)
-                    {
-                      MI_DEBOPRINTF ("ch=%s donne parad@%p:%s", ch,
-                                     parad, parad->urad_nom->mi_car);
-                      return parad;
-                    }
-                  rad = parad;
-                }
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s finfeuille", ch, rad,
-                             rad->urad_nom->mi_car);
-
-              return rad;
-            }
-        }
-    }
-  MI_DEBOPRINTF ("ch=%s échec", ch);
-  return NULL;
+  struct Mi_CurseurRadical_st cur;
+  mi_curseur_radical_debut (&cur, ch);
+  return mi_curseur_radical (&cur);
 }				/* fin mi_trouver_radical_apres_ou_egal */
 
+struct MiSt_Radical_st *
+mi_trouver_radical_apres (const char *ch)
+{
+  if (!ch)
+    return NULL;
+  struct Mi_CurseurRadical_st cur;
+  memset (&cur, 0, sizeof (cur));
+  mi_curseur_radical_borne (&cur, ch, false);
+  return mi_curseur_radical (&cur);
+}				/* fin mi_trouver_radical_apres */
 
 struct MiSt_Radical_st *
 mi_trouver_radical_avant_ou_egal (const char *ch)
 {
   if (!ch)
     return NULL;
-  MI_DEBOPRINTF ("ch=%s", ch);
-  struct MiSt_Radical_st *rad = mi_racine_radical;
-  while (rad)
-    {
-      assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (rad->urad_nom && rad->urad_nom->mi_type == MiTy_Chaine);
-      int cmp = strcmp (ch, rad->urad_nom->mi_car);
-      MI_DEBOPRINTF ("ch=%s rad@%p:%s cmp=%d", ch,
-                     rad, rad->urad_nom->mi_car, cmp);
-      if (cmp == 0)
-        return rad;
-      if (cmp > 0)
-        {
-          if (rad->urad_droit != NULL)
-            {
-              rad = rad->urad_droit;
-              continue;
-            }
-          else
-            {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s fini", ch, rad,
-                             rad->urad_nom->mi_car);
-              return rad;
-            }
-        }
-      else			// cmp < 0
-        {
-          if (rad->urad_gauche != NULL)
-            {
-              rad = rad->urad_gauche;
-              continue;
-            }
-          else
-            {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s feuille", ch, rad,
-                             rad->urad_nom->mi_car);
-              while (rad->urad_parent != NULL)
-                {
-                  struct MiSt_Radical_st *parad = rad->urad_parent;
-                  int pacmp = strcmp (ch, parad->urad_nom->mi_car);
-                  MI_DEBOPRINTF ("ch=%s rad@%p:%s parad@%p:%s pacmp=%d",
-                                 ch,
-                                 rad, rad->urad_nom->mi_car,
-                                 parad, parad->urad_nom->mi_car, pacmp);
-                  if (pacmp > 0)
-                    {
-                      MI_DEBOPRINTF ("ch=%s donne parad@%p:%s", ch,
-                                     parad, parad->urad_nom->mi_car);
-                      return parad;
-                    }
-                  rad = parad;
-                }
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s finfeuille", ch, rad,
-                             rad->urad_nom->mi_car);
-
-              return rad;
-            }
-        }
-    }
-  MI_DEBOPRINTF ("ch=%s échec", ch);
-  return NULL;
+  struct Mi_CurseurRadical_st cur;
+  mi_curseur_radical_fin (&cur, ch);
+  return mi_curseur_radical (&cur);
 }				/* fin mi_trouver_radical_avant_ou_egal */
 
-
 struct MiSt_Radical_st *
 mi_trouver_radical_avant (const char *ch)
 {
   if (!ch)
     return NULL;
-  MI_DEBOPRINTF ("ch=%s", ch);
-  struct MiSt_Radical_st *rad = mi_racine_radical;
-  while (rad)
+  struct Mi_CurseurRadical_st cur;
+  memset (&cur, 0, sizeof (cur));
+  mi_curseur_radical_borne (&cur, ch, true);
+  if (cur.cur_feuille)
+    mi_curseur_radical_precedent (&cur);
+  else if ((cur.cur_feuille = mi_derniere_feuille_radicaux) != NULL)
+    cur.cur_pos = cur.cur_feuille->nrad_nb - 1;
+  return mi_curseur_radical (&cur);
+}				/* fin mi_trouver_radical_avant */
+
+
+// rad est mis à zéro, par calloc
+static void
+mi_initialiser_radical (struct MiSt_Radical_st *rad, const Mit_Chaine *ch)
+{
+  assert (ch != NULL && ch->mi_type == MiTy_Chaine);
+  assert (mi_nom_licite (ch));
+  rad->urad_nmagiq = MI_RAD_NMAGIQ;
+  rad->urad_nom = ch;
+  rad->urad_hash = ch->mi_hash;
+  rad->urad_feuille = NULL;
+  MI_DEBOPRINTF ("rad@%p ch@%p'%s'", rad, ch, ch->mi_car);
+}				/* fin mi_initialiser_radical */
+
+static struct MiSt_Radical_st *
+mi_creer_radical (const Mit_Chaine *ch)
+{
+  struct MiSt_Radical_st *rad = calloc (1, sizeof (struct MiSt_Radical_st));
+  if (!rad)
     {
-      assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (rad->urad_nom && rad->urad_nom->mi_type == MiTy_Chaine);
-      int cmp = strcmp (ch, rad->urad_nom->mi_car);
-      MI_DEBOPRINTF ("ch=%s rad@%p:%s cmp=%d", ch,
-                     rad, rad->urad_nom->mi_car, cmp);
-      if (cmp > 0)
+      perror ("mi_creer_radical");
+      exit (EXIT_FAILURE);
+    };
+  mi_initialiser_radical (rad, ch);
+  return rad;
+}				/* fin mi_creer_radical */
+
+/// Les rangs des radicaux maintiennent l'ordre de leurs noms: un
+/// radical inséré entre deux autres prend le milieu de leurs rangs,
+/// et un radical ajouté à une extrémité s'en écarte de MI_RANG_PAS.
+/// Quand il n'y a plus de place, on renumérote un voisinage de plus
+/// en plus grand, au pire tous les radicaux. Les rangs 0 et
+/// UINT32_MAX ne sont jamais donnés et servent de bornes.
+#define MI_RANG_PAS 0x10000
+#define MI_RANG_ECART_MIN 8
+unsigned long mi_generation_rangs;
+
+
+static struct MiSt_Radical_st *
+mi_radical_suivant (const struct MiSt_Radical_st *rad)
+{
+  const struct Mi_NoeudRadicaux_st *fe = rad->urad_feuille;
+  assert (fe && fe->nrad_nmagiq == MI_NOEUDRAD_NMAGIQ && fe->nrad_feuille);
+  unsigned ix = 0;
+  while (fe->nrad_cle[ix] != rad)
+    ix++;
+  if (ix + 1 < fe->nrad_nb)
+    return fe->nrad_cle[ix + 1];
+  return fe->nrad_suiv ? fe->nrad_suiv->nrad_cle[0] : NULL;
+}				/* fin mi_radical_suivant */
+
+static struct MiSt_Radical_st *
+mi_radical_precedent (const struct MiSt_Radical_st *rad)
+{
+  const struct Mi_NoeudRadicaux_st *fe = rad->urad_feuille;
+  assert (fe && fe->nrad_nmagiq == MI_NOEUDRAD_NMAGIQ && fe->nrad_feuille);
+  unsigned ix = 0;
+  while (fe->nrad_cle[ix] != rad)
+    ix++;
+  if (ix > 0)
+    return fe->nrad_cle[ix - 1];
+  return fe->nrad_prec ? fe->nrad_prec->nrad_cle[fe->nrad_prec->nrad_nb - 1]
+         : NULL;
+}				/* fin mi_radical_precedent */
+
+// le rang est recopié dans les symboles du radical
+static void
+mi_radical_mettre_rang (struct MiSt_Radical_st *rad, uint32_t rang)
+{
+  rad->urad_rang = rang;
+  if (rad->urad_val.vrad_symbprim)
+    rad->urad_val.vrad_symbprim->mi_rang = rang;
+  for (Mit_Symbole * sy = rad->urad_val.vrad_premsec; sy; sy = sy->mi_secsuiv)
+    sy->mi_rang = rang;
+}				/* fin mi_radical_mettre_rang */
+
+// renumérote la plus petite fenêtre autour de radz, en doublant sa
+// taille, dont les bornes laissent assez de place
+static void
+mi_radical_renumeroter (struct MiSt_Radical_st *radz)
+{
+  struct MiSt_Radical_st *g = radz, *d = radz;
+  unsigned long nb = 1;
+  for (;;)
+    {
+      struct MiSt_Radical_st *avant = mi_radical_precedent (g);
+      struct MiSt_Radical_st *apres = mi_radical_suivant (d);
+      uint32_t bas = avant ? avant->urad_rang : 0;
+      uint32_t haut = apres ? apres->urad_rang : UINT32_MAX;
+      if ((haut - bas) / (nb + 1) >= MI_RANG_ECART_MIN
+          || (!avant && !apres && (haut - bas) / (nb + 1) >= 1))
         {
-          if (rad->urad_droit != NULL)
-            {
-              rad = rad->urad_droit;
-              continue;
-            }
-          else
+          uint32_t pas = (haut - bas) / (nb + 1);
+          uint32_t r = bas;
+          for (struct MiSt_Radical_st * rad = g;; rad = mi_radical_suivant (rad))
             {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s fini", ch, rad,
-                             rad->urad_nom->mi_car);
-              return rad;
+              r += pas;
+              mi_radical_mettre_rang (rad, r);
+              if (rad == d)
+                break;
             }
+          mi_generation_rangs++;
+          return;
         }
-      else			// cmp <= 0
+      if (!avant && !apres)
+        MI_FATALPRINTF ("trop de radicaux (%lu) pour les numéroter", nb);
+      // doubler la fenêtre, moitié de chaque côté
+      for (unsigned long n = (nb + 1) / 2; n > 0 && avant; n--)
         {
-          if (rad->urad_gauche != NULL)
-            {
-              rad = rad->urad_gauche;
-              continue;
-            }
-          else
-            {
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s feuille", ch, rad,
-                             rad->urad_nom->mi_car);
-              while (rad->urad_parent != NULL)
-                {
-                  struct MiSt_Radical_st *parad = rad->urad_parent;
-                  int pacmp = strcmp (ch, parad->urad_nom->mi_car);
-                  MI_DEBOPRINTF ("ch=%s rad@%p:%s parad@%p:%s pacmp=%d",
-                                 ch,
-                                 rad, rad->urad_nom->mi_car,
-                                 parad, parad->urad_nom->mi_car, pacmp);
-                  if (pacmp > 0)
-                    {
-                      MI_DEBOPRINTF ("ch=%s donne parad@%p:%s", ch,
-                                     parad, parad->urad_nom->mi_car);
-                      return parad;
-                    }
-                  rad = parad;
-                }
-              MI_DEBOPRINTF ("ch=%s rad@%p:%s finfeuille", ch, rad,
-                             rad->urad_nom->mi_car);
-
-              return rad;
-            }
+          g = avant;
+          nb++;
+          avant = mi_radical_precedent (g);
+        }
+      for (unsigned long n = (nb + 1) / 2; n > 0 && apres; n--)
+        {
+          d = apres;
+          nb++;
+          apres = mi_radical_suivant (d);
         }
     }
-  MI_DEBOPRINTF ("ch=%s échec", ch);
-  return NULL;
-}				/* fin mi_trouver_radical_avant_ou_egal */
+}				/* fin mi_radical_renumeroter */
 
-
-
-static inline bool
-mi_radical_rouge (const struct MiSt_Radical_st *rad)
+// donne un rang au radical radz qui vient d'être inséré dans l'arbre
+static void
+mi_radical_numeroter (struct MiSt_Radical_st *radz)
 {
-  if (!rad)
-    return false;
-  assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-  assert (rad->urad_couleur != crad__rien);
-  return rad->urad_couleur == crad_rouge;
-}				/* fin mi_radical_rouge */
+  const struct MiSt_Radical_st *avant = mi_radical_precedent (radz);
+  const struct MiSt_Radical_st *apres = mi_radical_suivant (radz);
+  uint32_t bas = avant ? avant->urad_rang : 0;
+  uint32_t haut = apres ? apres->urad_rang : UINT32_MAX;
+  if (!apres && haut - bas > MI_RANG_PAS)
+    mi_radical_mettre_rang (radz, bas + MI_RANG_PAS);
+  else if (!avant && haut - bas > MI_RANG_PAS)
+    mi_radical_mettre_rang (radz, haut - MI_RANG_PAS);
+  else if (haut - bas >= 2)
+    mi_radical_mettre_rang (radz, bas + (haut - bas) / 2);
+  else
+    mi_radical_renumeroter (radz);
+}				/* fin mi_radical_numeroter */
 
-static inline bool
-mi_radical_noir (const struct MiSt_Radical_st *rad)
+// place la clef rad, de préfixe pr, à la position ix du noeud nd non
+// plein; dans un noeud interne, fils devient le fils à droite de rad
+static void
+mi_noeud_radicaux_placer (struct Mi_NoeudRadicaux_st *nd, unsigned ix,
+                          struct MiSt_Radical_st *rad, uint64_t pr,
+                          struct Mi_NoeudRadicaux_st *fils)
 {
-  if (!rad)
-    return true;
-  assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-  assert (rad->urad_couleur != crad__rien);
-  return rad->urad_couleur == crad_noir;
-}				/* fin mi_radical_noir */
-
-static inline enum Mi_CouleurRadical_en
-mi_couleur_opposee (enum Mi_CouleurRadical_en c)
+  unsigned nb = nd->nrad_nb;
+  assert (nb < MI_RADICAUX_ORDRE && ix <= nb);
+  memmove (nd->nrad_pref + ix + 1, nd->nrad_pref + ix,
+           (nb - ix) * sizeof (uint64_t));
+  memmove (nd->nrad_cle + ix + 1, nd->nrad_cle + ix,
+           (nb - ix) * sizeof (struct MiSt_Radical_st *));
+  nd->nrad_pref[ix] = pr;
+  nd->nrad_cle[ix] = rad;
+  if (nd->nrad_feuille)
+    rad->urad_feuille = nd;
+  else
+    {
+      memmove (nd->nrad_fils + ix + 2, nd->nrad_fils + ix + 1,
+               (nb - ix) * sizeof (struct Mi_NoeudRadicaux_st *));
+      nd->nrad_fils[ix + 1] = fils;
+      fils->nrad_parent = nd;
+    }
+  nd->nrad_nb = nb + 1;
+}				/* fin mi_noeud_radicaux_placer */
+
+// coupe en deux le noeud plein nd, dont la moitié gauche garde
+// MI_RADICAUX_ORDRE/2 clefs; renvoie le nouveau noeud droit et met
+// dans *psep et *ppr la clef séparatrice à remonter au parent
+static struct Mi_NoeudRadicaux_st *
+mi_noeud_radicaux_couper (struct Mi_NoeudRadicaux_st *nd,
+                          struct MiSt_Radical_st **psep, uint64_t *ppr)
 {
-  assert (c != crad__rien);
-  return (c == crad_rouge) ? crad_noir : crad_rouge;
-}				/* fin mi_couleur_opposee */
-
-
-// suivant le livre de Cormen, Leiserson, Rivest, Stein
-// Algorithmique (3e edition)
-static void
-mi_radical_rotation_gauche (struct MiSt_Radical_st *radx)
-{
-  assert (radx && radx->urad_nmagiq == MI_RAD_NMAGIQ);
-  struct MiSt_Radical_st *rady = radx->urad_droit;
-  assert (rady && rady->urad_nmagiq == MI_RAD_NMAGIQ);
-  radx->urad_droit = rady->urad_gauche;
-  if (rady->urad_gauche != NULL)
-    rady->urad_gauche->urad_parent = radx;
-  rady->urad_parent = radx->urad_parent;
-  if (radx->urad_parent == NULL)
-    mi_racine_radical = rady;
-  else if (radx == radx->urad_parent->urad_gauche)
-    radx->urad_parent->urad_gauche = rady;
+  assert (nd->nrad_nb == MI_RADICAUX_ORDRE);
+  const unsigned moit = MI_RADICAUX_ORDRE / 2;
+  struct Mi_NoeudRadicaux_st *nv = mi_creer_noeud_radicaux (nd->nrad_feuille);
+  if (nd->nrad_feuille)
+    {
+      unsigned nbd = MI_RADICAUX_ORDRE - moit;
+      memcpy (nv->nrad_pref, nd->nrad_pref + moit, nbd * sizeof (uint64_t));
+      memcpy (nv->nrad_cle, nd->nrad_cle + moit,
+              nbd * sizeof (struct MiSt_Radical_st *));
+      for (unsigned ix = 0; ix < nbd; ix++)
+        nv->nrad_cle[ix]->urad_feuille = nv;
+      nv->nrad_nb = nbd;
+      nv->nrad_suiv = nd->nrad_suiv;
+      if (nv->nrad_suiv)
+        nv->nrad_suiv->nrad_prec = nv;
+      else
+        mi_derniere_feuille_radicaux = nv;
+      nv->nrad_prec = nd;
+      nd->nrad_suiv = nv;
+      *psep = nv->nrad_cle[0];
+      *ppr = nv->nrad_pref[0];
+    }
   else
-    radx->urad_parent->urad_droit = rady;
-  rady->urad_gauche = radx;
-  radx->urad_parent = rady;
-}				/* fin mi_radical_rotation_gauche */
+    {
+      // la clef du milieu remonte et ne reste dans aucun des deux
+      unsigned nbd = MI_RADICAUX_ORDRE - moit - 1;
+      *psep = nd->nrad_cle[moit];
+      *ppr = nd->nrad_pref[moit];
+      memcpy (nv->nrad_pref, nd->nrad_pref + moit + 1,
+              nbd * sizeof (uint64_t));
+      memcpy (nv->nrad_cle, nd->nrad_cle + moit + 1,
+              nbd * sizeof (struct MiSt_Radical_st *));
+      memcpy (nv->nrad_fils, nd->nrad_fils + moit + 1,
+              (nbd + 1) * sizeof (struct Mi_NoeudRadicaux_st *));
+      for (unsigned ix = 0; ix <= nbd; ix++)
+        nv->nrad_fils[ix]->nrad_parent = nv;
+      nv->nrad_nb = nbd;
+    }
+  nd->nrad_nb = moit;
+  return nv;
+}				/* fin mi_noeud_radicaux_couper */
 
+// après la coupe de nd en nd et nv, remonter le séparateur sep
 static void
-mi_radical_rotation_droite (struct MiSt_Radical_st *radx)
-{
-  assert (radx && radx->urad_nmagiq == MI_RAD_NMAGIQ);
-  struct MiSt_Radical_st *rady = radx->urad_gauche;
-  assert (rady && rady->urad_nmagiq == MI_RAD_NMAGIQ);
-  radx->urad_gauche = rady->urad_droit;
-  if (rady->urad_droit != NULL)
-    rady->urad_droit->urad_parent = radx;
-  rady->urad_parent = radx->urad_parent;
-  if (radx->urad_parent == NULL)
-    mi_racine_radical = rady;
-  else if (radx == radx->urad_parent->urad_droit)
-    radx->urad_parent->urad_droit = rady;
-  else
-    radx->urad_parent->urad_gauche = rady;
-  rady->urad_droit = radx;
-  radx->urad_parent = rady;
-}				/* fin mi_radical_rotation_droite */
-
-
-
-static struct MiSt_Radical_st *
-mi_creer_radical (const Mit_Chaine *ch)
+mi_noeud_radicaux_remonter (struct Mi_NoeudRadicaux_st *nd,
+                            struct MiSt_Radical_st *sep, uint64_t pr,
+                            struct Mi_NoeudRadicaux_st *nv)
 {
-  assert (ch != NULL && ch->mi_type == MiTy_Chaine);
-  assert (mi_nom_licite (ch));
-  struct MiSt_Radical_st *rad = calloc (1, sizeof (struct MiSt_Radical_st));
-  if (!rad)
+  const unsigned moit = MI_RADICAUX_ORDRE / 2;
+  for (;;)
     {
-      perror ("mi_creer_radical");
-      exit (EXIT_FAILURE);
-    };
-  rad->urad_nmagiq = MI_RAD_NMAGIQ;
-  rad->urad_couleur = crad_rouge;
-  rad->urad_nom = ch;
-  rad->urad_parent = NULL;
-  rad->urad_gauche = NULL;
-  rad->urad_droit = NULL;
-  MI_DEBOPRINTF ("rad@%p ch@%p'%s'", rad, ch, ch->mi_car);
-  return rad;
-}				/* fin mi_creer_radical */
-
-
-static void mi_correction_apres_insertion (struct MiSt_Radical_st *);
+      struct Mi_NoeudRadicaux_st *par = nd->nrad_parent;
+      if (!par)
+        {
+          par = mi_creer_noeud_radicaux (false);
+          par->nrad_fils[0] = nd;
+          nd->nrad_parent = par;
+          mi_noeud_radicaux_placer (par, 0, sep, pr, nv);
+          mi_racine_radicaux = par;
+          return;
+        }
+      unsigned ix = 0;
+      while (par->nrad_fils[ix] != nd)
+        ix++;
+      if (par->nrad_nb < MI_RADICAUX_ORDRE)
+        {
+          mi_noeud_radicaux_placer (par, ix, sep, pr, nv);
+          return;
+        }
+      struct MiSt_Radical_st *separ = NULL;
+      uint64_t prpar = 0;
+      struct Mi_NoeudRadicaux_st *nvpar =
+        mi_noeud_radicaux_couper (par, &separ, &prpar);
+      if (ix <= moit)
+        mi_noeud_radicaux_placer (par, ix, sep, pr, nv);
+      else
+        mi_noeud_radicaux_placer (nvpar, ix - moit - 1, sep, pr, nv);
+      nd = par;
+      sep = separ;
+      pr = prpar;
+      nv = nvpar;
+    }
+}				/* fin mi_noeud_radicaux_remonter */
 
 static struct MiSt_Radical_st *
 mi_radical_insere_nom (const Mit_Chaine *nomz)
 {
   assert (mi_nom_licite (nomz));
-  struct MiSt_Radical_st *rady = NULL;
-  struct MiSt_Radical_st *radx = mi_racine_radical;
-  int cmp = 0;
-  MI_DEBOPRINTF ("début nomz@%p:'%s' mi_racine_radical@%p",
-                 nomz, nomz->mi_car, mi_racine_radical);
-  while (radx != NULL)
+  struct MiSt_Radical_st *radz =
+    mi_hash_radicaux_chercher (nomz->mi_car, nomz->mi_taille, nomz->mi_hash);
+  if (radz)
+    return radz;
+  MI_DEBOPRINTF ("début nomz@%p:'%s' mi_racine_radicaux@%p",
+                 nomz, nomz->mi_car, mi_racine_radicaux);
+  radz = mi_creer_radical (nomz);
+  uint64_t pr = mi_prefixe_nom (nomz->mi_car);
+  if (!mi_racine_radicaux)
     {
-      assert (radx->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (radx->urad_nom && radx->urad_nom->mi_type == MiTy_Chaine);
-      rady = radx;
-      cmp = strcmp (nomz->mi_car, radx->urad_nom->mi_car);
-      if (!cmp)
-        return radx;
-      else if (cmp < 0)
-        radx = radx->urad_gauche;
-      else
-        radx = radx->urad_droit;
+      struct Mi_NoeudRadicaux_st *fe = mi_creer_noeud_radicaux (true);
+      mi_racine_radicaux = fe;
+      mi_premiere_feuille_radicaux = mi_derniere_feuille_radicaux = fe;
+      mi_noeud_radicaux_placer (fe, 0, radz, pr, NULL);
     }
-  struct MiSt_Radical_st *radz = mi_creer_radical (nomz);
-  MI_DEBOPRINTF ("rady@%p'%s' radz@%p'%s' nomz@%p:'%s'",
-                 rady, mi_radical_chaine (rady), radz,
-                 mi_radical_chaine (radz), nomz, nomz->mi_car);
-  assert (radz && radz->urad_nmagiq == MI_RAD_NMAGIQ);
-  radz->urad_parent = rady;
-  if (rady == NULL)
-    mi_racine_radical = radz;
-  else if ((cmp = strcmp (nomz->mi_car, rady->urad_nom->mi_car)) < 0)
-    rady->urad_gauche = radz;
-  else if (cmp > 0)
-    rady->urad_droit = radz;
-  else				// cas impossible
+  else
     {
-      assert ("cas impossible mauvais rady");
-      MI_FATALPRINTF ("corruption de radical rady@%p", (void *) rady);
+      struct Mi_NoeudRadicaux_st *fe =
+        mi_feuille_radicaux (nomz->mi_car, pr);
+      unsigned ix = 0;
+      while (ix < fe->nrad_nb
+             && mi_comparer_nom_radical (nomz->mi_car, pr, fe->nrad_cle[ix],
+                                         fe->nrad_pref[ix]) > 0)
+        ix++;
+      if (fe->nrad_nb < MI_RADICAUX_ORDRE)
+        mi_noeud_radicaux_placer (fe, ix, radz, pr, NULL);
+      else
+        {
+          const unsigned moit = MI_RADICAUX_ORDRE / 2;
+          struct MiSt_Radical_st *sep = NULL;
+          uint64_t prsep = 0;
+          struct Mi_NoeudRadicaux_st *nv =
+            mi_noeud_radicaux_couper (fe, &sep, &prsep);
+          if (ix <= moit)
+            mi_noeud_radicaux_placer (fe, ix, radz, pr, NULL);
+          else
+            mi_noeud_radicaux_placer (nv, ix - moit, radz, pr, NULL);
+          mi_noeud_radicaux_remonter (fe, sep, prsep, nv);
+        }
     }
-  mi_correction_apres_insertion (radz);
+  mi_radical_numeroter (radz);
+  mi_hash_radicaux_ajouter (radz);
+  MI_DEBOPRINTF ("radz@%p'%s'", radz, mi_radical_chaine (radz));
   return radz;
 }				/* fin mi_radical_insere_nom */
 
 
+// la chaine du nom n'est allouée que si le radical est nouveau
 static struct MiSt_Radical_st *
-mi_radical_insere_chaine (const char *ch)
-{
-  MI_DEBOPRINTF ("debut ch='%s' mi_racine_radical@%p", ch, mi_racine_radical);
-  if (mi_deboguage)
-    mi_afficher_radicaux ("insere_chaine");
-  assert (mi_nom_licite_chaine (ch));
-  struct MiSt_Radical_st *rady = NULL;
-  struct MiSt_Radical_st *radx = mi_racine_radical;
-  int cmp = 0;
-  while (radx != NULL)
-    {
-      MI_DEBOPRINTF ("radx@%p '%s'", radx, mi_radical_chaine (radx));
-      assert (radx->urad_nmagiq == MI_RAD_NMAGIQ);
-      assert (radx->urad_nom && radx->urad_nom->mi_type == MiTy_Chaine);
-      rady = radx;
-      cmp = strcmp (ch, radx->urad_nom->mi_car);
-      if (!cmp)
-        {
-          MI_DEBOPRINTF ("resultat radx@%p ch=%s", radx, ch);
-          return radx;
-        }
-      else if (cmp < 0)
-        radx = radx->urad_gauche;
-      else
-        radx = radx->urad_droit;
-    }
-  struct MiSt_Radical_st *radz = mi_creer_radical (mi_creer_chaine (ch));
-  MI_DEBOPRINTF ("rady@%p'%s' radz@%p'%s' ch='%s'",
-                 rady, mi_radical_chaine (rady),
-                 radz, mi_radical_chaine (radz), ch);
-  assert (radz && radz->urad_nmagiq == MI_RAD_NMAGIQ);
-  radz->urad_parent = rady;
-  if (rady == NULL)
-    mi_racine_radical = radz;
-  else if ((cmp = strcmp (ch, rady->urad_nom->mi_car)) < 0)
-    rady->urad_gauche = radz;
-  else if (cmp > 0)
-    rady->urad_droit = radz;
-  else				// cas impossible
+mi_radical_insere_octets (const char *oct, unsigned nb)
+{
+  assert (mi_nom_licite_octets (oct, nb));
+  struct MiSt_Radical_st *rad =
+    mi_hash_radicaux_chercher (oct, nb, mi_hashage_octets (oct, nb));
+  if (rad)
+    return rad;
+  return mi_radical_insere_nom (mi_creer_chaine_octets (oct, nb));
+}				/* fin mi_radical_insere_octets */
+
+/// Construction en bloc de l'arbre des radicaux, depuis des noms triés
+/// (typiquement le fichier symbolist, écrit dans l'ordre des noms). Les
+/// radicaux existants et nouveaux sont fusionnés en un seul tableau
+/// trié, puis l'arbre est reconstruit de bas en haut en O(n): les
+/// feuilles sont remplies aux trois quarts, puis chaque niveau interne.
+/// Les nouveaux radicaux et les noeuds de chaque niveau sont alloués
+/// par tranches; l'ancien arbre est libéré.
+#define MI_RADICAUX_REMPLISSAGE (3*MI_RADICAUX_ORDRE/4)
+struct Mi_TrancheNoeuds_st
+{
+  struct Mi_TrancheNoeuds_st *tn_suiv;
+  unsigned tn_nb;
+};
+#define MI_TRANCHE_ENTETE \
+  ((sizeof (struct Mi_TrancheNoeuds_st) + 15) & ~(size_t)15)
+static struct Mi_TrancheNoeuds_st *mi_tranches_radicaux;
+
+static struct Mi_NoeudRadicaux_st *
+mi_tranche_noeuds_radicaux (unsigned nb, bool feuille, size_t *ptail)
+{
+  size_t tail = sizeof (struct Mi_NoeudRadicaux_st)
+                + (feuille ? 0 : (MI_RADICAUX_ORDRE + 1)
+                   * sizeof (struct Mi_NoeudRadicaux_st *));
+  tail = (tail + 15) & ~(size_t) 15;
+  struct Mi_TrancheNoeuds_st *tn = calloc (1, MI_TRANCHE_ENTETE + nb * tail);
+  if (!tn)
+    MI_FATALPRINTF ("impossible d'allouer %u noeuds de radicaux (%s)",
+                    nb, strerror (errno));
+  tn->tn_nb = nb;
+  tn->tn_suiv = mi_tranches_radicaux;
+  mi_tranches_radicaux = tn;
+  char *deb = (char *) tn + MI_TRANCHE_ENTETE;
+  for (unsigned ix = 0; ix < nb; ix++)
     {
-      assert ("cas impossible mauvais rady");
-      MI_FATALPRINTF ("corruption de radical rady@%p'%s'",
-                      (void *) rady, mi_radical_chaine (rady));
+      struct Mi_NoeudRadicaux_st *nd =
+        (struct Mi_NoeudRadicaux_st *) (deb + ix * tail);
+      nd->nrad_nmagiq = MI_NOEUDRAD_NMAGIQ;
+      nd->nrad_feuille = feuille;
+      nd->nrad_tranche = true;
     }
-  MI_DEBOPRINTF ("avant correction radz@%p'%s'",
-                 radz, mi_radical_chaine (radz));
-  if (mi_deboguage)
-    mi_afficher_radicaux ("insere_ch. avant correction");
-  mi_correction_apres_insertion (radz);
-  MI_DEBOPRINTF ("apres correction radz@%p'%s'",
-                 radz, mi_radical_chaine (radz));
-  return radz;
-}				/* fin mi_radical_insere_chaine */
+  *ptail = tail;
+  return (struct Mi_NoeudRadicaux_st *) deb;
+}				/* fin mi_tranche_noeuds_radicaux */
 
+// libère les noeuds alloués un par un; ceux des tranches le sont
+// ensuite avec leur tranche
+static void
+mi_liberer_noeud_radicaux (struct Mi_NoeudRadicaux_st *nd)
+{
+  if (!nd)
+    return;
+  assert (nd->nrad_nmagiq == MI_NOEUDRAD_NMAGIQ);
+  if (!nd->nrad_feuille)
+    for (unsigned ix = 0; ix <= nd->nrad_nb; ix++)
+      mi_liberer_noeud_radicaux (nd->nrad_fils[ix]);
+  if (!nd->nrad_tranche)
+    free (nd);
+}				/* fin mi_liberer_noeud_radicaux */
+
+// répartit nb éléments en nbgr groupes de tailles égales à un près;
+// renvoie la taille du groupe ig
+static inline unsigned
+mi_taille_groupe (unsigned nb, unsigned nbgr, unsigned ig)
+{
+  return nb / nbgr + (ig < nb % nbgr);
+}				/* fin mi_taille_groupe */
 
+// remplace l'arbre par un arbre construit de bas en haut depuis les nb
+// radicaux de tab, triés strictement par nom
 static void
-mi_correction_apres_insertion (struct MiSt_Radical_st *radz)
+mi_radicaux_construire (unsigned nb, struct MiSt_Radical_st **tab)
 {
-  MI_DEBOPRINTF ("début radz@%p'%s'", radz, mi_radical_chaine (radz));
-  assert (radz && radz->urad_nmagiq == MI_RAD_NMAGIQ);
-  struct MiSt_Radical_st *radparz = NULL;
-  while ((radparz = radz->urad_parent), mi_radical_rouge (radparz))
+  mi_liberer_noeud_radicaux (mi_racine_radicaux);
+  while (mi_tranches_radicaux)
+    {
+      struct Mi_TrancheNoeuds_st *tn = mi_tranches_radicaux;
+      mi_tranches_radicaux = tn->tn_suiv;
+      free (tn);
+    }
+  mi_racine_radicaux = NULL;
+  mi_premiere_feuille_radicaux = mi_derniere_feuille_radicaux = NULL;
+  if (nb == 0)
+    return;
+  // les feuilles
+  unsigned nbniv = (nb + MI_RADICAUX_REMPLISSAGE - 1) / MI_RADICAUX_REMPLISSAGE;
+  size_t tail = 0;
+  char *niv = (char *) mi_tranche_noeuds_radicaux (nbniv, true, &tail);
+  struct MiSt_Radical_st **tabmin =
+    calloc (nbniv, sizeof (struct MiSt_Radical_st *));
+  if (!tabmin)
+    MI_FATALPRINTF ("impossible d'allouer %u minima (%s)", nbniv,
+                    strerror (errno));
+  unsigned ir = 0;
+  struct Mi_NoeudRadicaux_st *prec = NULL;
+  for (unsigned ig = 0; ig < nbniv; ig++)
     {
-      MI_DEBOPRINTF ("radz@%p'%s' radparz@%p'%s'",
-                     radz, mi_radical_chaine (radz),
-                     radparz, mi_radical_chaine (radparz));
-      assert (radparz->urad_nmagiq == MI_RAD_NMAGIQ);
-      if (radparz->urad_parent != NULL
-          && radparz == radparz->urad_parent->urad_gauche)
+      struct Mi_NoeudRadicaux_st *fe =
+        (struct Mi_NoeudRadicaux_st *) (niv + ig * tail);
+      unsigned nbg = mi_taille_groupe (nb, nbniv, ig);
+      for (unsigned ix = 0; ix < nbg; ix++, ir++)
         {
-          struct MiSt_Radical_st *rady = radparz->urad_parent->urad_droit;
-          MI_DEBOPRINTF ("rady@%p'%s'", rady, mi_radical_chaine (rady));
-          assert (!rady || rady->urad_nmagiq == MI_RAD_NMAGIQ);
-          if (mi_radical_rouge (rady))
-            {
-              radparz->urad_couleur = crad_noir;
-              rady->urad_couleur = crad_noir;
-              MI_DEBOPRINTF ("radparz@%p'%s'",
-                             radparz, mi_radical_chaine (radparz));
-              radparz->urad_parent->urad_couleur = crad_rouge;
-              radz = radparz->urad_parent;
-            }
-          else
-            {
-              if (radz == radparz->urad_droit)
-                {
-                  radz = radparz;
-                  MI_DEBOPRINTF ("radz@%p'%s' avant rot.gauche",
-                                 radz, mi_radical_chaine (radz));
-                  mi_radical_rotation_gauche (radz);
-                  radparz = radz->urad_parent;
-                };
-              radparz->urad_couleur = crad_noir;
-              assert (radparz->urad_parent);
-              radparz->urad_parent->urad_couleur = crad_rouge;
-              MI_DEBOPRINTF ("radparz@%p'%s' avant rot.droite parent@%p'%s'",
-                             radparz, mi_radical_chaine (radparz),
-                             radparz->urad_parent,
-                             mi_radical_chaine (radparz->urad_parent));
-              mi_radical_rotation_droite (radparz->urad_parent);
-            }
+          struct MiSt_Radical_st *rad = tab[ir];
+          fe->nrad_cle[ix] = rad;
+          fe->nrad_pref[ix] = mi_prefixe_nom (rad->urad_nom->mi_car);
+          rad->urad_feuille = fe;
         }
-      else if (radparz->urad_parent != NULL
-               && radparz == radparz->urad_parent->urad_droit)
+      fe->nrad_nb = nbg;
+      tabmin[ig] = fe->nrad_cle[0];
+      fe->nrad_prec = prec;
+      if (prec)
+        prec->nrad_suiv = fe;
+      prec = fe;
+    }
+  assert (ir == nb);
+  mi_premiere_feuille_radicaux = (struct Mi_NoeudRadicaux_st *) niv;
+  mi_derniere_feuille_radicaux = prec;
+  // les niveaux internes, jusqu'à la racine
+  size_t tailniv = tail;
+  while (nbniv > 1)
+    {
+      unsigned nbpar =
+        (nbniv + MI_RADICAUX_REMPLISSAGE) / (MI_RADICAUX_REMPLISSAGE + 1);
+      char *par = (char *) mi_tranche_noeuds_radicaux (nbpar, false, &tail);
+      unsigned ic = 0;
+      for (unsigned ig = 0; ig < nbpar; ig++)
         {
-          struct MiSt_Radical_st *rady = radparz->urad_parent->urad_gauche;
-          MI_DEBOPRINTF ("rady@%p'%s'", rady, mi_radical_chaine (rady));
-          assert (!rady || rady->urad_nmagiq == MI_RAD_NMAGIQ);
-          if (mi_radical_rouge (rady))
-            {
-              radparz->urad_couleur = crad_noir;
-              rady->urad_couleur = crad_noir;
-              radparz->urad_parent->urad_couleur = crad_rouge;
-              radz = radparz->urad_parent;
-              MI_DEBOPRINTF ("radz@%p'%s'", radz, mi_radical_chaine (radz));
-            }
-          else
+          struct Mi_NoeudRadicaux_st *nd =
+            (struct Mi_NoeudRadicaux_st *) (par + ig * tail);
+          unsigned nbg = mi_taille_groupe (nbniv, nbpar, ig);
+          assert (nbg >= 2 && nbg <= MI_RADICAUX_ORDRE + 1);
+          struct MiSt_Radical_st *min = tabmin[ic];
+          for (unsigned ix = 0; ix < nbg; ix++, ic++)
             {
-              if (radz == radparz->urad_gauche)
+              struct Mi_NoeudRadicaux_st *fils =
+                (struct Mi_NoeudRadicaux_st *) (niv + ic * tailniv);
+              nd->nrad_fils[ix] = fils;
+              fils->nrad_parent = nd;
+              if (ix > 0)
                 {
-                  radz = radparz;
-                  MI_DEBOPRINTF ("radz@%p'%s' avant rot.droite",
-                                 radz, mi_radical_chaine (radz));
-                  mi_radical_rotation_droite (radz);
-                  radparz = radz->urad_parent;
-                };
-              radparz->urad_couleur = crad_noir;
-              MI_DEBOPRINTF ("radparz@%p'%s'",
-                             radparz, mi_radical_chaine (radparz));
-              assert (radparz->urad_parent);
-              radparz->urad_parent->urad_couleur = crad_rouge;
-              MI_DEBOPRINTF ("avant rot.gauche radparz.parent@%p'%s'",
-                             radparz->urad_parent,
-                             mi_radical_chaine (radparz->urad_parent));
-              mi_radical_rotation_gauche (radparz->urad_parent);
-              MI_DEBOPRINTF ("apres rot.gauche radparz.parent@%p'%s'",
-                             radparz->urad_parent,
-                             mi_radical_chaine (radparz->urad_parent));
+                  nd->nrad_cle[ix - 1] = tabmin[ic];
+                  nd->nrad_pref[ix - 1] =
+                    mi_prefixe_nom (tabmin[ic]->urad_nom->mi_car);
+                }
             }
+          nd->nrad_nb = nbg - 1;
+          tabmin[ig] = min;
         }
-      else if (radparz->urad_parent != NULL)	// cas impossible
+      assert (ic == nbniv);
+      niv = par;
+      tailniv = tail;
+      nbniv = nbpar;
+    }
+  free (tabmin);
+  mi_racine_radicaux = (struct Mi_NoeudRadicaux_st *) niv;
+}				/* fin mi_radicaux_construire */
+
+static int
+mi_comparer_octets_noms (const char *oct1, unsigned nb1, const char *oct2,
+                         unsigned nb2)
+{
+  int cmp = memcmp (oct1, oct2, (nb1 < nb2) ? nb1 : nb2);
+  if (cmp)
+    return cmp;
+  return (nb1 < nb2) ? -1 : (nb1 > nb2);
+}				/* fin mi_comparer_octets_noms */
+
+void
+mi_creer_radicaux_tries (unsigned nb, const char *const *tabnom,
+                         const unsigned *tablg,
+                         struct MiSt_Radical_st **tabres)
+{
+  if (nb == 0 || !tabnom || !tablg)
+    return;
+  // sans tri, ou pour peu de noms, insérer un par un
+  bool tries = nb >= MI_RADICAUX_ORDRE;
+  for (unsigned ix = 1; ix < nb && tries; ix++)
+    tries = mi_comparer_octets_noms (tabnom[ix - 1], tablg[ix - 1],
+                                     tabnom[ix], tablg[ix]) <= 0;
+  if (!tries)
+    {
+      for (unsigned ix = 0; ix < nb; ix++)
         {
-          assert ("corruption dans insertion");
-          MI_FATALPRINTF ("corruption radz@%p radparz@%p",
-                          (void *) radz, (void *) radparz);
+          struct MiSt_Radical_st *rad = NULL;
+          if (mi_nom_licite_octets (tabnom[ix], tablg[ix]))
+            rad = mi_radical_insere_octets (tabnom[ix], tablg[ix]);
+          if (tabres)
+            tabres[ix] = rad;
         }
-      else
+      return;
+    }
+  // chercher les radicaux existants; un nom nouveau est noté par
+  // MI_TROU_RADICAL, un doublon par NULL
+  struct MiSt_Radical_st **tabtrouv = tabres;
+  if (!tabtrouv)
+    tabtrouv = calloc (nb, sizeof (struct MiSt_Radical_st *));
+  if (!tabtrouv)
+    MI_FATALPRINTF ("impossible d'allouer %u radicaux (%s)", nb,
+                    strerror (errno));
+#define MI_TROU_RADICAL ((struct MiSt_Radical_st*)-1)
+  unsigned nbnouv = 0;
+  for (unsigned ix = 0; ix < nb; ix++)
+    {
+      if (ix > 0 && tablg[ix] == tablg[ix - 1]
+          && !memcmp (tabnom[ix], tabnom[ix - 1], tablg[ix]))
+        tabtrouv[ix] = NULL;
+      else if (!mi_nom_licite_octets (tabnom[ix], tablg[ix]))
+        tabtrouv[ix] = NULL;
+      else if ((tabtrouv[ix] =
+                  mi_trouver_radical_octets (tabnom[ix], tablg[ix])) == NULL)
         {
-          MI_DEBOPRINTF ("fin avec radz@%p'%s' radparz@%p'%s'",
-                         radz, mi_radical_chaine (radz),
-                         radparz, mi_radical_chaine (radparz));
-          break;
+          tabtrouv[ix] = MI_TROU_RADICAL;
+          nbnouv++;
         }
     }
-  if (mi_racine_radical != NULL)
-    mi_racine_radical->urad_couleur = crad_noir;
-}				/* fin mi_correction_apres_insertion */
-
+  if (nbnouv > 0)
+    {
+      // les nouveaux radicaux, dans une tranche, fusionnés avec les anciens
+      struct MiSt_Radical_st *tranche =
+        calloc (nbnouv, sizeof (struct MiSt_Radical_st));
+      unsigned nbanc = mi_hash_radicaux.hrad_nb;
+      struct MiSt_Radical_st **tabrad =
+        calloc (nbanc + nbnouv, sizeof (struct MiSt_Radical_st *));
+      struct MiSt_Radical_st **tabanc =
+        calloc (nbanc + 1, sizeof (struct MiSt_Radical_st *));
+      if (!tranche || !tabrad || !tabanc)
+        MI_FATALPRINTF ("impossible d'allouer %u nouveaux radicaux (%s)",
+                        nbnouv, strerror (errno));
+      unsigned ia = 0;
+      for (struct Mi_NoeudRadicaux_st * fe = mi_premiere_feuille_radicaux;
+           fe != NULL; fe = fe->nrad_suiv)
+        for (unsigned ix = 0; ix < fe->nrad_nb; ix++)
+          tabanc[ia++] = fe->nrad_cle[ix];
+      assert (ia == nbanc);
+      mi_hash_radicaux_reserver (nbnouv);
+      unsigned nbtot = 0, in = 0;
+      ia = 0;
+      for (unsigned ix = 0; ix < nb; ix++)
+        {
+          if (tabtrouv[ix] != MI_TROU_RADICAL)
+            continue;
+          struct MiSt_Radical_st *rad = tranche + in++;
+          mi_initialiser_radical (rad, mi_creer_chaine_octets (tabnom[ix],
+                                  tablg[ix]));
+          while (ia < nbanc
+                 && strcmp (tabanc[ia]->urad_nom->mi_car,
+                            rad->urad_nom->mi_car) < 0)
+            tabrad[nbtot++] = tabanc[ia++];
+          tabrad[nbtot++] = rad;
+          mi_hash_radicaux_ajouter (rad);
+          tabtrouv[ix] = rad;
+        }
+      while (ia < nbanc)
+        tabrad[nbtot++] = tabanc[ia++];
+      assert (in == nbnouv && nbtot == nbanc + nbnouv);
+      free (tabanc);
+      mi_radicaux_construire (nbtot, tabrad);
+      // renuméroter régulièrement tous les rangs
+      uint32_t pas = (UINT32_MAX - 1) / (nbtot + 1);
+      if (pas > MI_RANG_PAS)
+        pas = MI_RANG_PAS;
+      if (pas < MI_RANG_ECART_MIN)
+        MI_FATALPRINTF ("trop de radicaux (%u) pour les numéroter", nbtot);
+      for (unsigned ix = 0; ix < nbtot; ix++)
+        mi_radical_mettre_rang (tabrad[ix], (ix + 1) * pas);
+      if (nbanc > 0)
+        mi_generation_rangs++;
+      free (tabrad);
+    }
+  if (tabres)
+    {
+      // les doublons ont le radical du nom précédent
+      for (unsigned ix = 1; ix < nb; ix++)
+        if (!tabres[ix] && tablg[ix] == tablg[ix - 1]
+            && !memcmp (tabnom[ix], tabnom[ix - 1], tablg[ix]))
+          tabres[ix] = tabres[ix - 1];
+    }
+  else
+    free (tabtrouv);
+#undef MI_TROU_RADICAL
+}				/* fin mi_creer_radicaux_tries */
+
+/// Les symboles secondaires de tous les radicaux sont dans une seule
+/// table globale indexée par (radical, indice), à adressage ouvert et
+/// sondage linéaire, de taille puissance de deux. Pour l'agrandir, on
+/// alloue une nouvelle table et chaque ajout ou retrait qui suit y
+/// migre MI_SECONDAIRES_MIGRATION cases de l'ancienne, ce qui évite
+/// de tout rehacher d'un coup; pendant la migration, les recherches
+/// regardent les deux tables. Chaque radical chaîne aussi ses
+/// symboles secondaires, dans l'ordre de création, pour les parcourir.
+#define MI_SECONDAIRES_TAILLE_MIN 1024
+#define MI_SECONDAIRES_MIGRATION 16
+static struct
+{
+  unsigned sec_nb;		// symboles dans les deux tables
+  unsigned sec_nbtrous;		// cases MI_TROU_SYMBOLE de sec_tab
+  unsigned sec_taille;		// taille de sec_tab
+  Mit_Symbole **sec_tab;
+  unsigned sec_anctaille;	// taille de sec_anctab, 0 hors migration
+  unsigned sec_ancpos;		// prochaine case de sec_anctab à migrer
+  Mit_Symbole **sec_anctab;
+} mi_secondaires;
+
+static inline unsigned
+mi_hash_secondaire (const struct MiSt_Radical_st *rad, unsigned ind)
+{
+  uint64_t x = ((uint64_t) rad->urad_hash << 32) | ind;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return (unsigned) x;
+}				/* fin mi_hash_secondaire */
+
+// la case de tab contenant (rad, ind), ou -1; au plus taille cases
+// sont sondées, car une ancienne table en fin de migration peut ne
+// plus contenir de case vide
 static int
-mi_indice_radical_symbole_secondaire (struct MiSt_Radical_st *rad,
-                                      unsigned ind);
+mi_secondaires_case (Mit_Symbole **tab, unsigned taille,
+                     const struct MiSt_Radical_st *rad, unsigned ind)
+{
+  if (!tab)
+    return -1;
+  unsigned masq = taille - 1;
+  Mit_Symbole *sy = NULL;
+  unsigned ix = mi_hash_secondaire (rad, ind) & masq;
+  for (unsigned nbsond = 0; nbsond < taille && (sy = tab[ix]) != NULL;
+       nbsond++, ix = (ix + 1) & masq)
+    if (sy != MI_TROU_SYMBOLE && sy->mi_indice == ind && sy->mi_radical == rad)
+      return (int) ix;
+  return -1;
+}				/* fin mi_secondaires_case */
+
+static Mit_Symbole *
+mi_secondaire_chercher (const struct MiSt_Radical_st *rad, unsigned ind)
+{
+  int pos = mi_secondaires_case (mi_secondaires.sec_tab,
+                                 mi_secondaires.sec_taille, rad, ind);
+  if (pos >= 0)
+    return mi_secondaires.sec_tab[pos];
+  pos = mi_secondaires_case (mi_secondaires.sec_anctab,
+                             mi_secondaires.sec_anctaille, rad, ind);
+  if (pos >= 0)
+    return mi_secondaires.sec_anctab[pos];
+  return NULL;
+}				/* fin mi_secondaire_chercher */
+
+// place sy, absent, dans la nouvelle table
+static void
+mi_secondaires_placer (Mit_Symbole *sy)
+{
+  unsigned masq = mi_secondaires.sec_taille - 1;
+  unsigned ix = mi_hash_secondaire (sy->mi_radical, sy->mi_indice) & masq;
+  while (mi_secondaires.sec_tab[ix]
+         && mi_secondaires.sec_tab[ix] != MI_TROU_SYMBOLE)
+    ix = (ix + 1) & masq;
+  if (mi_secondaires.sec_tab[ix] == MI_TROU_SYMBOLE)
+    mi_secondaires.sec_nbtrous--;
+  mi_secondaires.sec_tab[ix] = sy;
+}				/* fin mi_secondaires_placer */
+
+// migre au plus nbcases cases de l'ancienne table; une case migrée y
+// devient un trou et non une case vide, pour que les recherches
+// sondent au-delà vers les symboles pas encore migrés du même amas
+static void
+mi_secondaires_migrer (unsigned nbcases)
+{
+  if (!mi_secondaires.sec_anctab)
+    return;
+  for (; nbcases > 0
+       && mi_secondaires.sec_ancpos < mi_secondaires.sec_anctaille; nbcases--)
+    {
+      Mit_Symbole *sy = mi_secondaires.sec_anctab[mi_secondaires.sec_ancpos];
+      if (sy && sy != MI_TROU_SYMBOLE)
+        {
+          mi_secondaires.sec_anctab[mi_secondaires.sec_ancpos] =
+            MI_TROU_SYMBOLE;
+          mi_secondaires_placer (sy);
+        }
+      mi_secondaires.sec_ancpos++;
+    }
+  if (mi_secondaires.sec_ancpos >= mi_secondaires.sec_anctaille)
+    {
+      free (mi_secondaires.sec_anctab);
+      mi_secondaires.sec_anctab = NULL;
+      mi_secondaires.sec_anctaille = 0;
+      mi_secondaires.sec_ancpos = 0;
+    }
+}				/* fin mi_secondaires_migrer */
+
+// prépare l'ajout d'un symbole, en commençant une migration si la
+// nouvelle table est à moitié pleine
+static void
+mi_secondaires_preparer (void)
+{
+  mi_secondaires_migrer (MI_SECONDAIRES_MIGRATION);
+  if (2 * (mi_secondaires.sec_nb + mi_secondaires.sec_nbtrous + 1)
+      <= mi_secondaires.sec_taille)
+    return;
+  // une migration précédente doit être finie; elle l'est normalement
+  // déjà puisque chaque ajout migre plusieurs cases
+  mi_secondaires_migrer (UINT_MAX);
+  // jamais plus petite, pour que la migration finisse à temps
+  unsigned nouvtail = mi_secondaires.sec_taille;
+  if (nouvtail < MI_SECONDAIRES_TAILLE_MIN)
+    nouvtail = MI_SECONDAIRES_TAILLE_MIN;
+  while (nouvtail < 4 * (mi_secondaires.sec_nb + 1))
+    {
+      if (nouvtail > UINT_MAX / 4)
+        MI_FATALPRINTF ("trop (%u) de symboles secondaires",
+                        mi_secondaires.sec_nb);
+      nouvtail *= 2;
+    }
+  Mit_Symbole **nouvtab = calloc (nouvtail, sizeof (Mit_Symbole *));
+  if (!nouvtab)
+    MI_FATALPRINTF ("impossible d'allouer la table des symboles secondaires"
+                    " de %u (%s)", nouvtail, strerror (errno));
+  mi_secondaires.sec_anctab = mi_secondaires.sec_tab;
+  mi_secondaires.sec_anctaille = mi_secondaires.sec_taille;
+  mi_secondaires.sec_ancpos = 0;
+  mi_secondaires.sec_tab = nouvtab;
+  mi_secondaires.sec_taille = nouvtail;
+  mi_secondaires.sec_nbtrous = 0;
+}				/* fin mi_secondaires_preparer */
+
+// ajoute le symbole secondaire sy, absent, à la table et à son radical
+static void
+mi_secondaire_ajouter (Mit_Symbole *sy)
+{
+  assert (sy && sy->mi_type == MiTy_Symbole && sy->mi_indice > 0);
+  struct MiSt_Radical_st *rad = sy->mi_radical;
+  assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
+  mi_secondaires_preparer ();
+  mi_secondaires_placer (sy);
+  mi_secondaires.sec_nb++;
+  sy->mi_secprec = rad->urad_val.vrad_dersec;
+  sy->mi_secsuiv = NULL;
+  if (rad->urad_val.vrad_dersec)
+    rad->urad_val.vrad_dersec->mi_secsuiv = sy;
+  else
+    rad->urad_val.vrad_premsec = sy;
+  rad->urad_val.vrad_dersec = sy;
+  rad->urad_val.vrad_nbsec++;
+}				/* fin mi_secondaire_ajouter */
+
+// ôte le symbole secondaire sy; faux s'il n'était pas dans la table
+static bool
+mi_secondaire_oter (Mit_Symbole *sy)
+{
+  struct MiSt_Radical_st *rad = sy->mi_radical;
+  int pos = mi_secondaires_case (mi_secondaires.sec_tab,
+                                 mi_secondaires.sec_taille, rad,
+                                 sy->mi_indice);
+  if (pos >= 0 && mi_secondaires.sec_tab[pos] == sy)
+    {
+      mi_secondaires.sec_tab[pos] = MI_TROU_SYMBOLE;
+      mi_secondaires.sec_nbtrous++;
+    }
+  else if ((pos = mi_secondaires_case (mi_secondaires.sec_anctab,
+                                       mi_secondaires.sec_anctaille, rad,
+                                       sy->mi_indice)) >= 0
+           && mi_secondaires.sec_anctab[pos] == sy)
+    mi_secondaires.sec_anctab[pos] = MI_TROU_SYMBOLE;
+  else
+    return false;
+  mi_secondaires.sec_nb--;
+  if (sy->mi_secprec)
+    sy->mi_secprec->mi_secsuiv = sy->mi_secsuiv;
+  else
+    rad->urad_val.vrad_premsec = sy->mi_secsuiv;
+  if (sy->mi_secsuiv)
+    sy->mi_secsuiv->mi_secprec = sy->mi_secprec;
+  else
+    rad->urad_val.vrad_dersec = sy->mi_secprec;
+  sy->mi_secprec = sy->mi_secsuiv = NULL;
+  rad->urad_val.vrad_nbsec--;
+  mi_secondaires_migrer (MI_SECONDAIRES_MIGRATION);
+  return true;
+}				/* fin mi_secondaire_oter */
 
 Mit_Symbole *
 mi_trouver_symbole_nom (const Mit_Chaine *nom, unsigned ind)
@@ -756,17 +1343,7 @@ mi_trouver_symbole_nom (const Mit_Chaine *nom, unsigned ind)
     return rad->urad_val.vrad_symbprim;
   if (rad->urad_val.vrad_nbsec == 0)
     return NULL;
-  int pos = mi_indice_radical_symbole_secondaire (rad, ind);
-  assert (pos < (int) rad->urad_val.vrad_tailsec);
-  if (pos < 0)
-    return NULL;
-  Mit_Symbole *sy = rad->urad_val.vrad_tabsecsym[pos];
-  if (sy && sy != MI_TROU_SYMBOLE)
-    {
-      assert (sy->mi_type == MiTy_Symbole);
-      return sy;
-    }
-  return NULL;
+  return mi_secondaire_chercher (rad, ind);
 }				/* fin de mi_trouver_symbole_nom */
 
 
@@ -785,22 +1362,11 @@ mi_trouver_symbole (const char *ch, const char **pfin)
         *pfin = ch + strlen (ch);
       return sy;
     }
-  // si ça rentre utiliser un tampon sur la pile
   char *fin = NULL;
   unsigned ind = strtol (pe + 1, &fin, 10);
   if (fin == pe + 1)
     return NULL;
-  char tamp[80];
-  char *chn =
-    (pe - ch < (int) sizeof (tamp) - 3) ? tamp : malloc (2 + pe - ch);
-  if (!chn)
-    MI_FATALPRINTF ("pas de place pour tampon de %d octets (%s)",
-                    (int) (pe - ch), strerror (errno));
-  memset (chn, 0, 2 + pe - ch);
-  strncpy (chn, ch, pe - ch);
-  Mit_Symbole *sy = mi_trouver_symbole_chaine (chn, ind);
-  if (chn != tamp)
-    free (chn);
+  Mit_Symbole *sy = mi_trouver_symbole_octets (ch, pe - ch, ind);
   if (sy && pfin)
     *pfin = fin;
   return sy;
@@ -819,6 +1385,92 @@ mi_hashage_symbole_indice (const Mit_Chaine *nom, unsigned ind)
   return h;
 }				/* fin mi_hashage_symbole_indice */
 
+/// chaque symbole reçoit à sa création un identifiant dense, pour les
+/// cartes de bits des grands ensembles et les tables indexées par
+/// symbole; l'identifiant 0 est réservé. Les identifiants des
+/// symboles libérés par le ramasse-miettes sont recyclés, les plus
+/// récemment libérés d'abord.
+static struct
+{
+  uint32_t ids_nb;		// le prochain identifiant jamais donné
+  uint32_t ids_taille;		// taille allouée de ids_tab
+  Mit_Symbole **ids_tab;	// symboles par identifiant
+  uint32_t ids_nblibres;	// nombre d'identifiants recyclables
+  uint32_t ids_taillibres;	// taille allouée de ids_libres
+  uint32_t *ids_libres;		// pile des identifiants recyclables
+} mi_idents;
+
+static void
+mi_symbole_donner_ident (Mit_Symbole *sy)
+{
+  assert (sy && sy->mi_type == MiTy_Symbole && sy->mi_ident == 0);
+  if (mi_idents.ids_nblibres > 0)
+    {
+      uint32_t id = mi_idents.ids_libres[--mi_idents.ids_nblibres];
+      assert (id > 0 && id < mi_idents.ids_nb && !mi_idents.ids_tab[id]);
+      sy->mi_ident = id;
+      mi_idents.ids_tab[id] = sy;
+      return;
+    }
+  if (mi_idents.ids_nb == 0)
+    mi_idents.ids_nb = 1;
+  if (mi_idents.ids_nb >= mi_idents.ids_taille)
+    {
+      uint32_t nouvtail = 2 * mi_idents.ids_taille + 1000;
+      Mit_Symbole **nouvtab =
+        realloc (mi_idents.ids_tab, nouvtail * sizeof (Mit_Symbole *));
+      if (!nouvtab)
+        MI_FATALPRINTF ("impossible d'agrandir la table des identifiants"
+                        " à %u (%s)", (unsigned) nouvtail, strerror (errno));
+      memset (nouvtab + mi_idents.ids_taille, 0,
+              (nouvtail - mi_idents.ids_taille) * sizeof (Mit_Symbole *));
+      mi_idents.ids_tab = nouvtab;
+      mi_idents.ids_taille = nouvtail;
+    }
+  sy->mi_ident = mi_idents.ids_nb++;
+  mi_idents.ids_tab[sy->mi_ident] = sy;
+}				/* fin mi_symbole_donner_ident */
+
+void
+mi_symbole_oublier_ident (Mit_Symbole *sy)
+{
+  if (!sy || sy->mi_type != MiTy_Symbole || sy->mi_ident == 0)
+    return;
+  uint32_t id = sy->mi_ident;
+  if (id >= mi_idents.ids_nb || mi_idents.ids_tab[id] != sy)
+    MI_FATALPRINTF ("symbole @%p d'identifiant %u corrompu",
+                    (void *) sy, (unsigned) id);
+  if (mi_idents.ids_nblibres >= mi_idents.ids_taillibres)
+    {
+      uint32_t nouvtail = 2 * mi_idents.ids_taillibres + 256;
+      uint32_t *nouvlib =
+        realloc (mi_idents.ids_libres, nouvtail * sizeof (uint32_t));
+      if (!nouvlib)
+        MI_FATALPRINTF ("impossible d'agrandir la pile des identifiants"
+                        " libres à %u (%s)", (unsigned) nouvtail,
+                        strerror (errno));
+      mi_idents.ids_libres = nouvlib;
+      mi_idents.ids_taillibres = nouvtail;
+    }
+  mi_idents.ids_tab[id] = NULL;
+  mi_idents.ids_libres[mi_idents.ids_nblibres++] = id;
+  sy->mi_ident = 0;
+}				/* fin mi_symbole_oublier_ident */
+
+Mit_Symbole *
+mi_symbole_par_ident (uint32_t id)
+{
+  if (id == 0 || id >= mi_idents.ids_nb)
+    return NULL;
+  return mi_idents.ids_tab[id];
+}				/* fin mi_symbole_par_ident */
+
+uint32_t
+mi_symbole_borne_ident (void)
+{
+  return mi_idents.ids_nb ? mi_idents.ids_nb : 1;
+}				/* fin mi_symbole_borne_ident */
+
 unsigned
 mi_hashage_nom_indice (const char *nom, unsigned ind)
 {
@@ -840,29 +1492,14 @@ mi_cmp_symbole (const Mit_Symbole *sy1, const Mit_Symbole *sy2)
     return -1;
   if (!sy2 || sy2->mi_type != MiTy_Symbole)
     return 1;
-  const struct MiSt_Radical_st *rad1 = sy1->mi_radical;
-  const struct MiSt_Radical_st *rad2 = sy2->mi_radical;
-  assert (rad1 && rad1->urad_nmagiq == MI_RAD_NMAGIQ);
-  assert (rad2 && rad2->urad_nmagiq == MI_RAD_NMAGIQ);
-  const Mit_Chaine *nom1 = rad1->urad_nom;
-  const Mit_Chaine *nom2 = rad2->urad_nom;
-  assert (nom1 && nom1->mi_type == MiTy_Chaine);
-  assert (nom2 && nom2->mi_type == MiTy_Chaine);
-  if (rad1 != rad2)
-    {
-      int cmp = strcmp (nom1->mi_car, nom2->mi_car);
-      if (cmp < 0)
-        return -1;
-      else if (cmp > 0)
-        return 1;
-    }
-  if (sy1->mi_indice < sy2->mi_indice)
+  uint64_t c1 = mi_cle_symbole (sy1), c2 = mi_cle_symbole (sy2);
+  if (c1 < c2)
     return -1;
-  if (sy1->mi_indice > sy2->mi_indice)
-    return +1;
+  if (c1 > c2)
+    return 1;
   MI_FATALPRINTF
   ("symboles corrompus differents mais de même noms %s et indice %u",
-   nom1->mi_car, sy1->mi_indice);
+   mi_symbole_chaine (sy1), sy1->mi_indice);
 }
 
 int
@@ -894,31 +1531,18 @@ mi_radical_nom (const struct MiSt_Radical_st *rad)
 }				/* fin mi_radical_nom */
 
 typedef bool mi_iterradical_sigt (struct MiSt_Radical_st *rad, void *client);
+// parcourt les radicaux dans l'ordre des noms, le long des feuilles,
+// jusqu'à ce que f renvoie vrai
 static struct MiSt_Radical_st *
-mi_parcourir_radical (struct MiSt_Radical_st *rad, mi_iterradical_sigt * f,
-                      void *client)
+mi_parcourir_radical (mi_iterradical_sigt * f, void *client)
 {
-  if (!rad)
-    return NULL;
-  assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-  struct MiSt_Radical_st *r = NULL;
-  r = rad->urad_gauche;
-  if (r)
-    {
-      assert (r->urad_nmagiq == MI_RAD_NMAGIQ);
-      r = mi_parcourir_radical (r, f, client);
-      if (r)
-        return r;
-    }
-  if ((*f) (rad, client))
-    return rad;
-  r = rad->urad_droit;
-  if (r)
+  for (struct Mi_NoeudRadicaux_st * fe = mi_premiere_feuille_radicaux;
+       fe != NULL; fe = fe->nrad_suiv)
     {
-      assert (r->urad_nmagiq == MI_RAD_NMAGIQ);
-      r = mi_parcourir_radical (r, f, client);
-      if (r)
-        return r;
+      assert (fe->nrad_nmagiq == MI_NOEUDRAD_NMAGIQ && fe->nrad_feuille);
+      for (unsigned ix = 0; ix < fe->nrad_nb; ix++)
+        if ((*f) (fe->nrad_cle[ix], client))
+          return fe->nrad_cle[ix];
     }
   return NULL;
 }
@@ -943,8 +1567,7 @@ mi_iterer_symbole_primaire (mi_itersymb_sigt * f, void *client)
   if (!f)
     return;
   struct Mi_parcours_radical_primaire_st prp = { f, client };
-  mi_parcourir_radical (mi_racine_radical, mi_parcourir_radical_primaire,
-                        &prp);
+  mi_parcourir_radical (mi_parcourir_radical_primaire, &prp);
 }				/* fin mi_iterer_symbole_primaire */
 
 
@@ -957,19 +1580,9 @@ mi_iterer_symbole_radical (const struct MiSt_Radical_st *rad,
   assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
   if ((*f) (rad->urad_val.vrad_symbprim, client))
     return;
-  unsigned t = rad->urad_val.vrad_tailsec;
-  if (t > 0)
-    {
-      assert (rad->urad_val.vrad_tabsecsym != NULL);
-      for (unsigned ix = 0; ix < t; ix++)
-        {
-          Mit_Symbole *sy = rad->urad_val.vrad_tabsecsym[ix];
-          if (!sy || sy == MI_TROU_SYMBOLE)
-            continue;
-          if ((*f) (sy, client))
-            return;
-        }
-    }
+  for (Mit_Symbole * sy = rad->urad_val.vrad_premsec; sy; sy = sy->mi_secsuiv)
+    if ((*f) (sy, client))
+      return;
 }				/* fin mi_iterer_symbole_radical */
 
 static bool
@@ -978,19 +1591,9 @@ mi_parcourir_radical_nomme (struct MiSt_Radical_st *rad, void *client)
   struct Mi_parcours_radical_primaire_st *prp = client;
   if ((*prp->prp_f) (rad->urad_val.vrad_symbprim, prp->prp_client))
     return true;
-  unsigned t = rad->urad_val.vrad_tailsec;
-  if (t > 0)
-    {
-      assert (rad->urad_val.vrad_tabsecsym != NULL);
-      for (unsigned ix = 0; ix < t; ix++)
-        {
-          Mit_Symbole *sy = rad->urad_val.vrad_tabsecsym[ix];
-          if (!sy || sy == MI_TROU_SYMBOLE)
-            continue;
-          if ((*prp->prp_f) (sy, prp->prp_client))
-            return true;
-        }
-    }
+  for (Mit_Symbole * sy = rad->urad_val.vrad_premsec; sy; sy = sy->mi_secsuiv)
+    if ((*prp->prp_f) (sy, prp->prp_client))
+      return true;
   return false;
 }
 
@@ -1003,130 +1606,10 @@ mi_iterer_symbole_nomme (const char *ch, mi_itersymb_sigt * f, void *client)
   if (!mi_nom_licite_chaine (ch))
     return;
   struct Mi_parcours_radical_primaire_st prp = { f, client };
-  mi_parcourir_radical (mi_racine_radical, mi_parcourir_radical_nomme, &prp);
+  mi_parcourir_radical (mi_parcourir_radical_nomme, &prp);
 }				// fin mi_iterer_symbole_nomme
 
 
-static int
-mi_indice_radical_symbole_secondaire (struct MiSt_Radical_st *rad,
-                                      unsigned ind)
-{
-  assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
-  const Mit_Chaine *nomr = rad->urad_nom;
-  assert (nomr && nomr->mi_type == MiTy_Chaine);
-  unsigned h = mi_hashage_symbole_indice (nomr, ind);
-  if (!rad->urad_val.vrad_tabsecsym)
-    {
-      assert (!rad->urad_val.vrad_tailsec);
-      unsigned ta = 7;
-      rad->urad_val.vrad_tabsecsym = calloc (ta, sizeof (Mit_Symbole *));
-      if (!rad->urad_val.vrad_tabsecsym)
-        MI_FATALPRINTF ("impossible d'allouer table de symboles"
-                        "secondaires de %d nom %s (%s)",
-                        ta, nomr->mi_car, strerror (errno));
-      rad->urad_val.vrad_tailsec = ta;
-      rad->urad_val.vrad_nbsec = 0;
-    }
-  unsigned ta = rad->urad_val.vrad_tailsec;
-  assert (ta > 2);
-  unsigned debix = h % rad->urad_val.vrad_tailsec;
-  int pos = -1;
-  for (unsigned ix = debix; ix < ta; ix++)
-    {
-      const Mit_Symbole *sy = rad->urad_val.vrad_tabsecsym[ix];
-      if (!sy)
-        {
-          if (pos < 0)
-            pos = (int) ix;
-          return pos;
-        }
-      else if (sy == MI_TROU_SYMBOLE)
-        {
-          if (pos < 0)
-            pos = (int) ix;
-          continue;
-        }
-      assert (sy->mi_radical == rad);
-      if (sy->mi_indice == ind)
-        return (int) ix;
-    }
-  for (unsigned ix = 0; ix < debix; ix++)
-    {
-      const Mit_Symbole *sy = rad->urad_val.vrad_tabsecsym[ix];
-      if (!sy)
-        {
-          if (pos < 0)
-            pos = (int) ix;
-          return pos;
-        }
-      else if (sy == MI_TROU_SYMBOLE)
-        {
-          if (pos < 0)
-            pos = (int) ix;
-          continue;
-        }
-      assert (sy->mi_radical == rad);
-      if (sy->mi_indice == ind)
-        return (int) ix;
-    }
-  return pos;
-}				/* fin mi_indice_radical_symbole_secondaire */
-
-
-void
-mi_agrandir_radical_table_secondaire (struct MiSt_Radical_st *rad,
-                                      unsigned xtra)
-{
-  assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
-  if (!rad->urad_val.vrad_tabsecsym)
-    {
-      unsigned ta = mi_nombre_premier_apres (9 * xtra / 8 + 5);
-      rad->urad_val.vrad_tabsecsym = calloc (ta, sizeof (Mit_Symbole *));
-      if (!rad->urad_val.vrad_tabsecsym)
-        MI_FATALPRINTF
-        ("impossible d'allouer table de symboles secondaire de %d nom %s (%s)",
-         ta, rad->urad_nom->mi_car, strerror (errno));
-      rad->urad_val.vrad_tailsec = ta;
-      rad->urad_val.vrad_nbsec = 0;
-    }
-  else if (5 * rad->urad_val.vrad_nbsec + 4 * xtra >
-           rad->urad_val.vrad_tailsec)
-    {
-      unsigned ancnb = rad->urad_val.vrad_nbsec;
-      unsigned ta =
-        mi_nombre_premier_apres (4 * (rad->urad_val.vrad_nbsec + xtra) / 3 +
-                                 rad->urad_val.vrad_nbsec / 32 + 5);
-      if (ta > rad->urad_val.vrad_tailsec)
-        {
-          Mit_Symbole **anctab = rad->urad_val.vrad_tabsecsym;
-          unsigned anctail = rad->urad_val.vrad_tailsec;
-          rad->urad_val.vrad_tabsecsym = calloc (ta, sizeof (Mit_Symbole *));
-          if (!rad->urad_val.vrad_tabsecsym)
-            MI_FATALPRINTF
-            ("impossible d'allouer table de symboles secondaire de %d nom %s (%s)",
-             ta, rad->urad_nom->mi_car, strerror (errno));
-          rad->urad_val.vrad_tailsec = ta;
-          rad->urad_val.vrad_nbsec = 0;
-          for (unsigned ix = 0; ix < anctail; ix++)
-            {
-              Mit_Symbole *ancsy = anctab[ix];
-              if (!ancsy || ancsy == MI_TROU_SYMBOLE)
-                continue;
-              assert (ancsy->mi_type == MiTy_Symbole
-                      && ancsy->mi_radical == rad);
-              assert (ancsy->mi_indice > 0);
-              int pos =
-                mi_indice_radical_symbole_secondaire (rad, ancsy->mi_indice);
-              assert (pos >= 0 && pos < (int) ta
-                      && rad->urad_val.vrad_tabsecsym[pos] == NULL);
-              rad->urad_val.vrad_tabsecsym[pos] = ancsy;
-              rad->urad_val.vrad_nbsec++;
-            }
-          assert (rad->urad_val.vrad_nbsec == ancnb);
-        }
-    }
-}				/* fin mi_agrandir_radical_table_secondaire */
-
 // Créer ou trouver un symbole de radical et indice donnés
 Mit_Symbole *
 mi_creer_symbole_radical (struct MiSt_Radical_st *rad, unsigned ind)
@@ -1137,22 +1620,19 @@ mi_creer_symbole_radical (struct MiSt_Radical_st *rad, unsigned ind)
   assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
   if (ind)
     {
-      if (5 * rad->urad_val.vrad_nbsec + 2 >= 4 * rad->urad_val.vrad_tailsec)
-        mi_agrandir_radical_table_secondaire (rad,
-                                              2 +
-                                              rad->urad_val.vrad_nbsec / 32);
-      int pos = mi_indice_radical_symbole_secondaire (rad, ind);
-      assert (pos >= 0 && pos < (int) rad->urad_val.vrad_tailsec);
-      Mit_Symbole *ancsy = rad->urad_val.vrad_tabsecsym[pos];
-      if (!ancsy || ancsy == MI_TROU_SYMBOLE)
+      Mit_Symbole *ancsy = mi_secondaire_chercher (rad, ind);
+      if (!ancsy)
         {
           Mit_Symbole *sy =
             mi_allouer_valeur (MiTy_Symbole, sizeof (Mit_Symbole));
           sy->mi_radical = rad;
           sy->mi_indice = ind;
+          sy->mi_rang = rad->urad_rang;
           sy->mi_hash = mi_hashage_symbole_indice (rad->urad_nom, ind);
-          rad->urad_val.vrad_tabsecsym[pos] = sy;
-          rad->urad_val.vrad_nbsec++;
+          mi_symbole_donner_ident (sy);
+          mi_secondaire_ajouter (sy);
+          if (ind >= rad->urad_val.vrad_prochind)
+            rad->urad_val.vrad_prochind = ind + 1;
           return sy;
         }
       else
@@ -1170,7 +1650,9 @@ mi_creer_symbole_radical (struct MiSt_Radical_st *rad, unsigned ind)
           rad->urad_val.vrad_symbprim = sy;
           sy->mi_radical = rad;
           sy->mi_indice = 0;
+          sy->mi_rang = rad->urad_rang;
           sy->mi_hash = mi_hashage_symbole_indice (rad->urad_nom, 0);
+          mi_symbole_donner_ident (sy);
         }
       return sy;
     }
@@ -1191,37 +1673,150 @@ mi_creer_symbole_nom (const Mit_Chaine *nom, unsigned ind)
 Mit_Symbole *
 mi_creer_symbole_chaine (const char *ch, unsigned ind)
 {
-  if (!mi_nom_licite_chaine (ch))
+  if (!ch)
     return NULL;
-  struct MiSt_Radical_st *rad = mi_radical_insere_chaine (ch);
-  return mi_creer_symbole_radical (rad, ind);
+  return mi_creer_symbole_octets (ch, strlen (ch), ind);
 }				/* fin mi_creer_symbole_chaine */
 
+Mit_Symbole *
+mi_creer_symbole_octets (const char *oct, unsigned nb, unsigned ind)
+{
+  if (!mi_nom_licite_octets (oct, nb))
+    return NULL;
+  struct MiSt_Radical_st *rad = mi_radical_insere_octets (oct, nb);
+  return mi_creer_symbole_radical (rad, ind);
+}				/* fin mi_creer_symbole_octets */
+
 
 
 Mit_Symbole *
 mi_trouver_symbole_chaine (const char *ch, unsigned ind)
 {
-  struct MiSt_Radical_st *rad = mi_trouver_radical_chaine (ch);
+  if (!ch)
+    return NULL;
+  return mi_trouver_symbole_octets (ch, strlen (ch), ind);
+}				/* fin mi_trouver_symbole_chaine */
+
+Mit_Symbole *
+mi_trouver_symbole_octets (const char *oct, unsigned nb, unsigned ind)
+{
+  struct MiSt_Radical_st *rad = mi_trouver_radical_octets (oct, nb);
   if (!rad)
     return NULL;
   if (ind == 0)
     return rad->urad_val.vrad_symbprim;
   if (rad->urad_val.vrad_nbsec == 0)
     return NULL;
-  int pos = mi_indice_radical_symbole_secondaire (rad, ind);
-  assert (pos >= 0 && pos < (int) rad->urad_val.vrad_tailsec);
-  Mit_Symbole *sy = rad->urad_val.vrad_tabsecsym[pos];
-  if (sy && sy != MI_TROU_SYMBOLE)
-    {
-      assert (sy->mi_type == MiTy_Symbole);
-      return sy;
-    }
-  return NULL;
-}				/* fin mi_trouver_symbole_chaine */
-
+  return mi_secondaire_chercher (rad, ind);
+}				/* fin mi_trouver_symbole_octets */
 
 
+// crée nb symboles secondaires d'un radical jetable, qui n'existait
+// pas encore, en vérifiant après chaque ajout le nouveau symbole et
+// deux anciens, à tour de rôle, même pendant la migration de la table
+// des secondaires; tous sont revérifiés à la fin, puis détruits, ce
+// qui doit vider le cache des opérations sur leurs ensembles
+void
+mi_verifier_secondaires (unsigned nb)
+{
+  char nom[48];
+  unsigned num = 0;
+  do
+    snprintf (nom, sizeof (nom), "verificationsecondaires%u", num++);
+  while (mi_trouver_radical_octets (nom, strlen (nom)));
+  Mit_Symbole **tabsy = calloc (nb + 1, sizeof (Mit_Symbole *));
+  if (!tabsy)
+    MI_FATALPRINTF ("impossible d'allouer %u symboles (%s)", nb,
+                    strerror (errno));
+  // tabsy[ind-1] est le symbole d'indice ind
+  unsigned revu = 0;
+  for (unsigned ind = 1; ind <= nb; ind++)
+    {
+      tabsy[ind - 1] = mi_creer_symbole_chaine (nom, ind);
+      if (!tabsy[ind - 1])
+        MI_FATALPRINTF ("impossible de créer %s_%u", nom, ind);
+      for (unsigned k = 0; k < 3; k++)
+        {
+          unsigned ix = k ? (revu++ % ind) + 1 : ind;
+          if (mi_trouver_symbole_chaine (nom, ix) != tabsy[ix - 1])
+            MI_FATALPRINTF ("après l'ajout de %s_%u, %s_%u est perdu",
+                            nom, ind, nom, ix);
+        }
+    }
+  for (unsigned ix = 1; ix <= nb; ix++)
+    if (mi_trouver_symbole_chaine (nom, ix) != tabsy[ix - 1])
+      MI_FATALPRINTF ("%s_%u est perdu", nom, ix);
+  // les ensembles des indices pairs et impairs, et leurs union et
+  // intersection, mémorisées; un budget nul les évince, puis elles
+  // sont mémorisées à nouveau
+  unsigned nbpair = 0, nbimp = 0;
+  Mit_Symbole **tabens = calloc (nb + 1, sizeof (Mit_Symbole *));
+  if (!tabens)
+    MI_FATALPRINTF ("impossible d'allouer %u symboles (%s)", nb,
+                    strerror (errno));
+  for (unsigned ix = 0; ix < nb; ix++)
+    if (ix % 2)
+      tabens[nb / 2 + 1 + nbimp++] = tabsy[ix];
+    else
+      tabens[nbpair++] = tabsy[ix];
+  const Mit_Ensemble *enpair =
+    mi_creer_ensemble_symboles (nbpair, (const Mit_Symbole **) tabens);
+  const Mit_Ensemble *enimp =
+    mi_creer_ensemble_symboles (nbimp, (const Mit_Symbole **) tabens
+                                + nb / 2 + 1);
+  free (tabens);
+  struct Mi_StatMemo_st st = { };
+  for (int passe = 0; passe < 2; passe++)
+    {
+      mi_ensemble_union (enpair, enimp);
+      mi_ensemble_intersection (enpair, enimp);
+      if (passe == 0)
+        {
+          size_t budget = mi_memo_ensembles_budget (0);
+          mi_memo_ensembles_stat (&st);
+          if (st.sm_nombre != 0 || st.sm_octets != 0)
+            MI_FATALPRINTF ("un budget nul laisse %u entrées dans le cache",
+                            st.sm_nombre);
+          mi_memo_ensembles_budget (budget);
+        }
+    }
+  mi_memo_ensembles_stat (&st);
+  unsigned nbmemo = st.sm_nombre;
+  mi_detruire_symboles (nb, tabsy);
+  mi_memo_ensembles_stat (&st);
+  if (st.sm_nombre != 0 || st.sm_octets != 0)
+    MI_FATALPRINTF ("après la destruction de %s, %u entrées dans le cache",
+                    nom, st.sm_nombre);
+  for (unsigned ix = 1; ix <= nb; ix++)
+    if (mi_trouver_symbole_chaine (nom, ix))
+      MI_FATALPRINTF ("%s_%u détruit est encore trouvé", nom, ix);
+  free (tabsy);
+  printf ("%u symboles secondaires %s vérifiés puis détruits,"
+          " %u opérations mémorisées oubliées\n", nb, nom, nbmemo);
+}				/* fin mi_verifier_secondaires */
+
+
+
+
+// un indice secondaire libre pour un clone: un indice rendu s'il en
+// reste un encore libre, sinon le prochain jamais utilisé
+static unsigned
+mi_radical_indice_clone (struct MiSt_Radical_st *rad)
+{
+  struct MiSt_ValeurRadical_st *vr = &rad->urad_val;
+  while (vr->vrad_nblibres > 0)
+    {
+      unsigned ind = vr->vrad_indlibres[--vr->vrad_nblibres];
+      // il a pu être repris par mi_creer_symbole_radical
+      if (!mi_secondaire_chercher (rad, ind))
+        return ind;
+    }
+  if (vr->vrad_prochind < MI_INDICE_CLONE_MIN)
+    vr->vrad_prochind = MI_INDICE_CLONE_MIN;
+  if (vr->vrad_prochind == UINT_MAX)
+    MI_FATALPRINTF ("plus d'indice pour cloner %s", rad->urad_nom->mi_car);
+  return vr->vrad_prochind++;
+}				/* fin mi_radical_indice_clone */
 
 Mit_Symbole *
 mi_cloner_symbole (const Mit_Symbole *origsy)
@@ -1230,37 +1825,94 @@ mi_cloner_symbole (const Mit_Symbole *origsy)
     return NULL;
   struct MiSt_Radical_st *rad = origsy->mi_radical;
   assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
-  if (rad->urad_val.vrad_tailsec == 0)
-    mi_agrandir_radical_table_secondaire (rad, 7);
-  else if (5 * rad->urad_val.vrad_nbsec + 2 > 4 * rad->urad_val.vrad_tailsec)
-    mi_agrandir_radical_table_secondaire (rad,
-                                          rad->urad_val.vrad_nbsec / 4 + 10);
-  unsigned ind = 0;
-  int pos = -1;
-  do
-    {
-      pos = -1;
-      unsigned i = random ();
-      if (i < 10)
-        continue;
-      pos = mi_indice_radical_symbole_secondaire (rad, i);
-      assert (pos >= 0 && pos < (int) rad->urad_val.vrad_tailsec);
-      Mit_Symbole *sy = rad->urad_val.vrad_tabsecsym[pos];
-      if (!sy || sy == MI_TROU_SYMBOLE)
-        ind = i;
-      else if (sy->mi_indice == i)
-        continue;
-    }
-  while (ind == 0);
+  unsigned ind = mi_radical_indice_clone (rad);
+  assert (!mi_secondaire_chercher (rad, ind));
   Mit_Symbole *sy = mi_allouer_valeur (MiTy_Symbole, sizeof (Mit_Symbole));
   sy->mi_radical = rad;
   sy->mi_indice = ind;
+  sy->mi_rang = rad->urad_rang;
   sy->mi_hash = mi_hashage_symbole_indice (rad->urad_nom, ind);
-  rad->urad_val.vrad_tabsecsym[pos] = sy;
-  rad->urad_val.vrad_nbsec++;
+  mi_symbole_donner_ident (sy);
+  mi_secondaire_ajouter (sy);
   return sy;
 }				/* fin mi_cloner_symbole */
 
+void
+mi_radical_oublier_symbole (Mit_Symbole *sy)
+{
+  if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole
+      || sy->mi_indice == 0)
+    return;
+  struct MiSt_Radical_st *rad = sy->mi_radical;
+  assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
+  struct MiSt_ValeurRadical_st *vr = &rad->urad_val;
+  if (vr->vrad_nbsec == 0 || !mi_secondaire_oter (sy))
+    return;
+  if (sy->mi_indice < MI_INDICE_CLONE_MIN)
+    return;
+  if (vr->vrad_nblibres >= vr->vrad_taillibres)
+    {
+      unsigned nouvtail = 2 * vr->vrad_taillibres + 8;
+      unsigned *nouvlib =
+        realloc (vr->vrad_indlibres, nouvtail * sizeof (unsigned));
+      if (!nouvlib)
+        MI_FATALPRINTF ("impossible d'agrandir les indices libres de %s (%s)",
+                        rad->urad_nom->mi_car, strerror (errno));
+      vr->vrad_indlibres = nouvlib;
+      vr->vrad_taillibres = nouvtail;
+    }
+  vr->vrad_indlibres[vr->vrad_nblibres++] = sy->mi_indice;
+}				/* fin mi_radical_oublier_symbole */
+
+/// détruit les nb symboles de tab, que plus rien ne référence: les
+/// secondaires sont ôtés de leur radical, le cache des opérations
+/// d'ensembles est vidé, les tuples et ensembles partagés qui les
+/// contiennent sont oubliés, leur identifiant est rendu, et chacun
+/// est libéré. Ce sont des symboles nus, sans attributs,
+/// composants ni charge.
+void
+mi_detruire_symboles (unsigned nb, Mit_Symbole **tab)
+{
+  if (nb > 0 && !tab)
+    return;
+  for (unsigned ix = 0; ix < nb; ix++)
+    {
+      Mit_Symbole *sy = tab[ix];
+      if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole)
+        MI_FATALPRINTF ("pas un symbole à détruire en #%u", ix);
+      if (sy->mi_predef || sy->mi_attrs || sy->mi_comps || sy->mi_chaptr)
+        MI_FATALPRINTF ("symbole %s non nu, impossible à détruire",
+                        mi_symbole_chaine (sy));
+    }
+  // le cache des opérations d'ensembles garde en vie des ensembles
+  // qui peuvent les contenir
+  mi_memo_ensembles_vider ();
+  // les tuples et ensembles partagés qui les contiennent ne doivent
+  // plus être retrouvés
+  if (mi_partage_compte () > 0)
+    {
+      struct Mi_EnsHash_st eh = { };
+      mi_enshash_initialiser (&eh, 4 * nb / 3 + 5);
+      for (unsigned ix = 0; ix < nb; ix++)
+        mi_enshash_ajouter (&eh, tab[ix]);
+      mi_partage_oublier_symboles (&eh);
+      mi_enshash_detruire (&eh);
+    }
+  // les plus récents d'abord, ils sont en fin de la table des valeurs
+  for (unsigned ix = nb; ix > 0; ix--)
+    {
+      Mit_Symbole *sy = tab[ix - 1];
+      struct MiSt_Radical_st *rad = sy->mi_radical;
+      if (sy->mi_indice > 0)
+        mi_radical_oublier_symbole (sy);
+      else if (rad->urad_val.vrad_symbprim == sy)
+        rad->urad_val.vrad_symbprim = NULL;
+      mi_symbole_oublier_ident (sy);
+      mi_liberer_valeur_fraiche (sy);
+      tab[ix - 1] = NULL;
+    }
+}				/* fin mi_detruire_symboles */
+
 
 
 // ... et avec le drapeau présent si trouvé
@@ -1308,50 +1960,37 @@ mi_symbole_enlever_attribut (Mit_Symbole *symb, Mit_Symbole *symbat)
 
 
 static void
-mi_impr_radical (const struct MiSt_Radical_st *rad, int prof)
+mi_impr_noeud_radicaux (const struct Mi_NoeudRadicaux_st *nd, int prof)
 {
-  if (!rad)
+  if (!nd)
     return;
-  assert (rad->urad_nmagiq == MI_RAD_NMAGIQ);
-  assert (rad->urad_nom != NULL && rad->urad_nom->mi_type == MiTy_Chaine);
-  bool feuille = rad->urad_gauche == NULL && rad->urad_droit == NULL;
+  assert (nd->nrad_nmagiq == MI_NOEUDRAD_NMAGIQ);
   for (int ix = 0; ix < prof; ix++)
     putchar (' ');
-  printf ("%s%c%srad@%p '%s'", MI_TERMINAL_GRAS, feuille ? '*' : '+',
-          MI_TERMINAL_NORMAL, rad, rad->urad_nom->mi_car);
-  switch (rad->urad_couleur)
+  printf ("%s%c%snoeud@%p #%d", MI_TERMINAL_GRAS,
+          nd->nrad_feuille ? '*' : '+', MI_TERMINAL_NORMAL, nd,
+          (int) nd->nrad_nb);
+  if (nd->nrad_parent)
+    printf (" par@%p", (void *) nd->nrad_parent);
+  if (nd->nrad_feuille)
+    printf (" prec@%p suiv@%p", (void *) nd->nrad_prec,
+            (void *) nd->nrad_suiv);
+  putchar ('\n');
+  for (unsigned ix = 0; ix <= nd->nrad_nb; ix++)
     {
-    case crad_noir:
-      printf (" %s*NOIR*%s", MI_TERMINAL_ITALIQUE, MI_TERMINAL_NORMAL);
-      break;
-    case crad_rouge:
-      printf (" %s*ROUGE*%s", MI_TERMINAL_ITALIQUE, MI_TERMINAL_NORMAL);
-      break;
-    default:
-      printf (" *?%d?*", (int) rad->urad_couleur);
-      break;
+      if (!nd->nrad_feuille)
+        mi_impr_noeud_radicaux (nd->nrad_fils[ix], prof + 1);
+      if (ix == nd->nrad_nb)
+        break;
+      const struct MiSt_Radical_st *rad = nd->nrad_cle[ix];
+      assert (rad && rad->urad_nmagiq == MI_RAD_NMAGIQ);
+      for (int iy = 0; iy < prof; iy++)
+        putchar (' ');
+      printf ("%s%c%srad@%p '%s' rang %u\n", MI_TERMINAL_GRAS,
+              nd->nrad_feuille ? '-' : '/', MI_TERMINAL_NORMAL, rad,
+              rad->urad_nom->mi_car, (unsigned) rad->urad_rang);
     }
-  if (!feuille)
-    printf (" gch@%p drt@%p", (void *) rad->urad_gauche,
-            (void *) rad->urad_droit);
-  if (rad->urad_parent)
-    printf (" par@%p", (void *) rad->urad_parent);
-  putchar ('\n');
-  if (feuille)
-    return;
-  mi_impr_radical (rad->urad_gauche, prof + 1);
-  for (int ix = 0; ix < prof; ix++)
-    putchar (' ');
-  printf ("%s/%srad@%p '%s'", MI_TERMINAL_GRAS, MI_TERMINAL_NORMAL, rad,
-          rad->urad_nom->mi_car);
-  putchar ('\n');
-  mi_impr_radical (rad->urad_droit, prof + 1);
-  for (int ix = 0; ix < prof; ix++)
-    putchar (' ');
-  printf ("%s-%srad@%p '%s'", MI_TERMINAL_GRAS, MI_TERMINAL_NORMAL, rad,
-          rad->urad_nom->mi_car);
-  putchar ('\n');
-}				// fin mi_impr_radical
+}				// fin mi_impr_noeud_radicaux
 
 
 void
@@ -1359,10 +1998,10 @@ mi_afficher_radicaux_en (const char *fich, int lin, const char *msg)
 {
   static int count;
   count++;
-  printf ("%saffichage des radicaux %s #%d%s; %s:%d mi_racine_radical@%p\n",
+  printf ("%saffichage des radicaux %s #%d%s; %s:%d mi_racine_radicaux@%p\n",
           MI_TERMINAL_GRAS, msg,
-          count, MI_TERMINAL_NORMAL, fich, lin, (void *) mi_racine_radical);
-  mi_impr_radical (mi_racine_radical, 0);
+          count, MI_TERMINAL_NORMAL, fich, lin, (void *) mi_racine_radicaux);
+  mi_impr_noeud_radicaux (mi_racine_radicaux, 0);
   fputc ('\n', stdout);
 }				// fin mi_afficher_radicaux_en
 
@@ -1401,28 +2040,23 @@ mi_ajouter_attribut_dans_table (const Mit_Symbole *sy, const Mit_Val va
 }				// fin mi_ajouter_attribut_dans_table
 
 void
-mi_afficher_contenu_symbole (FILE * fi, const Mit_Symbole *sy)
+mi_imprimeur_contenu_symbole (struct Mi_Imprimeur_st *im,
+                              const Mit_Symbole *sy, bool terminal)
 {
-  if (!fi)
-    return;
+  assert (im && im->imp_nmagiq == MI_IMPRIMEUR_NMAGIQ);
   if (!sy || sy == MI_TROU_SYMBOLE)
     return;
   assert (sy->mi_type == MiTy_Symbole);
-  fputc ('\n', fi);
-  char tampind[16];
-  fprintf (fi, "%s**%s", (fi == stdout) ? MI_TERMINAL_GRAS : "",
-           (fi == stdout) ? MI_TERMINAL_NORMAL : "");
-  fprintf (fi, " %s%s%s%s %s@%p%s %s",
-           (fi == stdout) ? MI_TERMINAL_GRAS : "",
-           mi_symbole_chaine (sy), mi_symbole_indice_ch (tampind, sy),
-           (fi == stdout) ? MI_TERMINAL_NORMAL : "",
-           (fi == stdout) ? MI_TERMINAL_ITALIQUE : "",
-           (void *) sy,
-           (fi == stdout) ? MI_TERMINAL_NORMAL : "",
-           sy->mi_predef ? "prédefini" : "normal");
-  fprintf (fi, " %s**%s\n",
-           (fi == stdout) ? MI_TERMINAL_GRAS : "",
-           (fi == stdout) ? MI_TERMINAL_NORMAL : "");
+  const char *gras = terminal ? MI_TERMINAL_GRAS : "";
+  const char *normal = terminal ? MI_TERMINAL_NORMAL : "";
+  mi_imprimeur_car (im, '\n');
+  mi_imprimeur_printf (im, "%s**%s %s", gras, normal, gras);
+  mi_imprimeur_symbole (im, sy);
+  mi_imprimeur_printf (im, "%s %s@%p%s %s", normal,
+                       terminal ? MI_TERMINAL_ITALIQUE : "",
+                       (void *) sy, normal,
+                       sy->mi_predef ? "prédefini" : "normal");
+  mi_imprimeur_printf (im, " %s**%s\n", gras, normal);
   unsigned nbat = mi_assoc_compte (sy->mi_attrs);
   if (nbat > 0)
     {
@@ -1441,32 +2075,48 @@ mi_afficher_contenu_symbole (FILE * fi, const Mit_Symbole *sy)
       assert (tabat->tat_compteur == nbat);
       qsort (tabat->tat_symboles, nbat, sizeof (Mit_Symbole *),
              mi_cmp_symboleptr);
-      fprintf (fi, "-- %d attributs --\n", nbat);
-      for (unsigned ix = 0; ix < nbat; ix++)
+      mi_imprimeur_printf (im, "-- %d attributs --\n", nbat);
+      for (unsigned ix = 0; ix < nbat && !im->imp_tronque; ix++)
         {
           const Mit_Symbole *syat = tabat->tat_symboles[ix];
           assert (syat != NULL && syat != MI_TROU_SYMBOLE
                   && syat->mi_type == MiTy_Symbole);
-          fprintf (fi, "* %s%s: ",
-                   mi_symbole_chaine (syat), mi_symbole_indice_ch (tampind,
-                       syat));
-          mi_afficher_valeur (fi,
-                              mi_assoc_chercher (sy->mi_attrs, syat).t_val);
+          mi_imprimeur_octets (im, "* ", 2);
+          mi_imprimeur_symbole (im, syat);
+          mi_imprimeur_octets (im, ": ", 2);
+          mi_imprimeur_valeur (im,
+                               mi_assoc_chercher (sy->mi_attrs, syat).t_val);
+          mi_imprimeur_car (im, '\n');
         }
       free (tabat), tabat = NULL;
     }
   else
-    fprintf (fi, "-- aucun attribut --\n");
+    mi_imprimeur_chaine (im, "-- aucun attribut --\n");
   unsigned nbcomp = mi_vecteur_taille (sy->mi_comps);
   if (nbcomp > 0)
     {
-      fprintf (fi, "-- %d composants --\n", nbcomp);
-      for (unsigned ix = 0; ix < nbcomp; ix++)
+      mi_imprimeur_printf (im, "-- %d composants --\n", nbcomp);
+      for (unsigned ix = 0; ix < nbcomp && !im->imp_tronque; ix++)
         {
-          fprintf (fi, "[%d]: ", ix);
-          mi_afficher_valeur (fi, mi_vecteur_comp (sy->mi_comps, ix).t_val);
+          mi_imprimeur_car (im, '[');
+          mi_imprimeur_entier (im, ix);
+          mi_imprimeur_octets (im, "]: ", 3);
+          mi_imprimeur_valeur (im, mi_vecteur_comp (sy->mi_comps, ix).t_val);
+          mi_imprimeur_car (im, '\n');
         }
     }
   else
-    fprintf (fi, "-- aucun composant --\n");
-}
+    mi_imprimeur_chaine (im, "-- aucun composant --\n");
+}				// fin mi_imprimeur_contenu_symbole
+
+void
+mi_afficher_contenu_symbole (FILE * fi, const Mit_Symbole *sy)
+{
+  if (!fi)
+    return;
+  if (!sy || sy == MI_TROU_SYMBOLE)
+    return;
+  struct Mi_Imprimeur_st *im = mi_imprimeur_commun ();
+  mi_imprimeur_contenu_symbole (im, sy, fi == stdout);
+  mi_imprimeur_ecrire (im, fi);
+}				// fin mi_afficher_contenu_symbole
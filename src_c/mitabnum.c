@@ -0,0 +1,400 @@
+// fichier mitabnum.c - tableaux numériques d'entiers et de doubles
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file mitabnum.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// Les calculs en masse travaillent par paquets de quatre nombres,
+/// avec les vecteurs de GCC, que le compilateur traduit en
+/// instructions SIMD de la machine quand elle en a; un reste de moins
+/// de quatre nombres est traité un à un.
+typedef long mi_v4l __attribute__ ((vector_size (4 * sizeof (long))));
+typedef double mi_v4d __attribute__ ((vector_size (4 * sizeof (double))));
+#define MI_PAQUET 4
+
+// les tableaux peuvent ne pas être alignés sur la taille d'un
+// paquet; ce sont des macros, car une fonction renvoyant un vecteur
+// de 32 octets changerait d'ABI selon que AVX est actif
+#define MI_CHARGER_PAQUET(Ty,P) ({Ty _v; memcpy (&_v, (P), sizeof (_v)); _v;})
+#define mi_charger_v4l(P) MI_CHARGER_PAQUET(mi_v4l,(P))
+#define mi_charger_v4d(P) MI_CHARGER_PAQUET(mi_v4d,(P))
+
+static const Mit_TabEntiers mi_tabentvide =
+{
+  .mi_type = MiTy_TabEntiers,
+  .mi_marq = true,
+  .mi_hash = 73,
+  .mi_taille = 0,
+};
+
+static const Mit_TabDoubles mi_tabdblvide =
+{
+  .mi_type = MiTy_TabDoubles,
+  .mi_marq = true,
+  .mi_hash = 97,
+  .mi_taille = 0,
+};
+
+// le hash des mots de 64 bits d'un tableau d'entiers ou de doubles;
+// chaque mot est copié par memcpy, pour respecter l'aliasage strict
+static unsigned
+mi_hash_mots (const void *mots, unsigned nb, unsigned graine)
+{
+  uint64_t h = graine + nb;
+  for (unsigned ix = 0; ix < nb; ix++)
+    {
+      uint64_t m = 0;
+      memcpy (&m, (const char *) mots + ix * sizeof (m), sizeof (m));
+      h ^= m + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+      h *= 0xff51afd7ed558ccdULL;
+    }
+  unsigned r = (unsigned) (h ^ (h >> 32));
+  if (!r)
+    r = graine + (nb % 30011) + 1;
+  return r;
+}				// fin mi_hash_mots
+
+const Mit_TabEntiers *
+mi_creer_tabentiers (unsigned nb, const long *tab)
+{
+  if (nb == 0)
+    return &mi_tabentvide;
+  if (nb >= INT_MAX / (2 * sizeof (long)))
+    MI_FATALPRINTF ("tableau de %u entiers trop grand", nb);
+  Mit_TabEntiers *te = mi_allouer_valeur (MiTy_TabEntiers,
+                                          sizeof (Mit_TabEntiers) +
+                                          nb * sizeof (long));
+  te->mi_taille = nb;
+  if (tab)
+    memcpy (te->mi_tabent, tab, nb * sizeof (long));
+  te->mi_hash = mi_hash_mots (te->mi_tabent, nb, 31);
+  return te;
+}				// fin mi_creer_tabentiers
+
+const Mit_TabDoubles *
+mi_creer_tabdoubles (unsigned nb, const double *tab)
+{
+  if (nb == 0)
+    return &mi_tabdblvide;
+  if (nb >= INT_MAX / (2 * sizeof (double)))
+    MI_FATALPRINTF ("tableau de %u doubles trop grand", nb);
+  Mit_TabDoubles *td = mi_allouer_valeur (MiTy_TabDoubles,
+                                          sizeof (Mit_TabDoubles) +
+                                          nb * sizeof (double));
+  td->mi_taille = nb;
+  if (tab)
+    memcpy (td->mi_tabdbl, tab, nb * sizeof (double));
+  td->mi_hash = mi_hash_mots (td->mi_tabdbl, nb, 37);
+  return td;
+}				// fin mi_creer_tabdoubles
+
+/// La somme d'entiers est exacte: chaque entier est coupé en ses 32
+/// bits forts, signés, et ses 32 bits faibles, sommés à part dans des
+/// mots de 64 bits qui ne peuvent pas déborder pour moins de 2^32
+/// entiers; la somme est recomposée sur 128 bits, puis comparée aux
+/// bornes d'un long.
+bool
+mi_tabentiers_somme (const Mit_TabEntiers * te, long *psomme)
+{
+  if (!te || te->mi_type != MiTy_TabEntiers)
+    return false;
+  unsigned n = te->mi_taille, ix = 0;
+  mi_v4l fort = { 0, 0, 0, 0 }, faible = { 0, 0, 0, 0 };
+  for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+    {
+      mi_v4l x = mi_charger_v4l (te->mi_tabent + ix);
+      fort += x >> 32;
+      faible += x & 0xffffffffL;
+    }
+  __int128 s = 0;
+  for (int j = 0; j < MI_PAQUET; j++)
+    s += (__int128) fort[j] * ((__int128) 1 << 32) + faible[j];
+  for (; ix < n; ix++)
+    s += te->mi_tabent[ix];
+  if (s < LONG_MIN || s > LONG_MAX)
+    return false;
+  if (psomme)
+    *psomme = (long) s;
+  return true;
+}				// fin mi_tabentiers_somme
+
+double
+mi_tabdoubles_somme (const Mit_TabDoubles * td)
+{
+  if (!td || td->mi_type != MiTy_TabDoubles)
+    return 0.0;
+  unsigned n = td->mi_taille, ix = 0;
+  mi_v4d acc = { 0.0, 0.0, 0.0, 0.0 };
+  for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+    acc += mi_charger_v4d (td->mi_tabdbl + ix);
+  double s = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for (; ix < n; ix++)
+    s += td->mi_tabdbl[ix];
+  return s;
+}				// fin mi_tabdoubles_somme
+
+bool
+mi_tabentiers_minmax (const Mit_TabEntiers * te, long *pmin, long *pmax)
+{
+  if (!te || te->mi_type != MiTy_TabEntiers || te->mi_taille == 0)
+    return false;
+  unsigned n = te->mi_taille, ix = 0;
+  long mn = te->mi_tabent[0], mx = mn;
+  if (n >= MI_PAQUET)
+    {
+      mi_v4l vmn = mi_charger_v4l (te->mi_tabent);
+      mi_v4l vmx = vmn;
+      // sans branchement: une comparaison donne un masque de 0 ou -1
+      for (ix = MI_PAQUET; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+        {
+          mi_v4l x = mi_charger_v4l (te->mi_tabent + ix);
+          mi_v4l m = (mi_v4l) (x < vmn);
+          vmn = (x & m) | (vmn & ~m);
+          m = (mi_v4l) (x > vmx);
+          vmx = (x & m) | (vmx & ~m);
+        }
+      for (int j = 0; j < MI_PAQUET; j++)
+        {
+          if (vmn[j] < mn)
+            mn = vmn[j];
+          if (vmx[j] > mx)
+            mx = vmx[j];
+        }
+    }
+  for (; ix < n; ix++)
+    {
+      long x = te->mi_tabent[ix];
+      if (x < mn)
+        mn = x;
+      if (x > mx)
+        mx = x;
+    }
+  if (pmin)
+    *pmin = mn;
+  if (pmax)
+    *pmax = mx;
+  return true;
+}				// fin mi_tabentiers_minmax
+
+bool
+mi_tabdoubles_minmax (const Mit_TabDoubles * td, double *pmin, double *pmax)
+{
+  if (!td || td->mi_type != MiTy_TabDoubles)
+    return false;
+  unsigned n = td->mi_taille, ix = 0;
+  // les NAN sont ignorés: toute comparaison avec eux est fausse
+  double mn = INFINITY, mx = -INFINITY;
+  bool trouve = false;
+  if (n >= MI_PAQUET)
+    {
+      mi_v4d vmn = { INFINITY, INFINITY, INFINITY, INFINITY };
+      mi_v4d vmx = -vmn;
+      mi_v4l vtrouve = { 0, 0, 0, 0 };
+      // sans branchement, en masquant les bits des doubles
+      for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+        {
+          mi_v4d x = mi_charger_v4d (td->mi_tabdbl + ix);
+          vtrouve |= (mi_v4l) (x == x);
+          mi_v4l m = (mi_v4l) (x < vmn);
+          vmn = (mi_v4d) (((mi_v4l) x & m) | ((mi_v4l) vmn & ~m));
+          m = (mi_v4l) (x > vmx);
+          vmx = (mi_v4d) (((mi_v4l) x & m) | ((mi_v4l) vmx & ~m));
+        }
+      for (int j = 0; j < MI_PAQUET; j++)
+        {
+          trouve = trouve || vtrouve[j];
+          mn = (vmn[j] < mn) ? vmn[j] : mn;
+          mx = (vmx[j] > mx) ? vmx[j] : mx;
+        }
+    }
+  for (; ix < n; ix++)
+    {
+      double x = td->mi_tabdbl[ix];
+      if (isnan (x))
+        continue;
+      trouve = true;
+      mn = (x < mn) ? x : mn;
+      mx = (x > mx) ? x : mx;
+    }
+  if (!trouve)
+    return false;
+  if (pmin)
+    *pmin = mn;
+  if (pmax)
+    *pmax = mx;
+  return true;
+}				// fin mi_tabdoubles_minmax
+
+// chaque produit est exact sur 128 bits, et leur somme est vérifiée
+// par __builtin_add_overflow; il n'y a pas de multiplication SIMD
+// de mots de 64 bits sans AVX-512, le calcul est donc scalaire
+bool
+mi_tabentiers_produit_scalaire (const Mit_TabEntiers * te1,
+                                const Mit_TabEntiers * te2, long *pprod)
+{
+  if (!te1 || te1->mi_type != MiTy_TabEntiers
+      || !te2 || te2->mi_type != MiTy_TabEntiers)
+    return false;
+  unsigned n = (te1->mi_taille < te2->mi_taille)
+               ? te1->mi_taille : te2->mi_taille;
+  __int128 s = 0;
+  for (unsigned ix = 0; ix < n; ix++)
+    if (__builtin_add_overflow (s, (__int128) te1->mi_tabent[ix]
+                                * te2->mi_tabent[ix], &s))
+      return false;
+  if (s < LONG_MIN || s > LONG_MAX)
+    return false;
+  if (pprod)
+    *pprod = (long) s;
+  return true;
+}				// fin mi_tabentiers_produit_scalaire
+
+double
+mi_tabdoubles_produit_scalaire (const Mit_TabDoubles * td1,
+                                const Mit_TabDoubles * td2)
+{
+  if (!td1 || td1->mi_type != MiTy_TabDoubles
+      || !td2 || td2->mi_type != MiTy_TabDoubles)
+    return 0.0;
+  unsigned n = (td1->mi_taille < td2->mi_taille)
+               ? td1->mi_taille : td2->mi_taille;
+  unsigned ix = 0;
+  mi_v4d acc = { 0.0, 0.0, 0.0, 0.0 };
+  for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+    acc += mi_charger_v4d (td1->mi_tabdbl + ix)
+           * mi_charger_v4d (td2->mi_tabdbl + ix);
+  double s = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+  for (; ix < n; ix++)
+    s += td1->mi_tabdbl[ix] * td2->mi_tabdbl[ix];
+  return s;
+}				// fin mi_tabdoubles_produit_scalaire
+
+const Mit_TabEntiers *
+mi_tabentiers_operation (enum mi_opnum_en op, const Mit_TabEntiers * te1,
+                         const Mit_TabEntiers * te2)
+{
+  if (!te1 || te1->mi_type != MiTy_TabEntiers
+      || !te2 || te2->mi_type != MiTy_TabEntiers)
+    return NULL;
+  unsigned n = (te1->mi_taille < te2->mi_taille)
+               ? te1->mi_taille : te2->mi_taille;
+  if (n == 0)
+    return &mi_tabentvide;
+  Mit_TabEntiers *ter = mi_allouer_valeur (MiTy_TabEntiers,
+                        sizeof (Mit_TabEntiers) +
+                        n * sizeof (long));
+  ter->mi_taille = n;
+  const long *a = te1->mi_tabent, *b = te2->mi_tabent;
+  long *r = ter->mi_tabent;
+  unsigned ix = 0;
+  switch (op)
+    {
+    case MiOp_Ajout:
+      for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+        {
+          mi_v4l x = mi_charger_v4l (a + ix) + mi_charger_v4l (b + ix);
+          memcpy (r + ix, &x, sizeof (x));
+        }
+      for (; ix < n; ix++)
+        r[ix] = a[ix] + b[ix];
+      break;
+    case MiOp_Soustr:
+      for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+        {
+          mi_v4l x = mi_charger_v4l (a + ix) - mi_charger_v4l (b + ix);
+          memcpy (r + ix, &x, sizeof (x));
+        }
+      for (; ix < n; ix++)
+        r[ix] = a[ix] - b[ix];
+      break;
+    case MiOp_Mult:
+      for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+        {
+          mi_v4l x = mi_charger_v4l (a + ix) * mi_charger_v4l (b + ix);
+          memcpy (r + ix, &x, sizeof (x));
+        }
+      for (; ix < n; ix++)
+        r[ix] = a[ix] * b[ix];
+      break;
+    case MiOp_Div:
+      // pas de division entière en SIMD; la division par zéro donne zéro
+      for (; ix < n; ix++)
+        r[ix] = (b[ix] == 0 || (b[ix] == -1 && a[ix] == LONG_MIN))
+                ? 0 : a[ix] / b[ix];
+      break;
+    }
+  ter->mi_hash = mi_hash_mots (r, n, 31);
+  return ter;
+}				// fin mi_tabentiers_operation
+
+const Mit_TabDoubles *
+mi_tabdoubles_operation (enum mi_opnum_en op, const Mit_TabDoubles * td1,
+                         const Mit_TabDoubles * td2)
+{
+  if (!td1 || td1->mi_type != MiTy_TabDoubles
+      || !td2 || td2->mi_type != MiTy_TabDoubles)
+    return NULL;
+  unsigned n = (td1->mi_taille < td2->mi_taille)
+               ? td1->mi_taille : td2->mi_taille;
+  if (n == 0)
+    return &mi_tabdblvide;
+  Mit_TabDoubles *tdr = mi_allouer_valeur (MiTy_TabDoubles,
+                        sizeof (Mit_TabDoubles) +
+                        n * sizeof (double));
+  tdr->mi_taille = n;
+  const double *a = td1->mi_tabdbl, *b = td2->mi_tabdbl;
+  double *r = tdr->mi_tabdbl;
+  unsigned ix = 0;
+  for (; ix + MI_PAQUET <= n; ix += MI_PAQUET)
+    {
+      mi_v4d x = mi_charger_v4d (a + ix), y = mi_charger_v4d (b + ix);
+      switch (op)
+        {
+        case MiOp_Ajout:
+          x += y;
+          break;
+        case MiOp_Soustr:
+          x -= y;
+          break;
+        case MiOp_Mult:
+          x *= y;
+          break;
+        case MiOp_Div:
+          x /= y;
+          break;
+        }
+      memcpy (r + ix, &x, sizeof (x));
+    }
+  for (; ix < n; ix++)
+    switch (op)
+      {
+      case MiOp_Ajout:
+        r[ix] = a[ix] + b[ix];
+        break;
+      case MiOp_Soustr:
+        r[ix] = a[ix] - b[ix];
+        break;
+      case MiOp_Mult:
+        r[ix] = a[ix] * b[ix];
+        break;
+      case MiOp_Div:
+        r[ix] = a[ix] / b[ix];
+        break;
+      }
+  tdr->mi_hash = mi_hash_mots (r, n, 37);
+  return tdr;
+}				// fin mi_tabdoubles_operation
@@ -0,0 +1,358 @@
+// fichier mitampon.c - tampons d'octets, chargement de symbole
+/* la notice de copyright est legalement en anglais */
+
+// (C) 2016 Basile Starynkevitch
+//   this file mitampon.c is part of Minil
+//   Minil is free software: you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation, either version 3 of the License, or
+//   (at your option) any later version.
+//
+//   Minil is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with Minil.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "minil.h"
+
+/// Un tampon est une suite d'octets extensible, qui n'est pas une
+/// valeur mais peut être le chargement d'un symbole. Ses octets sont
+/// soit alloués par malloc, soit projetés en lecture par mmap depuis
+/// un fichier; un tampon projeté est recopié dans le tas à sa
+/// première modification.
+#define MI_TAMPON_NMAGIQ 0x3a51c0e7	/*978436327 */
+#define MI_TAMPON_MAX (SIZE_MAX/4)
+struct MiCh_Tampon_st
+{
+  unsigned tam_mag;		// toujours MI_TAMPON_NMAGIQ
+  bool tam_projete;		// vrai si les octets viennent de mmap
+  size_t tam_taille;		// taille allouée ou projetée
+  size_t tam_long;		// nombre d'octets utilisés
+  char *tam_octets;
+};
+
+static inline bool
+mi_tampon_licite (const struct MiCh_Tampon_st *t)
+{
+  return t && t->tam_mag == MI_TAMPON_NMAGIQ;
+}
+
+struct MiCh_Tampon_st *
+mi_tampon_creer (size_t taille)
+{
+  if (taille >= MI_TAMPON_MAX)
+    MI_FATALPRINTF ("tampon trop grand (%zd)", taille);
+  struct MiCh_Tampon_st *t = calloc (1, sizeof (struct MiCh_Tampon_st));
+  if (!t)
+    MI_FATALPRINTF ("memoire pleine pour tampon (%s)", strerror (errno));
+  t->tam_mag = MI_TAMPON_NMAGIQ;
+  if (taille < 64)
+    taille = 64;
+  t->tam_octets = malloc (taille);
+  if (!t->tam_octets)
+    MI_FATALPRINTF ("memoire pleine pour tampon de %zd octets (%s)",
+                    taille, strerror (errno));
+  t->tam_taille = taille;
+  return t;
+}				/* fin mi_tampon_creer */
+
+struct MiCh_Tampon_st *
+mi_tampon_projeter (const char *chemin)
+{
+  if (!chemin)
+    return NULL;
+  int fd = open (chemin, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  memset (&st, 0, sizeof (st));
+  if (fstat (fd, &st) || !S_ISREG (st.st_mode))
+    {
+      int e = errno;
+      close (fd);
+      errno = e ? e : EINVAL;
+      return NULL;
+    }
+  size_t ln = st.st_size;
+  if (ln >= MI_TAMPON_MAX)
+    MI_FATALPRINTF ("fichier %s trop grand pour un tampon (%zd)", chemin, ln);
+  // on ne projette pas un fichier vide
+  if (ln == 0)
+    {
+      close (fd);
+      return mi_tampon_creer (0);
+    }
+  void *ad = mmap (NULL, ln, PROT_READ, MAP_PRIVATE, fd, 0);
+  int e = errno;
+  close (fd);
+  if (ad == MAP_FAILED)
+    {
+      errno = e;
+      return NULL;
+    }
+  (void) madvise (ad, ln, MADV_SEQUENTIAL);
+  struct MiCh_Tampon_st *t = calloc (1, sizeof (struct MiCh_Tampon_st));
+  if (!t)
+    MI_FATALPRINTF ("memoire pleine pour tampon (%s)", strerror (errno));
+  t->tam_mag = MI_TAMPON_NMAGIQ;
+  t->tam_projete = true;
+  t->tam_taille = ln;
+  t->tam_long = ln;
+  t->tam_octets = ad;
+  return t;
+}				/* fin mi_tampon_projeter */
+
+void
+mi_tampon_detruire (struct MiCh_Tampon_st *t)
+{
+  if (!mi_tampon_licite (t))
+    return;
+  if (t->tam_projete)
+    munmap (t->tam_octets, t->tam_taille);
+  else
+    free (t->tam_octets);
+  memset (t, 0, sizeof (*t));
+  free (t);
+}				/* fin mi_tampon_detruire */
+
+size_t
+mi_tampon_long (const struct MiCh_Tampon_st *t)
+{
+  if (!mi_tampon_licite (t))
+    return 0;
+  return t->tam_long;
+}				/* fin mi_tampon_long */
+
+const char *
+mi_tampon_octets (const struct MiCh_Tampon_st *t)
+{
+  if (!mi_tampon_licite (t))
+    return NULL;
+  return t->tam_octets;
+}				/* fin mi_tampon_octets */
+
+// s'assure qu'on peut ajouter nb octets dans le tas, en recopiant un
+// tampon projeté
+void
+mi_tampon_reserver (struct MiCh_Tampon_st *t, size_t nb)
+{
+  if (!mi_tampon_licite (t))
+    return;
+  if (nb >= MI_TAMPON_MAX - t->tam_long)
+    MI_FATALPRINTF ("tampon trop grand (%zd + %zd)", t->tam_long, nb);
+  if (!t->tam_projete && t->tam_long + nb <= t->tam_taille)
+    return;
+  size_t nouvtail = t->tam_long + nb;
+  if (!t->tam_projete || nb > 0)
+    nouvtail += nouvtail / 2 + 64;
+  char *nouvoct = NULL;
+  if (t->tam_projete)
+    {
+      nouvoct = malloc (nouvtail);
+      if (nouvoct)
+        memcpy (nouvoct, t->tam_octets, t->tam_long);
+    }
+  else
+    nouvoct = realloc (t->tam_octets, nouvtail);
+  if (!nouvoct)
+    MI_FATALPRINTF ("memoire pleine pour tampon de %zd octets (%s)",
+                    nouvtail, strerror (errno));
+  if (t->tam_projete)
+    munmap (t->tam_octets, t->tam_taille);
+  t->tam_projete = false;
+  t->tam_octets = nouvoct;
+  t->tam_taille = nouvtail;
+}				/* fin mi_tampon_reserver */
+
+void
+mi_tampon_ajouter (struct MiCh_Tampon_st *t, const void *oct, size_t nb)
+{
+  if (!mi_tampon_licite (t) || !oct || nb == 0)
+    return;
+  mi_tampon_reserver (t, nb);
+  memcpy (t->tam_octets + t->tam_long, oct, nb);
+  t->tam_long += nb;
+}				/* fin mi_tampon_ajouter */
+
+void
+mi_tampon_tronquer (struct MiCh_Tampon_st *t, size_t ln)
+{
+  if (!mi_tampon_licite (t) || ln >= t->tam_long)
+    return;
+  // un tampon projeté garde sa projection, on n'en voit qu'une partie
+  t->tam_long = ln;
+}				/* fin mi_tampon_tronquer */
+
+/// une tranche est une vue sur les octets du tampon, sans copie; elle
+/// n'est valide que jusqu'à la prochaine modification du tampon
+const char *
+mi_tampon_tranche (const struct MiCh_Tampon_st *t, size_t deb, size_t *plong)
+{
+  if (!mi_tampon_licite (t) || deb > t->tam_long)
+    {
+      if (plong)
+        *plong = 0;
+      return NULL;
+    }
+  size_t ln = plong ? *plong : t->tam_long - deb;
+  if (ln > t->tam_long - deb)
+    ln = t->tam_long - deb;
+  if (plong)
+    *plong = ln;
+  return t->tam_octets + deb;
+}				/* fin mi_tampon_tranche */
+
+/// la chaine d'une tranche est faite avec une seule copie des octets
+/// du tampon; elle est nulle si la tranche n'est pas de l'UTF-8 valide
+const Mit_Chaine *
+mi_tampon_chaine (const struct MiCh_Tampon_st *t, size_t deb, size_t ln)
+{
+  const char *oct = mi_tampon_tranche (t, deb, &ln);
+  if (!oct)
+    return NULL;
+  return mi_creer_chaine_octets (oct, ln);
+}				/* fin mi_tampon_chaine */
+
+/// lit au plus nb octets de fd à la fin du tampon. Le readv remplit
+/// d'abord la place libre du tampon, puis un tampon sur la pile, pour
+/// lire beaucoup en un seul appel système sans trop réserver
+ssize_t
+mi_tampon_lire_fd (struct MiCh_Tampon_st *t, int fd, size_t nb)
+{
+  if (!mi_tampon_licite (t) || fd < 0 || nb == 0)
+    return 0;
+  char pile[16384];
+  size_t res = nb > sizeof (pile) ? nb - sizeof (pile) : nb / 2 + 1;
+  mi_tampon_reserver (t, res);
+  size_t libre = t->tam_taille - t->tam_long;
+  if (libre > nb)
+    libre = nb;
+  struct iovec iov[2];
+  iov[0].iov_base = t->tam_octets + t->tam_long;
+  iov[0].iov_len = libre;
+  iov[1].iov_base = pile;
+  iov[1].iov_len = (nb - libre < sizeof (pile)) ? nb - libre : sizeof (pile);
+  ssize_t lu = 0;
+  do
+    lu = readv (fd, iov, iov[1].iov_len > 0 ? 2 : 1);
+  while (lu < 0 && errno == EINTR);
+  if (lu <= 0)
+    return lu;
+  if ((size_t) lu <= libre)
+    t->tam_long += lu;
+  else
+    {
+      t->tam_long += libre;
+      mi_tampon_ajouter (t, pile, lu - libre);
+    }
+  return lu;
+}				/* fin mi_tampon_lire_fd */
+
+/// écrit tous les octets de plusieurs tampons sur fd, en les
+/// rassemblant par writev, et renvoie le nombre d'octets écrits ou -1
+ssize_t
+mi_tampons_ecrire_fd (int fd, struct MiCh_Tampon_st *const *tabt, unsigned nb)
+{
+  if (fd < 0 || !tabt)
+    return -1;
+  enum
+  { MI_NBIOV = 64 };
+  struct iovec iov[MI_NBIOV];
+  size_t total = 0;
+  unsigned ixt = 0;
+  size_t depl = 0;		// déplacement dans le tampon tabt[ixt]
+  for (;;)
+    {
+      int niov = 0;
+      for (unsigned ix = ixt; ix < nb && niov < MI_NBIOV; ix++)
+        {
+          const struct MiCh_Tampon_st *t = tabt[ix];
+          size_t d = (ix == ixt) ? depl : 0;
+          if (!mi_tampon_licite (t) || t->tam_long <= d)
+            continue;
+          iov[niov].iov_base = t->tam_octets + d;
+          iov[niov].iov_len = t->tam_long - d;
+          niov++;
+        }
+      if (niov == 0)
+        return total;
+      ssize_t ec = writev (fd, iov, niov);
+      if (ec < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return -1;
+        }
+      // rien d'écrit alors qu'il reste des octets: réessayer
+      // bouclerait sans fin
+      if (ec == 0)
+        {
+          errno = EIO;
+          return -1;
+        }
+      total += ec;
+      // avancer de ec octets dans les tampons
+      size_t reste = ec;
+      while (ixt < nb)
+        {
+          const struct MiCh_Tampon_st *t = tabt[ixt];
+          size_t dispo =
+            (mi_tampon_licite (t) && t->tam_long > depl) ? t->tam_long - depl : 0;
+          if (reste < dispo)
+            {
+              depl += reste;
+              break;
+            }
+          reste -= dispo;
+          ixt++;
+          depl = 0;
+          if (reste == 0)
+            break;
+        }
+    }
+}				/* fin mi_tampons_ecrire_fd */
+
+ssize_t
+mi_tampon_ecrire_fd (const struct MiCh_Tampon_st * t, int fd)
+{
+  struct MiCh_Tampon_st *tabt[1] = { (struct MiCh_Tampon_st *) t };
+  return mi_tampons_ecrire_fd (fd, tabt, 1);
+}				/* fin mi_tampon_ecrire_fd */
+
+/// le tampon attaché à un symbole lui appartient, et est détruit quand
+/// on en attache un autre
+void
+mi_symbole_attacher_tampon (Mit_Symbole *sy, struct MiCh_Tampon_st *t)
+{
+  if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole)
+    return;
+  if (t && !mi_tampon_licite (t))
+    MI_FATALPRINTF ("tampon incorrect @%p", (void *) t);
+  switch (sy->mi_chatype)
+    {
+    case MiCh_Rien:
+      break;
+    case Mich_Tampon:
+      if (sy->mi_chatamp == t)
+        return;
+      mi_tampon_detruire (sy->mi_chatamp);
+      break;
+    default:
+      MI_FATALPRINTF ("symbole %s a déjà un chargement de type %d",
+                      mi_symbole_chaine (sy), (int) sy->mi_chatype);
+    }
+  sy->mi_chatamp = t;
+  sy->mi_chatype = t ? Mich_Tampon : MiCh_Rien;
+}				/* fin mi_symbole_attacher_tampon */
+
+struct MiCh_Tampon_st *
+mi_symbole_tampon (const Mit_Symbole *sy)
+{
+  if (!sy || sy == MI_TROU_SYMBOLE || sy->mi_type != MiTy_Symbole
+      || sy->mi_chatype != Mich_Tampon)
+    return NULL;
+  return sy->mi_chatamp;
+}				/* fin mi_symbole_tampon */
@@ -21,6 +21,45 @@
 #define MI_MAXLONGCHAINE (INT_MAX/4)
 #define MI_MAXARITE (INT_MAX/4)
 
+// vrai si la chaine a la place d'un index de ses caractères
+static inline bool
+mi_chaine_indexable (const Mit_Chaine *ch)
+{
+  return !ch->mi_ascii && ch->mi_taille >= MI_CHAINE_SEUIL_INDEX
+         && ch->mi_long > MI_CHAINE_PAS_INDEX;
+}
+
+// l'index, aligné, est juste après le nul final
+static inline unsigned *
+mi_chaine_index (const Mit_Chaine *ch)
+{
+  assert (mi_chaine_indexable (ch));
+  return (unsigned *) (ch->mi_car +
+                       ((ch->mi_taille + 1 + sizeof (unsigned) - 1)
+                        & ~(sizeof (unsigned) - 1)));
+}
+
+// copie sans vérification de ln octets UTF-8 sans nul
+static Mit_Chaine *
+mi_chaine_copier (const char *oct, size_t ln)
+{
+  bool ascii = true;
+  for (size_t ix = 0; ix < ln && ascii; ix++)
+    ascii = (oct[ix] & 0x80) == 0;
+  unsigned lg = ascii ? ln : u8_mbsnlen ((const uint8_t *) oct, ln);
+  size_t tail = sizeof (Mit_Chaine) + ln + 1;
+  if (!ascii && ln >= MI_CHAINE_SEUIL_INDEX && lg > MI_CHAINE_PAS_INDEX)
+    tail = ((tail + sizeof (unsigned) - 1) & ~(sizeof (unsigned) - 1))
+           + (lg / MI_CHAINE_PAS_INDEX) * sizeof (unsigned);
+  Mit_Chaine *valch = mi_allouer_valeur (MiTy_Chaine, tail);
+  memcpy (valch->mi_car, oct, ln);
+  valch->mi_taille = ln;
+  valch->mi_long = lg;
+  valch->mi_ascii = ascii;
+  valch->mi_hash = mi_hashage_octets (valch->mi_car, ln);
+  return valch;
+}				// fin mi_chaine_copier
+
 const Mit_Chaine *
 mi_creer_chaine (const char *ch)
 {
@@ -31,17 +70,21 @@ mi_creer_chaine (const char *ch)
     MI_FATALPRINTF ("chaine %.50s trop longue (%ld)", ch, (long) ln);
   if (u8_check ((const uint8_t *) ch, ln))
     MI_FATALPRINTF ("chaine %.50s incorrecte", ch);
-  Mit_Chaine *valch = mi_allouer_valeur (MiTy_Chaine,
-                                         (unsigned) (ln +
-                                             sizeof (Mit_Chaine) +
-                                             1));
-  strcpy (valch->mi_car, ch);
-  valch->mi_taille = ln;
-  valch->mi_long = u8_mblen ((const uint8_t *) ch, ln);
-  valch->mi_hash = mi_hashage_chaine (ch);
-  return valch;
+  return mi_chaine_copier (ch, ln);
 }
 
+const Mit_Chaine *
+mi_creer_chaine_octets (const char *oct, size_t nb)
+{
+  if (!oct)
+    return NULL;
+  if (nb >= MI_MAXLONGCHAINE)
+    MI_FATALPRINTF ("chaine %.*s trop longue (%ld)", 50, oct, (long) nb);
+  if (memchr (oct, 0, nb) || u8_check ((const uint8_t *) oct, nb))
+    return NULL;
+  return mi_chaine_copier (oct, nb);
+}				// fin mi_creer_chaine_octets
+
 const Mit_Chaine *
 mi_creer_chaine_printf (const char *fmt, ...)
 {
@@ -59,15 +102,105 @@ mi_creer_chaine_printf (const char *fmt, ...)
                     tampon, fmt, ln);
   else
     {
-      Mit_Chaine *valch =
-        mi_allouer_valeur (MiTy_Chaine, ln + sizeof (Mit_Chaine) + 1);
+      char *ch = NULL;
       va_start (args, fmt);
-      vsnprintf (valch->mi_car, ln, fmt, args);
+      ln = vasprintf (&ch, fmt, args);
       va_end (args);
+      if (ln < 0 || !ch)
+        MI_FATALPRINTF ("chaine impossible pour format %s (%s)", fmt,
+                        strerror (errno));
+      const Mit_Chaine *valch = mi_creer_chaine (ch);
+      free (ch);
       return valch;
     }
 }				// fin mi_creer_chaine_printf
 
+// le nombre d'octets des nb caractères UTF-8 valides commençant en oct
+static inline unsigned
+mi_avancer_caracteres (const char *oct, unsigned nb)
+{
+  const char *p = oct;
+  while (nb > 0)
+    {
+      p++;
+      while ((*p & 0xc0) == 0x80)
+        p++;
+      nb--;
+    }
+  return p - oct;
+}				// fin mi_avancer_caracteres
+
+unsigned
+mi_chaine_decalage (const Mit_Chaine *ch, unsigned rang)
+{
+  if (!ch || ch->mi_type != MiTy_Chaine)
+    return 0;
+  if (rang >= ch->mi_long)
+    return ch->mi_taille;
+  if (ch->mi_ascii)
+    return rang;
+  if (!mi_chaine_indexable (ch))
+    return mi_avancer_caracteres (ch->mi_car, rang);
+  unsigned *index = mi_chaine_index (ch);
+  if (!ch->mi_indexee)
+    {
+      // l'index est un cache, calculé une fois dans une chaine immuable
+      unsigned nbi = ch->mi_long / MI_CHAINE_PAS_INDEX;
+      unsigned dec = 0;
+      for (unsigned ix = 0; ix < nbi; ix++)
+        {
+          dec += mi_avancer_caracteres (ch->mi_car + dec, MI_CHAINE_PAS_INDEX);
+          index[ix] = dec;
+        }
+      ((Mit_Chaine *) ch)->mi_indexee = true;
+    }
+  unsigned q = rang / MI_CHAINE_PAS_INDEX;
+  unsigned dec = q > 0 ? index[q - 1] : 0;
+  return dec + mi_avancer_caracteres (ch->mi_car + dec,
+                                      rang % MI_CHAINE_PAS_INDEX);
+}				// fin mi_chaine_decalage
+
+ucs4_t
+mi_chaine_car (const Mit_Chaine *ch, int rang)
+{
+  if (!ch || ch->mi_type != MiTy_Chaine)
+    return 0;
+  if (rang < 0)
+    rang += (int) ch->mi_long;
+  if (rang < 0 || rang >= (int) ch->mi_long)
+    return 0;
+  if (ch->mi_ascii)
+    return (unsigned char) ch->mi_car[rang];
+  unsigned dec = mi_chaine_decalage (ch, rang);
+  ucs4_t uc = 0;
+  u8_mbtouc_unsafe (&uc, (const uint8_t *) ch->mi_car + dec,
+                    ch->mi_taille - dec);
+  return uc;
+}				// fin mi_chaine_car
+
+const Mit_Chaine *
+mi_sous_chaine (const Mit_Chaine *ch, int deb, unsigned lg)
+{
+  if (!ch || ch->mi_type != MiTy_Chaine)
+    return NULL;
+  if (deb < 0)
+    deb += (int) ch->mi_long;
+  if (deb < 0)
+    deb = 0;
+  if ((unsigned) deb >= ch->mi_long)
+    lg = 0;
+  else if (lg > ch->mi_long - deb)
+    lg = ch->mi_long - deb;
+  if (deb == 0 && lg == ch->mi_long)
+    return ch;
+  unsigned d = mi_chaine_decalage (ch, deb);
+  unsigned f = ch->mi_ascii ? (unsigned) deb + lg
+               : (lg < MI_CHAINE_PAS_INDEX
+                  ? d + mi_avancer_caracteres (ch->mi_car + d, lg)
+                  : mi_chaine_decalage (ch, deb + lg));
+  return mi_chaine_copier (ch->mi_car + d, f - d);
+}				// fin mi_sous_chaine
+
 const Mit_Entier *
 mi_creer_entier (long l)
 {
@@ -100,6 +233,28 @@ mi_tuple_vide (void)
 }				// fin mi_tuple_vide
 
 
+// une étape du hash d'un tuple, pour son composant de rang ix
+static inline void
+mi_hash_tuple_etape (unsigned *ph1, unsigned *ph2, unsigned ix,
+                     const Mit_Symbole *sy)
+{
+  assert (sy != NULL && sy != MI_TROU_SYMBOLE);
+  assert (sy->mi_type == MiTy_Symbole);
+  if (ix % 2)
+    *ph1 = (22367 * sy->mi_hash + ix) ^ (293 * *ph1);
+  else
+    *ph2 = (42391 * sy->mi_hash) ^ (191 * *ph2 + ix * 17);
+}				// fin mi_hash_tuple_etape
+
+static inline unsigned
+mi_hash_tuple_final (unsigned h1, unsigned h2, unsigned t)
+{
+  unsigned h = (17 * h1) ^ (89 * h2);
+  if (!h)
+    h = (h1 & 0xffff) + (h2 & 0xfffff) + (t % 35677) + 19;
+  return h;
+}				// fin mi_hash_tuple_final
+
 void
 mi_calculer_hash_tuple (Mit_Tuple * tu)
 {
@@ -108,236 +263,379 @@ mi_calculer_hash_tuple (Mit_Tuple * tu)
   assert (tu->mi_hash == 0);
   unsigned h1 = 0, h2 = t + 1;
   for (unsigned ix = 0; ix < t; ix++)
-    {
-      const Mit_Symbole *sy = tu->mi_composants[ix];
-      assert (sy != NULL && sy != MI_TROU_SYMBOLE);
-      assert (sy->mi_type == MiTy_Symbole);
-      if (ix % 2)
-        h1 = (22367 * sy->mi_hash + ix) ^ (293 * h1);
-      else
-        h2 = (42391 * sy->mi_hash) ^ (191 * h2 + ix * 17);
-    }
-  unsigned h = (17 * h1) ^ (89 * h2);
-  if (!h)
-    h = (h1 & 0xffff) + (h2 & 0xfffff) + (t % 35677) + 19;
-  tu->mi_hash = h;
+    mi_hash_tuple_etape (&h1, &h2, ix, tu->mi_composants[ix]);
+  tu->mi_hash = mi_hash_tuple_final (h1, h2, t);
 }				// fin mi_calculer_hash_tuple
 
-const Mit_Tuple *
-mi_creer_tuple_symboles (unsigned nb, const Mit_Symbole **tabsym)
+static inline bool
+mi_composant_licite (const Mit_Symbole *sy)
 {
-  unsigned cnt = 0;
-  if (nb == 0 || !tabsym)
-    return &mi_tupvide;
-  for (unsigned ix = 0; ix < nb; ix++)
-    {
-      const Mit_Symbole *sy = tabsym[ix];
-      if (sy && sy != MI_TROU_SYMBOLE && sy->mi_type == MiTy_Symbole)
-        cnt++;
-    };
-  const Mit_Symbole *petitab[16] = { };
-  const Mit_Symbole **tab =
-    (cnt <
-     sizeof (petitab) / sizeof (petitab[0])) ? petitab : calloc (cnt + 1,
-         sizeof
-         (Mit_Symbole
-          *));
-  if (!tab)
-    MI_FATALPRINTF ("impossible d'allouer tableau de %d symboles (%s)",
-                    cnt + 1, strerror (errno));
-  cnt = 0;
-  for (unsigned ix = 0; ix < nb; ix++)
-    {
-      const Mit_Symbole *sy = tabsym[ix];
-      if (sy && sy != MI_TROU_SYMBOLE && sy->mi_type == MiTy_Symbole)
-        tab[cnt++] = sy;
-    };
-  Mit_Tuple *tu = mi_allouer_valeur (MiTy_Tuple,
-                                     sizeof (Mit_Tuple) +
-                                     cnt * sizeof (Mit_Symbole *));
-  for (unsigned ix = 0; ix < cnt; ix++)
-    tu->mi_composants[ix] = (Mit_Symbole *) tab[ix];
-  if (tab != petitab)
-    free (tab);
-  mi_calculer_hash_tuple (tu);
-  return tu;
-}				// fin mi_creer_tuple_symboles
+  return sy && sy != MI_TROU_SYMBOLE && sy->mi_type == MiTy_Symbole;
+}
 
+void
+mi_constrtuple_initialiser (struct Mi_ConstrTuple_st *ct, unsigned nb)
+{
+  assert (ct != NULL);
+  if (nb >= MI_MAXARITE)
+    MI_FATALPRINTF ("tuple trop grand (%u composants)", nb);
+  memset (ct, 0, sizeof (*ct));
+  ct->ct_nmagiq = MI_CONSTRTUPLE_NMAGIQ;
+  ct->ct_taille = nb;
+  ct->ct_h2 = nb + 1;
+  if (nb > 0)
+    ct->ct_tuple = mi_allouer_valeur (MiTy_Tuple,
+                                      sizeof (Mit_Tuple) +
+                                      nb * sizeof (Mit_Symbole *));
+}				// fin mi_constrtuple_initialiser
 
-static struct Mi_Vecteur_st *
-mi_vectcomp_ajouter (struct Mi_Vecteur_st *vecarg, const Mit_Val v)
+void
+mi_constrtuple_ajouter_symbole (struct Mi_ConstrTuple_st *ct,
+                                const Mit_Symbole *sy)
+{
+  assert (ct && ct->ct_nmagiq == MI_CONSTRTUPLE_NMAGIQ);
+  if (!mi_composant_licite (sy))
+    return;
+  if (ct->ct_compte >= ct->ct_taille)
+    MI_FATALPRINTF ("constructeur de tuple plein (%u composants)",
+                    ct->ct_taille);
+  unsigned ix = ct->ct_compte++;
+  ct->ct_tuple->mi_composants[ix] = (Mit_Symbole *) sy;
+  mi_hash_tuple_etape (&ct->ct_h1, &ct->ct_h2, ix, sy);
+}				// fin mi_constrtuple_ajouter_symbole
+
+unsigned
+mi_nombre_composants_valeur (const Mit_Val v)
 {
-  struct Mi_Vecteur_st *vec = vecarg;
   switch (mi_vtype (v))
     {
     case MiTy_Symbole:
-      vec = mi_vecteur_ajouter (vec, v);
+      return mi_composant_licite (v.miva_sym) ? 1 : 0;
+    case MiTy_Tuple:
+      return v.miva_tup->mi_taille;
+    case MiTy_VueTuple:
+      return v.miva_vuetup->mi_taille;
+    case MiTy_Ensemble:
+      return v.miva_ens->mi_taille;
+    case MiTy_EnsPersistant:
+      return v.miva_ensp->mi_taille;
+    default:
+      return 0;
+    }
+}				// fin mi_nombre_composants_valeur
+
+void
+mi_constrtuple_ajouter_valeur (struct Mi_ConstrTuple_st *ct, const Mit_Val v)
+{
+  assert (ct && ct->ct_nmagiq == MI_CONSTRTUPLE_NMAGIQ);
+  switch (mi_vtype (v))
+    {
+    case MiTy_Symbole:
+      mi_constrtuple_ajouter_symbole (ct, v.miva_sym);
       break;
     case MiTy_Tuple:
     {
-      const Mit_Tuple *tu = mi_en_tuple (v);
+      const Mit_Tuple *tu = v.miva_tup;
       unsigned t = tu->mi_taille;
-      vec = mi_vecteur_reserver (vec, t + 1);
       for (unsigned ix = 0; ix < t; ix++)
-        vec =
-          mi_vectcomp_ajouter (vec, MI_SYMBOLEV (tu->mi_composants[ix]));
+        mi_constrtuple_ajouter_symbole (ct, tu->mi_composants[ix]);
+    }
+    break;
+    case MiTy_VueTuple:
+    {
+      const Mit_VueTuple *vt = v.miva_vuetup;
+      for (unsigned is = 0; is < vt->mi_nbseg; is++)
+        {
+          const struct Mi_SegmentTuple_st *sg = vt->mi_seg + is;
+          for (unsigned ix = 0; ix < sg->seg_long; ix++)
+            mi_constrtuple_ajouter_symbole
+            (ct, sg->seg_tuple->mi_composants[sg->seg_debut + ix]);
+        }
     }
     break;
     case MiTy_Ensemble:
+    case MiTy_EnsPersistant:
     {
-      const Mit_Ensemble *en = mi_en_ensemble (v);
+      const Mit_Ensemble *en = mi_en_ensemble_plat (v);
       unsigned t = en->mi_taille;
-      vec = mi_vecteur_reserver (vec, t + 1);
+      Mit_Symbole *const *el = mi_ensemble_prendre_elements (en);
       for (unsigned ix = 0; ix < t; ix++)
-        vec = mi_vectcomp_ajouter (vec, MI_SYMBOLEV (en->mi_elements[ix]));
+        mi_constrtuple_ajouter_symbole (ct, el[ix]);
+      mi_ensemble_rendre_elements (en, el);
     }
     break;
     default:
       break;
     }
-  return vec;
-}				/* end mi_vectcomp_ajouter */
+}				// fin mi_constrtuple_ajouter_valeur
 
 const Mit_Tuple *
-mi_creer_tuple_valeurs (unsigned nb, const Mit_Val *tabval)
+mi_constrtuple_finir (struct Mi_ConstrTuple_st *ct)
 {
-  struct Mi_Vecteur_st *vec = mi_vecteur_reserver (NULL, 5 * nb / 4 + 1);
-  for (unsigned ix = 0; ix < nb; ix++)
-    vec = mi_vectcomp_ajouter (vec, tabval[ix]);
-  unsigned t = mi_vecteur_taille (vec);
-  if (t > 0)
+  assert (ct && ct->ct_nmagiq == MI_CONSTRTUPLE_NMAGIQ);
+  Mit_Tuple *tu = ct->ct_tuple;
+  unsigned cnt = ct->ct_compte;
+  if (cnt == 0)
     {
-      Mit_Tuple *tu =
-        mi_allouer_valeur (MiTy_Tuple, t * sizeof (Mit_Symbole *));
-      for (unsigned ix = 0; ix < t; ix++)
-        tu->mi_composants[ix] =
-          mi_en_symbole (mi_vecteur_comp (vec, ix).t_val);
-      mi_calculer_hash_tuple (tu);
-      free (vec);
-      return tu;
+      // rien n'a été ajouté: le tuple frais est abandonné
+      mi_liberer_valeur_fraiche (tu);
+      tu = NULL;
+    }
+  else if (cnt == ct->ct_taille)
+    {
+      // le hash incrémental suppose que la taille prévue a été atteinte
+      tu->mi_taille = cnt;
+      tu->mi_hash = mi_hash_tuple_final (ct->ct_h1, ct->ct_h2, cnt);
     }
   else
+    {
+      tu = mi_retrecir_valeur_fraiche (tu, sizeof (Mit_Tuple)
+                                       + cnt * sizeof (Mit_Symbole *));
+      tu->mi_taille = cnt;
+      mi_calculer_hash_tuple (tu);
+    }
+  memset (ct, 0, sizeof (*ct));
+  return tu ? mi_partager_tuple (tu) : &mi_tupvide;
+}				// fin mi_constrtuple_finir
+
+bool
+mi_tuple_egal (const Mit_Tuple * tu1, const Mit_Tuple * tu2)
+{
+  if (tu1 == tu2)
+    return true;
+  if (!tu1 || tu1->mi_type != MiTy_Tuple || !tu2
+      || tu2->mi_type != MiTy_Tuple)
+    return false;
+  // deux tuples partagés distincts sont différents
+  if (tu1->mi_partage && tu2->mi_partage)
+    return false;
+  if (tu1->mi_taille != tu2->mi_taille || tu1->mi_hash != tu2->mi_hash)
+    return false;
+  return !memcmp (tu1->mi_composants, tu2->mi_composants,
+                  tu1->mi_taille * sizeof (Mit_Symbole *));
+}				// fin mi_tuple_egal
+
+const Mit_Tuple *
+mi_creer_tuple_symboles (unsigned nb, const Mit_Symbole **tabsym)
+{
+  unsigned cnt = 0;
+  if (nb == 0 || !tabsym)
+    return &mi_tupvide;
+  for (unsigned ix = 0; ix < nb; ix++)
+    if (mi_composant_licite (tabsym[ix]))
+      cnt++;
+  struct Mi_ConstrTuple_st ct;
+  mi_constrtuple_initialiser (&ct, cnt);
+  for (unsigned ix = 0; ix < nb; ix++)
+    mi_constrtuple_ajouter_symbole (&ct, tabsym[ix]);
+  return mi_constrtuple_finir (&ct);
+}				// fin mi_creer_tuple_symboles
+
+const Mit_Tuple *
+mi_creer_tuple_valeurs (unsigned nb, const Mit_Val *tabval)
+{
+  if (nb == 0 || !tabval)
     return &mi_tupvide;
+  unsigned long cnt = 0;
+  for (unsigned ix = 0; ix < nb; ix++)
+    cnt += mi_nombre_composants_valeur (tabval[ix]);
+  if (cnt >= MI_MAXARITE)
+    MI_FATALPRINTF ("tuple trop grand (%lu composants)", cnt);
+  struct Mi_ConstrTuple_st ct;
+  mi_constrtuple_initialiser (&ct, (unsigned) cnt);
+  for (unsigned ix = 0; ix < nb; ix++)
+    mi_constrtuple_ajouter_valeur (&ct, tabval[ix]);
+  return mi_constrtuple_finir (&ct);
 }				// fin mi_creer_tuple_valeurs
 
-void
-mi_afficher_valeur (FILE * fi, const Mit_Val v)
+unsigned
+mi_sequence_taille (const Mit_Val v)
 {
-  if (!fi)
-    return;
-  enum mi_typeval_en ty = mi_vtype (v);
-  switch (ty)
+  switch (mi_vtype (v))
     {
-    case MiTy_Nil:
-      fputs ("~", fi);
-      break;
-    case MiTy_Entier:
-      fprintf (fi, "%ld", mi_vald_entier (v, 0));
-      break;
-    case MiTy_Double:
+    case MiTy_Tuple:
+      return v.miva_tup->mi_taille;
+    case MiTy_VueTuple:
+      return v.miva_vuetup->mi_taille;
+    default:
+      return 0;
+    }
+}				// fin mi_sequence_taille
+
+Mit_Symbole *
+mi_sequence_nieme (const Mit_Val v, int n)
+{
+  switch (mi_vtype (v))
     {
-      double d = mi_vald_double (v, NAN);
-      if (isnan (d))
-        fputs ("+NAN", fi);
-      else if (isinf (d))
-        fprintf (fi, "%cINF", (d > 0.0) ? '+' : '-');
-      else
+    case MiTy_Tuple:
+      return mi_tuple_nieme (v.miva_tup, n);
+    case MiTy_VueTuple:
+    {
+      const Mit_VueTuple *vt = v.miva_vuetup;
+      if (n < 0)
+        n += (int) vt->mi_taille;
+      if (n < 0 || n >= (int) vt->mi_taille)
+        return NULL;
+      unsigned r = n;
+      for (unsigned is = 0; is < vt->mi_nbseg; is++)
         {
-          // il faut absolument le point décimal
-          char tamp[64];
-          snprintf (tamp, sizeof (tamp), "%g", d);
-          if (strchr (tamp, '.'))
-            {
-              fputs (tamp, fi);
-              break;
-            };
-          snprintf (tamp, sizeof (tamp), "%.3f", d);
-          if (strchr (tamp, '.') && atof (tamp) == d && strlen (tamp) < 10)
-            {
-              fputs (tamp, fi);
-              break;
-            };
-          snprintf (tamp, sizeof (tamp), "%.6f", d);
-          if (strchr (tamp, '.') && atof (tamp) == d && strlen (tamp) < 20)
-            {
-              fputs (tamp, fi);
-              break;
-            };
-          snprintf (tamp, sizeof (tamp), "%.9e", d);
-          if (strchr (tamp, '.') && atof (tamp) == d)
-            {
-              fputs (tamp, fi);
-              break;
-            };
-          snprintf (tamp, sizeof (tamp), "%.18e", d);
-          assert (strchr (tamp, '.'));
-          fputs (tamp, fi);
+          const struct Mi_SegmentTuple_st *sg = vt->mi_seg + is;
+          if (r < sg->seg_long)
+            return sg->seg_tuple->mi_composants[sg->seg_debut + r];
+          r -= sg->seg_long;
         }
+      return NULL;
     }
-    break;
-    case MiTy_Chaine:
-    {
-      fputc ('"', fi);
-      mi_afficher_chaine_encodee (fi, mi_vald_chaine (v, NULL));
-      fputc ('"', fi);
+    default:
+      return NULL;
     }
-    break;
-    case MiTy_Symbole:
+}				// fin mi_sequence_nieme
+
+unsigned
+mi_vuetuple_hash (const Mit_VueTuple *vt)
+{
+  if (!vt || vt->mi_type != MiTy_VueTuple)
+    return 0;
+  if (vt->mi_hash)
+    return vt->mi_hash;
+  unsigned t = vt->mi_taille;
+  unsigned h1 = 0, h2 = t + 1, ix = 0;
+  for (unsigned is = 0; is < vt->mi_nbseg; is++)
     {
-      char tampind[16];
-      const Mit_Symbole *sy = mi_en_symbole (v);
-      fprintf (fi, "%s%s", mi_symbole_chaine (sy),
-               mi_symbole_indice_ch (tampind, sy));
+      const struct Mi_SegmentTuple_st *sg = vt->mi_seg + is;
+      Mit_Symbole *const *comp = sg->seg_tuple->mi_composants + sg->seg_debut;
+      for (unsigned j = 0; j < sg->seg_long; j++)
+        mi_hash_tuple_etape (&h1, &h2, ix++, comp[j]);
     }
-    break;
-    case MiTy_Tuple:
+  // la vue est immuable, son hash est un cache
+  return ((Mit_VueTuple *) vt)->mi_hash = mi_hash_tuple_final (h1, h2, t);
+}				// fin mi_vuetuple_hash
+
+const Mit_Tuple *
+mi_vuetuple_materialiser (const Mit_VueTuple *vt)
+{
+  if (!vt || vt->mi_type != MiTy_VueTuple)
+    return NULL;
+  struct Mi_ConstrTuple_st ct;
+  mi_constrtuple_initialiser (&ct, vt->mi_taille);
+  mi_constrtuple_ajouter_valeur (&ct, MI_VUETUPLEV (vt));
+  return mi_constrtuple_finir (&ct);
+}				// fin mi_vuetuple_materialiser
+
+// ajoute un segment, en le fusionnant au précédent s'il le prolonge
+// dans le même tuple; renvoie le nouveau nombre de segments, qui peut
+// dépasser MI_VUE_MAXSEG mais pas son double, car on ne concatène que
+// deux séquences
+static unsigned
+mi_ajouter_segment (struct Mi_SegmentTuple_st *tabseg, unsigned nbseg,
+                    const Mit_Tuple *tu, unsigned deb, unsigned lg)
+{
+  if (lg == 0)
+    return nbseg;
+  if (nbseg > 0)
     {
-      const Mit_Tuple *tup = mi_en_tuple (v);
-      unsigned ar = mi_arite_tuple (tup);
-      fputc ('[', fi);
-      for (unsigned ix = 0; ix < ar; ix++)
+      struct Mi_SegmentTuple_st *der = tabseg + nbseg - 1;
+      if (der->seg_tuple == tu && der->seg_debut + der->seg_long == deb)
         {
-          if (ix > 0)
-            {
-              if (ix % 5 == 0)
-                fputs (", ", fi);
-              else
-                fputc (',', fi);
-            }
-          const Mit_Symbole *sy = mi_tuple_nieme (tup, (int) ix);
-          assert (sy && sy->mi_type == MiTy_Symbole);
-          char tampind[16];
-          fprintf (fi, "%s%s", mi_symbole_chaine (sy),
-                   mi_symbole_indice_ch (tampind, sy));
-        };
-      fputc (']', fi);
+          der->seg_long += lg;
+          return nbseg;
+        }
     }
-    break;
-    case MiTy_Ensemble:
+  assert (nbseg < 2 * MI_VUE_MAXSEG);
+  tabseg[nbseg].seg_tuple = tu;
+  tabseg[nbseg].seg_debut = deb;
+  tabseg[nbseg].seg_long = lg;
+  return nbseg + 1;
+}				// fin mi_ajouter_segment
+
+// la séquence faite de segments, sans copie si elle est grande
+static Mit_Val
+mi_sequence_segments (const struct Mi_SegmentTuple_st *tabseg,
+                      unsigned nbseg, unsigned taille)
+{
+  if (taille == 0)
+    return MI_TUPLEV (&mi_tupvide);
+  if (nbseg == 1 && tabseg[0].seg_debut == 0
+      && tabseg[0].seg_long == tabseg[0].seg_tuple->mi_taille)
+    return MI_TUPLEV (tabseg[0].seg_tuple);
+  if (taille <= MI_VUE_SEUIL || nbseg > MI_VUE_MAXSEG)
+    {
+      // assez petit pour être copié, ou trop morcelé pour une vue
+      struct Mi_ConstrTuple_st ct;
+      mi_constrtuple_initialiser (&ct, taille);
+      for (unsigned is = 0; is < nbseg; is++)
+        for (unsigned ix = 0; ix < tabseg[is].seg_long; ix++)
+          mi_constrtuple_ajouter_symbole
+          (&ct, tabseg[is].seg_tuple->mi_composants[tabseg[is].seg_debut + ix]);
+      return MI_TUPLEV (mi_constrtuple_finir (&ct));
+    }
+  Mit_VueTuple *vt = mi_allouer_valeur (MiTy_VueTuple, sizeof (Mit_VueTuple));
+  vt->mi_taille = taille;
+  vt->mi_nbseg = nbseg;
+  memcpy (vt->mi_seg, tabseg, nbseg * sizeof (struct Mi_SegmentTuple_st));
+  return MI_VUETUPLEV (vt);
+}				// fin mi_sequence_segments
+
+// ajoute les composants de rang deb à deb+lg d'une séquence
+static unsigned
+mi_segments_sequence (struct Mi_SegmentTuple_st *tabseg, unsigned nbseg,
+                      const Mit_Val v, unsigned deb, unsigned lg)
+{
+  switch (mi_vtype (v))
     {
-      const Mit_Ensemble *ens = mi_en_ensemble (v);
-      unsigned car = mi_cardinal_ensemble (ens);
-      fputc ('{', fi);
-      for (unsigned ix = 0; ix < car; ix++)
+    case MiTy_Tuple:
+      return mi_ajouter_segment (tabseg, nbseg, v.miva_tup, deb, lg);
+    case MiTy_VueTuple:
+    {
+      const Mit_VueTuple *vt = v.miva_vuetup;
+      for (unsigned is = 0; is < vt->mi_nbseg && lg > 0; is++)
         {
-          if (ix > 0)
+          const struct Mi_SegmentTuple_st *sg = vt->mi_seg + is;
+          if (deb >= sg->seg_long)
             {
-              if (ix % 5 == 0)
-                fputs (", ", fi);
-              else
-                fputc (',', fi);
+              deb -= sg->seg_long;
+              continue;
             }
-          const Mit_Symbole *sy = mi_ensemble_nieme (ens, (int) ix);
-          assert (sy && sy->mi_type == MiTy_Symbole);
-          char tampind[16];
-          fprintf (fi, "%s%s", mi_symbole_chaine (sy),
-                   mi_symbole_indice_ch (tampind, sy));
-        };
-      fputc ('}', fi);
+          unsigned l = sg->seg_long - deb;
+          if (l > lg)
+            l = lg;
+          nbseg = mi_ajouter_segment (tabseg, nbseg, sg->seg_tuple,
+                                      sg->seg_debut + deb, l);
+          lg -= l;
+          deb = 0;
+        }
+      return nbseg;
     }
-    break;
-    case MiTy__Dernier:
-      MI_FATALPRINTF ("valeur impossible @%p", v.miva_ptr);
+    default:
+      return nbseg;
     }
-  fputc ('\n', fi);
-}				// fin mi_afficher_valeur
+}				// fin mi_segments_sequence
+
+Mit_Val
+mi_sequence_tranche (const Mit_Val v, int deb, unsigned lg)
+{
+  unsigned t = mi_sequence_taille (v);
+  if (deb < 0)
+    deb += (int) t;
+  if (deb < 0)
+    deb = 0;
+  if ((unsigned) deb >= t)
+    lg = 0;
+  else if (lg > t - deb)
+    lg = t - deb;
+  struct Mi_SegmentTuple_st tabseg[2 * MI_VUE_MAXSEG];
+  unsigned nbseg = mi_segments_sequence (tabseg, 0, v, deb, lg);
+  return mi_sequence_segments (tabseg, nbseg, lg);
+}				// fin mi_sequence_tranche
+
+Mit_Val
+mi_sequence_concatener (const Mit_Val v1, const Mit_Val v2)
+{
+  unsigned t1 = mi_sequence_taille (v1), t2 = mi_sequence_taille (v2);
+  if ((unsigned long) t1 + t2 >= MI_MAXARITE)
+    MI_FATALPRINTF ("concaténation trop grande (%u + %u composants)", t1, t2);
+  struct Mi_SegmentTuple_st tabseg[2 * MI_VUE_MAXSEG];
+  unsigned nbseg = mi_segments_sequence (tabseg, 0, v1, 0, t1);
+  nbseg = mi_segments_sequence (tabseg, nbseg, v2, 0, t2);
+  return mi_sequence_segments (tabseg, nbseg, t1 + t2);
+}				// fin mi_sequence_concatener